@@ -0,0 +1,194 @@
+#include "H5Cpp.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "attribute_bulk.h"
+
+// Writes the same set of attributes (int, double, string, float[4]) to N
+// datasets one attribute at a time with fresh type and space objects, then with
+// an h5util::AttributeSet, and reads them all back per attribute and with an
+// h5util::AttributeReader. Finally one dataset gets thousands of attributes in
+// dense storage (fractal heap) to time that path.
+//
+// Usage: attributes_bench [objects] [attrs per object] [dense attrs]
+namespace {
+
+const char* FILE_NAME = "attributes_bench.h5";
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string attrName(int k) {
+    return "attr_" + std::to_string(k);
+}
+
+// Attribute k of the set: kind k % 4.
+struct SetValues {
+    int intValue = 42;
+    double doubleValue = 2.5;
+    std::string text = "Revision: , URL: ";
+    float vector[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+};
+
+void writeNaive(H5::DataSet& dataset, int attrs, const SetValues& values) {
+    for (int k = 0; k < attrs; ++k) {
+        H5::DataSpace scalar(H5S_SCALAR);
+        switch (k % 4) {
+        case 0: {
+            H5::IntType type(H5::PredType::NATIVE_INT);
+            dataset.createAttribute(attrName(k), type, scalar).write(type, &values.intValue);
+            break;
+        }
+        case 1: {
+            H5::FloatType type(H5::PredType::NATIVE_DOUBLE);
+            dataset.createAttribute(attrName(k), type, scalar).write(type, &values.doubleValue);
+            break;
+        }
+        case 2: {
+            H5::StrType type(H5::PredType::C_S1, values.text.size());
+            dataset.createAttribute(attrName(k), type, scalar).write(type, values.text);
+            break;
+        }
+        default: {
+            hsize_t dims[1] = {4};
+            H5::DataSpace space(1, dims);
+            H5::FloatType type(H5::PredType::NATIVE_FLOAT);
+            dataset.createAttribute(attrName(k), type, space).write(type, values.vector);
+            break;
+        }
+        }
+    }
+}
+
+void buildSet(h5util::AttributeSet& set, int attrs, const SetValues& values) {
+    for (int k = 0; k < attrs; ++k) {
+        switch (k % 4) {
+        case 0:
+            set.add(attrName(k), H5::PredType::NATIVE_INT, &values.intValue);
+            break;
+        case 1:
+            set.add(attrName(k), H5::PredType::NATIVE_DOUBLE, &values.doubleValue);
+            break;
+        case 2:
+            set.addString(attrName(k), values.text);
+            break;
+        default:
+            set.add(attrName(k), H5::PredType::NATIVE_FLOAT, values.vector, {4});
+            break;
+        }
+    }
+}
+
+// Opens every attribute by index with a fresh type and space and reads it.
+size_t readNaive(H5::DataSet& dataset, std::vector<unsigned char>& scratch) {
+    const int count = dataset.getNumAttrs();
+    size_t bytes = 0;
+    for (int k = 0; k < count; ++k) {
+        H5::Attribute attr = dataset.openAttribute(static_cast<unsigned>(k));
+        H5::DataType fileType = attr.getDataType();
+        hid_t nativeType = H5Tget_native_type(fileType.getId(), H5T_DIR_ASCEND);
+        H5::DataType memType(nativeType);
+        H5Tclose(nativeType);
+        const size_t size = attr.getSpace().getSimpleExtentNpoints() * memType.getSize();
+        scratch.resize(size);
+        attr.read(memType, scratch.data());
+        bytes += size;
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int objects = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const int attrs = argc > 2 ? std::atoi(argv[2]) : 20;
+    const int denseAttrs = argc > 3 ? std::atoi(argv[3]) : 5000;
+    SetValues values;
+
+    try {
+        H5::DataSpace scalar(H5S_SCALAR);
+        int zero = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            const bool bulk = pass == 1;
+            const char* label = bulk ? "bulk" : "per-attribute";
+
+            auto start = std::chrono::steady_clock::now();
+            {
+                H5::H5File file(FILE_NAME, H5F_ACC_TRUNC, H5::FileCreatPropList::DEFAULT,
+                                h5util::denseAttributeAccessPlist());
+                std::vector<H5::DataSet> datasets;
+                for (int i = 0; i < objects; ++i) {
+                    datasets.push_back(file.createDataSet("dataset_" + std::to_string(i), H5::PredType::NATIVE_INT,
+                                                          scalar));
+                    datasets.back().write(&zero, H5::PredType::NATIVE_INT);
+                }
+                auto attrStart = std::chrono::steady_clock::now();
+                if (bulk) {
+                    h5util::AttributeSet set;
+                    buildSet(set, attrs, values);
+                    std::vector<H5::H5Object*> targets;
+                    for (H5::DataSet& dataset : datasets) targets.push_back(&dataset);
+                    set.writeToAll(targets);
+                } else {
+                    for (H5::DataSet& dataset : datasets) writeNaive(dataset, attrs, values);
+                }
+                std::cout << label << " write: " << objects * attrs << " attributes on " << objects
+                          << " datasets in " << millisSince(attrStart) << " ms\n";
+            }
+
+            start = std::chrono::steady_clock::now();
+            size_t bytes = 0;
+            size_t read = 0;
+            {
+                H5::H5File file(FILE_NAME, H5F_ACC_RDONLY);
+                if (bulk) {
+                    h5util::AttributeReader reader;
+                    for (int i = 0; i < objects; ++i) {
+                        const std::string name = "dataset_" + std::to_string(i);
+                        read += reader.readAll(file.openDataSet(name), name);
+                    }
+                    for (const h5util::AttributeRecord& record : reader.records()) bytes += record.bytes;
+                    std::cout << label << " read: " << reader.cachedTypes() << " cached types, ";
+                } else {
+                    std::vector<unsigned char> scratch;
+                    for (int i = 0; i < objects; ++i) {
+                        H5::DataSet dataset = file.openDataSet("dataset_" + std::to_string(i));
+                        read += dataset.getNumAttrs();
+                        bytes += readNaive(dataset, scratch);
+                    }
+                    std::cout << label << " read: ";
+                }
+            }
+            std::cout << read << " attributes, " << bytes << " bytes in " << millisSince(start) << " ms\n";
+        }
+
+        // One object with thousands of attributes, all in dense storage.
+        auto start = std::chrono::steady_clock::now();
+        {
+            H5::H5File file(FILE_NAME, H5F_ACC_TRUNC, H5::FileCreatPropList::DEFAULT,
+                            h5util::denseAttributeAccessPlist());
+            H5::DSetCreatPropList dcpl;
+            h5util::setDenseAttributes(dcpl);
+            H5::DataSet dataset = file.createDataSet("dense", H5::PredType::NATIVE_INT, scalar, dcpl);
+            h5util::AttributeSet set;
+            buildSet(set, denseAttrs, values);
+            set.writeTo(dataset);
+        }
+        std::cout << "dense write: " << denseAttrs << " attributes in " << millisSince(start) << " ms\n";
+
+        start = std::chrono::steady_clock::now();
+        {
+            H5::H5File file(FILE_NAME, H5F_ACC_RDONLY);
+            h5util::AttributeReader reader;
+            size_t read = reader.readAll(file.openDataSet("dense"), "dense");
+            std::cout << "dense read: " << read << " attributes in " << millisSince(start) << " ms\n";
+        }
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "H5Cpp.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "file_options.h"
+
+// Builds a metadata-heavy file (G groups of K scalar datasets, twodatasets
+// style) twice in the 1.10 format, once with a metadata cache image saved on
+// close, then measures the latency of the first query after open (read one
+// dataset in the last group) and of a full traversal, median of several runs.
+// Both files are read with a metadata cache large enough to hold the image.
+//
+// Usage: cacheimage_bench [groups] [datasets per group] [runs] [cache MiB]
+namespace {
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+std::string datasetPath(int group, int dataset) {
+    return "group_" + std::to_string(group) + "/dataset_" + std::to_string(dataset);
+}
+
+void writeFixture(const char* fileName, bool image, int groups, int perGroup) {
+    h5util::FileOptions options;
+    options.metadataCacheImage = image;
+    H5::FileAccPropList fapl = h5util::makeFileAccessPlist(options);
+    fapl.setLibverBounds(H5F_LIBVER_V110, H5F_LIBVER_LATEST); // same format for both files
+    H5::H5File file(fileName, H5F_ACC_TRUNC, h5util::makeFileCreatePlist(options), fapl);
+    H5::DataSpace scalar(H5S_SCALAR);
+    for (int g = 0; g < groups; ++g) {
+        H5::Group group = file.createGroup("group_" + std::to_string(g));
+        for (int d = 0; d < perGroup; ++d) {
+            int value = g * perGroup + d;
+            group.createDataSet("dataset_" + std::to_string(d), H5::PredType::NATIVE_INT, scalar)
+                .write(&value, H5::PredType::NATIVE_INT);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int groups = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int perGroup = argc > 2 ? std::atoi(argv[2]) : 20;
+    const int runs = argc > 3 ? std::atoi(argv[3]) : 5;
+    h5util::FileOptions readOptions;
+    readOptions.metadataCacheBytes = static_cast<size_t>(argc > 4 ? std::atoi(argv[4]) : 32) << 20;
+    const char* names[2] = {"cacheimage_none.h5", "cacheimage_saved.h5"};
+
+    try {
+        for (int image = 0; image < 2; ++image) {
+            auto start = std::chrono::steady_clock::now();
+            writeFixture(names[image], image == 1, groups, perGroup);
+            std::cout << (image ? "with cache image" : "without image") << ": write " << millisSince(start)
+                      << " ms";
+
+            std::vector<double> firstQuery, traversal;
+            hsize_t imageSize = 0;
+            for (int run = 0; run < runs; ++run) {
+                // Read-only opens leave the image in place for the next run.
+                start = std::chrono::steady_clock::now();
+                {
+                    H5::H5File file = h5util::openFile(names[image], H5F_ACC_RDONLY, readOptions);
+                    imageSize = h5util::cacheImageSize(file);
+                    int value = 0;
+                    file.openDataSet(datasetPath(groups - 1, perGroup - 1)).read(&value, H5::PredType::NATIVE_INT);
+                }
+                firstQuery.push_back(millisSince(start));
+
+                start = std::chrono::steady_clock::now();
+                long long sum = 0;
+                {
+                    H5::H5File file = h5util::openFile(names[image], H5F_ACC_RDONLY, readOptions);
+                    for (int g = 0; g < groups; ++g) {
+                        for (int d = 0; d < perGroup; ++d) {
+                            int value = 0;
+                            file.openDataSet(datasetPath(g, d)).read(&value, H5::PredType::NATIVE_INT);
+                            sum += value;
+                        }
+                    }
+                }
+                traversal.push_back(millisSince(start));
+                if (sum != static_cast<long long>(groups) * perGroup * (groups * perGroup - 1) / 2) {
+                    std::cerr << "checksum mismatch" << std::endl;
+                    return 1;
+                }
+            }
+            std::cout << ", image " << imageSize << " bytes, open + first query " << median(firstQuery)
+                      << " ms, open + full traversal " << median(traversal) << " ms (median of " << runs
+                      << ")\n";
+        }
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
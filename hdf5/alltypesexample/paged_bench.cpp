@@ -0,0 +1,150 @@
+#include "H5Cpp.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "attribute_bulk.h"
+#include "dataset_factory.h"
+#include "file_options.h"
+
+// Builds two fixtures with the default free-space strategy and with paged
+// aggregation, then reads everything back with and without a page buffer:
+//   small objects:   N tiny contiguous datasets with one attribute each
+//   metadata heavy:  G groups of K small datasets
+// Reports file size, write time, open+read time and page buffer hit rates.
+//
+// Usage: paged_bench [datasets] [groups] [datasets per group] [page size]
+namespace {
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Shape {
+    int datasets;      // small-objects fixture
+    int groups;        // metadata-heavy fixture
+    int perGroup;
+};
+
+void writeSmallObjects(H5::H5File& file, int count) {
+    h5util::DatasetOptions options;
+    options.compactThreshold = 0; // separate raw-data allocations, as older writers produce
+    h5util::AttributeSet attributes;
+    attributes.addString("GIT root revision", "Revision: , URL: ");
+    H5::DataSpace scalar(H5S_SCALAR);
+    for (int i = 0; i < count; ++i) {
+        H5::DataSet dataset =
+            h5util::createDataSet(file, "dataset_" + std::to_string(i), H5::PredType::NATIVE_INT, scalar, options);
+        dataset.write(&i, H5::PredType::NATIVE_INT);
+        attributes.writeTo(dataset);
+    }
+}
+
+long long readSmallObjects(H5::H5File& file, int count) {
+    long long sum = 0;
+    for (int i = 0; i < count; ++i) {
+        int value = 0;
+        H5::DataSet dataset = file.openDataSet("dataset_" + std::to_string(i));
+        dataset.read(&value, H5::PredType::NATIVE_INT);
+        sum += value + dataset.getNumAttrs();
+    }
+    return sum;
+}
+
+void writeMetadataHeavy(H5::H5File& file, int groups, int perGroup) {
+    hsize_t dims[1] = {16};
+    H5::DataSpace space(1, dims);
+    std::vector<int> values(16);
+    for (int g = 0; g < groups; ++g) {
+        H5::Group group = file.createGroup("group_" + std::to_string(g));
+        for (int d = 0; d < perGroup; ++d) {
+            for (int k = 0; k < 16; ++k) values[k] = g + d + k;
+            group.createDataSet("values_" + std::to_string(d), H5::PredType::NATIVE_INT, space)
+                .write(values.data(), H5::PredType::NATIVE_INT);
+        }
+    }
+}
+
+long long readMetadataHeavy(H5::H5File& file, int groups, int perGroup) {
+    long long sum = 0;
+    std::vector<int> values(16);
+    for (int g = 0; g < groups; ++g) {
+        H5::Group group = file.openGroup("group_" + std::to_string(g));
+        for (int d = 0; d < perGroup; ++d) {
+            group.openDataSet("values_" + std::to_string(d)).read(values.data(), H5::PredType::NATIVE_INT);
+            sum += values[15];
+        }
+    }
+    return sum;
+}
+
+void runFixture(const char* label, const char* fileName, const Shape& shape, bool smallObjects, hsize_t pageSize) {
+    std::cout << label << ":\n";
+    for (int paged = 0; paged < 2; ++paged) {
+        h5util::FileOptions options;
+        if (paged) options = h5util::FileOptions::paged(pageSize);
+
+        auto start = std::chrono::steady_clock::now();
+        hsize_t fileSize = 0;
+        {
+            h5util::FileOptions createOptions = options;
+            createOptions.pageBufferSize = 0;
+            H5::H5File file = h5util::createFile(fileName, createOptions);
+            if (smallObjects) {
+                writeSmallObjects(file, shape.datasets);
+            } else {
+                writeMetadataHeavy(file, shape.groups, shape.perGroup);
+            }
+            file.flush(H5F_SCOPE_LOCAL);
+            fileSize = file.getFileSize();
+        }
+        std::cout << "  " << (paged ? "paged" : "default") << " write: " << fileSize << " bytes, "
+                  << millisSince(start) << " ms\n";
+
+        // Paged files are read without and then with the page buffer, which
+        // FileOptions::paged() leaves off on libraries older than 1.14.
+        const int withBuffer = options.pageBufferSize > 0 ? 1 : 0;
+        for (int buffered = 0; buffered <= withBuffer; ++buffered) {
+            h5util::FileOptions readOptions;
+            if (buffered) readOptions.pageBufferSize = options.pageBufferSize;
+            start = std::chrono::steady_clock::now();
+            H5::H5File file = h5util::openFile(fileName, H5F_ACC_RDONLY, readOptions);
+            long long checksum = smallObjects ? readSmallObjects(file, shape.datasets)
+                                              : readMetadataHeavy(file, shape.groups, shape.perGroup);
+            std::cout << "    read" << (buffered ? " (page buffer)" : "") << ": " << millisSince(start)
+                      << " ms, checksum " << checksum << "\n";
+            if (buffered) {
+                std::cout << "    ";
+                h5util::printPageBufferStats(std::cout, file);
+            }
+        }
+        if (paged && !withBuffer) {
+            std::cout << "    read (page buffer): skipped, needs HDF5 1.14 or later\n";
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Shape shape;
+    shape.datasets = argc > 1 ? std::atoi(argv[1]) : 20000;
+    shape.groups = argc > 2 ? std::atoi(argv[2]) : 500;
+    shape.perGroup = argc > 3 ? std::atoi(argv[3]) : 20;
+    const hsize_t pageSize = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : h5util::FileOptions::DEFAULT_PAGE_SIZE;
+
+    try {
+        std::cout << "page size " << pageSize << " bytes, page buffer "
+                  << h5util::FileOptions::DEFAULT_PAGE_BUFFER << " bytes\n";
+        runFixture("small objects", "paged_small.h5", shape, true, pageSize);
+        runFixture("metadata heavy", "paged_groups.h5", shape, false, pageSize);
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "H5Cpp.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "dataset_factory.h"
+#include "file_options.h"
+
+// Writes N scalar int datasets with contiguous layout, with compact layout, with
+// compact layout plus the no-attributes header hint, and with that in a paged
+// file, then reports file size, write time, and the time to open the file and
+// read every dataset back. The paged file is read through a page buffer only
+// where pageBufferSupported() (HDF5 1.14 or later), as in paged_bench.
+//
+// Usage: tinydatasets_bench [count]
+namespace {
+
+struct Variant {
+    const char* label;
+    const char* fileName;
+    h5util::DatasetOptions options;
+    h5util::FileOptions fileOptions;
+};
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    Variant variants[4] = {
+        {"contiguous", "tiny_contiguous.h5", h5util::DatasetOptions(), h5util::FileOptions()},
+        {"compact", "tiny_compact.h5", h5util::DatasetOptions(), h5util::FileOptions()},
+        {"compact + no attrs", "tiny_compact_noattrs.h5", h5util::DatasetOptions(), h5util::FileOptions()},
+        {h5util::pageBufferSupported() ? "compact + no attrs, paged + page buffer" : "compact + no attrs, paged",
+         "tiny_compact_paged.h5", h5util::DatasetOptions(), h5util::FileOptions::paged()},
+    };
+    variants[0].options.compactThreshold = 0;
+    variants[2].options.noAttributes = true;
+    variants[3].options.noAttributes = true;
+
+    try {
+        for (Variant& variant : variants) {
+            auto start = std::chrono::steady_clock::now();
+            hsize_t fileSize = 0;
+            {
+                h5util::FileOptions createOptions = variant.fileOptions;
+                createOptions.pageBufferSize = 0;
+                H5::H5File file = h5util::createFile(variant.fileName, createOptions);
+                H5::DataSpace scalarSpace;
+                for (int i = 0; i < count; ++i) {
+                    H5::DataSet dataset = h5util::createDataSet(file, "dataset_" + std::to_string(i),
+                                                                H5::PredType::NATIVE_INT, scalarSpace, variant.options);
+                    dataset.write(&i, H5::PredType::NATIVE_INT);
+                }
+                file.flush(H5F_SCOPE_LOCAL);
+                fileSize = file.getFileSize();
+            }
+            double writeMs = millisSince(start);
+
+            start = std::chrono::steady_clock::now();
+            long long sum = 0;
+            {
+                H5::H5File file = h5util::openFile(variant.fileName, H5F_ACC_RDONLY, variant.fileOptions);
+                for (int i = 0; i < count; ++i) {
+                    int value = 0;
+                    file.openDataSet("dataset_" + std::to_string(i)).read(&value, H5::PredType::NATIVE_INT);
+                    sum += value;
+                }
+            }
+            double readMs = millisSince(start);
+
+            std::cout << variant.label << ": " << count << " datasets, " << fileSize << " bytes ("
+                      << static_cast<double>(fileSize) / count << " per dataset), write " << writeMs
+                      << " ms, open+read all " << readMs << " ms, checksum " << sum << "\n";
+        }
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
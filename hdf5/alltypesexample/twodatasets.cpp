@@ -1,6 +1,8 @@
 #include "H5Cpp.h"
 #include <iostream>
 #include <string>
+#include "dataset_factory.h"
+#include "multi_io.h"
 
 const H5std_string FILE_NAME("twenty_datasets.h5");
 
@@ -12,12 +14,21 @@ int main() {
         // Define scalar dataspace (rank 0).
         H5::DataSpace scalarSpace;
 
-        // Create 10 datasets, each containing a single integer value from 1 to 10.
+        // Compact layout and a minimal object header: these datasets never get attributes.
+        h5util::DatasetOptions options;
+        options.noAttributes = true;
+
+        // Create 20 datasets, each containing a single integer value from 1 to 20,
+        // and write them all in one batch.
+        int values[20];
+        h5util::MultiWriter writer;
         for (int i = 1; i <= 20; ++i) {
             std::string datasetName = "dataset_" + std::to_string(i);
-            H5::DataSet dataset = file.createDataSet(datasetName, H5::PredType::NATIVE_INT, scalarSpace);
-            dataset.write(&i, H5::PredType::NATIVE_INT);
+            H5::DataSet dataset = h5util::createDataSet(file, datasetName, H5::PredType::NATIVE_INT, scalarSpace, options);
+            values[i - 1] = i;
+            writer.add(dataset, H5::PredType::NATIVE_INT, &values[i - 1]);
         }
+        writer.execute();
 
         std::cout << "HDF5 file '" << FILE_NAME << "' created with 2 scalar datasets." << std::endl;
     } catch (H5::Exception& e) {
@@ -0,0 +1,53 @@
+// weather_reader.cpp
+#include "weather_reader.h"
+#include "decimal.h"
+
+#include <stdexcept>
+
+WeatherReader::WeatherReader(const std::string& fileName, const std::string& datasetName)
+    : file(fileName, H5F_ACC_RDONLY), dataset(file.openDataSet(datasetName)) {
+    // Read through the file type itself: converting the offset-7 type to a plain
+    // uint32 would shift the fractional bits away.
+    fileType = dataset.getDataType();
+    if (fileType.getSize() != sizeof(uint32_t)) {
+        throw std::runtime_error("WeatherReader: " + datasetName + " is not a 32-bit fixed-point matrix");
+    }
+    H5::DataSpace space = dataset.getSpace();
+    if (space.getSimpleExtentNdims() != 2) {
+        throw std::runtime_error("WeatherReader: " + datasetName + " is not two-dimensional");
+    }
+    space.getSimpleExtentDims(dims);
+    dateIndex = h5util::ScaleIndex(dataset, 0);
+    if (dateIndex.size() != dims[0]) {
+        throw std::runtime_error("WeatherReader: Date scale does not cover every row");
+    }
+    decimalScales = h5util::readDecimalScales(dataset);
+    if (isDecimal() && decimalScales.size() != dims[1]) {
+        throw std::runtime_error("WeatherReader: expected one decimal scale per column");
+    }
+}
+
+double WeatherReader::decode(uint32_t raw, hsize_t column) const {
+    if (!isDecimal()) return decode(raw);
+    return static_cast<int32_t>(raw) / h5util::powerOfTen(decimalScales[column]);
+}
+
+std::pair<hsize_t, hsize_t> WeatherReader::rowRange(int64_t dateA, int64_t dateB) const {
+    return dateIndex.range(dateA, dateB);
+}
+
+hsize_t WeatherReader::rowsBetween(int64_t dateA, int64_t dateB, std::vector<uint32_t>& values,
+                                   hsize_t& rowCount) const {
+    std::pair<hsize_t, hsize_t> range = rowRange(dateA, dateB);
+    rowCount = range.second - range.first;
+    values.resize(rowCount * dims[1]);
+    if (rowCount == 0) return range.first;
+
+    hsize_t start[2] = {range.first, 0};
+    hsize_t count[2] = {rowCount, dims[1]};
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count, start);
+    H5::DataSpace memSpace(2, count);
+    dataset.read(values.data(), fileType, memSpace, fileSpace);
+    return range.first;
+}
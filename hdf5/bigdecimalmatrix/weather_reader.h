@@ -0,0 +1,51 @@
+// weather_reader.h
+#ifndef WEATHER_READER_H
+#define WEATHER_READER_H
+
+#include <H5Cpp.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dimension_scales.h"
+
+// Rows of the weather matrix written by weatherdata. The file carries a sorted
+// yyyymmdd "Date" scale on dimension 0; it is loaded once and binary-searched,
+// so a date-range query reads only the matching hyperslab of the matrix.
+// Matrices written with --decimal hold int32 words with a power-of-ten scale per
+// column instead of the binary fixed-point encoding; decode(raw, column) handles
+// both.
+class WeatherReader {
+public:
+    static constexpr double SCALE = 128.0; // 7 fractional bits
+
+    explicit WeatherReader(const std::string& fileName, const std::string& datasetName = "weatherdata");
+
+    hsize_t rows() const { return dims[0]; }
+    hsize_t columns() const { return dims[1]; }
+    const std::vector<int64_t>& dates() const { return dateIndex.labels(); }
+
+    // Row range [first, last) with dateA <= date <= dateB; empty if none.
+    std::pair<hsize_t, hsize_t> rowRange(int64_t dateA, int64_t dateB) const;
+
+    // Raw fixed-point values of the rows dated within [dateA, dateB], row-major.
+    // Returns the index of the first row; rowCount receives the number of rows.
+    hsize_t rowsBetween(int64_t dateA, int64_t dateB, std::vector<uint32_t>& values, hsize_t& rowCount) const;
+
+    bool isDecimal() const { return !decimalScales.empty(); }
+
+    // Value of a raw word read from the given column.
+    double decode(uint32_t raw, hsize_t column) const;
+
+    static double decode(uint32_t raw) { return raw / SCALE; }
+
+private:
+    H5::H5File file;
+    H5::DataSet dataset;
+    H5::DataType fileType;
+    hsize_t dims[2];
+    h5util::ScaleIndex dateIndex;
+    std::vector<int> decimalScales;
+};
+
+#endif // WEATHER_READER_H
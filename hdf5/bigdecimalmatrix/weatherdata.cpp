@@ -4,11 +4,31 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include "dataset_factory.h"
+#include "dimension_scales.h"
+#include "decimal.h"
 
 const H5std_string FILE_NAME("weatherdata.h5");
 const H5std_string DATA_DATASET("weatherdata");
+const std::string RAW_FILE_NAME("weatherdata.raw");
+const std::string DATE_SCALE("Date");
+const int COLUMNS = 17;
 
-int main() {
+// Usage: weatherdata [--external] [--decimal]
+// --external keeps the fixed-point matrix in weatherdata.raw, outside the HDF5 container.
+// --decimal stores int32 values with a power-of-ten scale per column (the most
+// fraction digits the column has in the CSV) in the "decimalScale" attribute, so
+// every CSV value is kept exactly; by default values are scaled by 128.
+int main(int argc, char* argv[]) {
+    bool external = false;
+    bool decimal = false;
+    for (int i = 1; i < argc; ++i) {
+        external = external || std::string(argv[i]) == "--external";
+        decimal = decimal || std::string(argv[i]) == "--decimal";
+    }
     try {
         // Open and read the CSV file (unchanged)
         std::ifstream csvFile("weatherdata.csv");
@@ -18,6 +38,9 @@ int main() {
 
         std::vector<std::string> headers;
         std::vector<std::vector<uint32_t>> data;
+        std::vector<std::vector<h5util::Decimal>> decimals;
+        std::vector<int> scales(COLUMNS, 0);
+        std::vector<int64_t> dates;
         std::string line;
 
         if (std::getline(csvFile, line)) {
@@ -29,23 +52,64 @@ int main() {
         }
 
         while (std::getline(csvFile, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
             std::stringstream ss(line);
             std::string field;
             std::vector<uint32_t> row;
-            for (int i = 0; i < 17; ++i) {
+            std::vector<h5util::Decimal> decimalRow;
+            for (int i = 0; i < COLUMNS; ++i) {
                 std::getline(ss, field, ',');
-                double value = std::stod(field);
-                row.push_back(static_cast<uint32_t>(value * 128.0 + 0.5));
+                if (i == 0) {
+                    dates.push_back(std::stoll(field)); // yyyymmdd
+                }
+                if (decimal) {
+                    h5util::Decimal cell;
+                    if (!h5util::parseDecimal(field.data(), field.data() + field.size(), cell)) {
+                        throw std::runtime_error("Not a decimal number: '" + field + "'");
+                    }
+                    scales[i] = std::max(scales[i], cell.scale);
+                    decimalRow.push_back(cell);
+                } else {
+                    double value = std::stod(field);
+                    row.push_back(static_cast<uint32_t>(value * 128.0 + 0.5));
+                }
+            }
+            if (decimal) {
+                decimals.push_back(decimalRow);
+            } else {
+                data.push_back(row);
             }
-            data.push_back(row);
         }
         csvFile.close();
 
+        // Keep rows in date order so the Date scale doubles as a row index.
+        if (!std::is_sorted(dates.begin(), dates.end())) {
+            std::vector<size_t> order(dates.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return dates[a] < dates[b]; });
+            std::vector<std::vector<uint32_t>> sortedData;
+            std::vector<std::vector<h5util::Decimal>> sortedDecimals;
+            std::vector<int64_t> sortedDates;
+            for (size_t i : order) {
+                if (decimal) {
+                    sortedDecimals.push_back(decimals[i]);
+                } else {
+                    sortedData.push_back(data[i]);
+                }
+                sortedDates.push_back(dates[i]);
+            }
+            data.swap(sortedData);
+            decimals.swap(sortedDecimals);
+            dates.swap(sortedDates);
+        }
+
         // Create HDF5 file
         H5::H5File file(FILE_NAME, H5F_ACC_TRUNC);
 
         // Write Data dataset
-        hsize_t dataDims[2] = {data.size(), data[0].size()};
+        hsize_t dataDims[2] = {dates.size(), COLUMNS};
         H5::DataSpace dataSpace(2, dataDims);
 
         // Define fixed-point datatype
@@ -56,14 +120,49 @@ int main() {
         H5Tset_order(nativeType, H5T_ORDER_LE);
         H5Tset_pad(nativeType, H5T_PAD_ZERO, H5T_PAD_ZERO);
         H5::DataType dataType(nativeType);
+        H5::DataType decimalType(H5::PredType::STD_I32LE);
+        const H5::DataType& fileType = decimal ? decimalType : dataType;
 
         // Create and write dataset
-        H5::DataSet dataDataset = file.createDataSet(DATA_DATASET, dataType, dataSpace);
-        std::vector<uint32_t> flatData;
-        for (const auto& row : data) {
-            flatData.insert(flatData.end(), row.begin(), row.end());
+        h5util::DatasetOptions options;
+        if (external) {
+            options = h5util::DatasetOptions::external(RAW_FILE_NAME);
         }
-        dataDataset.write(flatData.data(), dataType);
+        const H5::StrType nameType(H5::PredType::C_S1, H5T_VARIABLE);
+        options.headerReserve = h5util::scaleAttachmentHeaderBytes(2) +
+                                h5util::attributeHeaderBytes(h5util::COLUMN_NAMES_ATTRIBUTE, nameType, 1, headers.size());
+        if (decimal) {
+            options.headerReserve +=
+                h5util::attributeHeaderBytes(h5util::DECIMAL_SCALE_ATTRIBUTE, decimalType, 1, scales.size());
+        }
+        H5::DataSet dataDataset = h5util::createDataSet(file, DATA_DATASET, fileType, dataSpace, options);
+        if (decimal) {
+            // Every value of a column at the column's scale: 9.8 becomes 980 next to 9.78's 978.
+            std::vector<int32_t> flatDecimals;
+            for (const auto& row : decimals) {
+                for (size_t c = 0; c < row.size(); ++c) {
+                    int64_t mantissa = 0;
+                    if (!h5util::rescaleDecimal(row[c], scales[c], mantissa) || mantissa < INT32_MIN ||
+                        mantissa > INT32_MAX) {
+                        throw std::runtime_error("Column " + std::to_string(c) + " does not fit 32 bits at scale " +
+                                                 std::to_string(scales[c]));
+                    }
+                    flatDecimals.push_back(static_cast<int32_t>(mantissa));
+                }
+            }
+            dataDataset.write(flatDecimals.data(), H5::PredType::NATIVE_INT32);
+            h5util::writeDecimalScales(dataDataset, scales);
+        } else {
+            std::vector<uint32_t> flatData;
+            for (const auto& row : data) {
+                flatData.insert(flatData.end(), row.begin(), row.end());
+            }
+            dataDataset.write(flatData.data(), dataType);
+        }
+        h5util::writeColumnNames(dataDataset, headers);
+
+        // Sorted yyyymmdd integers on dimension 0, for date-range lookups.
+        h5util::attachScale(file, dataDataset, 0, DATE_SCALE, dates);
         dataDataset.close();
 
         H5Tclose(nativeType);
@@ -0,0 +1,210 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dataset_factory.h"
+#include "decimal.h"
+
+const H5std_string FILE_NAME("weatherdecimal.h5");
+const int COLUMNS = 17;
+
+namespace {
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The CSV rows as decimals, and the scale of each column.
+std::vector<std::vector<h5util::Decimal>> readCsv(std::vector<int>& scales) {
+    std::ifstream csvFile("weatherdata.csv");
+    if (!csvFile.is_open()) {
+        throw std::runtime_error("Could not open weatherdata.csv");
+    }
+    std::vector<std::vector<h5util::Decimal>> rows;
+    scales.assign(COLUMNS, 0);
+    std::string line, field;
+    std::getline(csvFile, line); // header
+    while (std::getline(csvFile, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::stringstream ss(line);
+        std::vector<h5util::Decimal> row(COLUMNS);
+        for (int c = 0; c < COLUMNS; ++c) {
+            std::getline(ss, field, ',');
+            if (!h5util::parseDecimal(field.data(), field.data() + field.size(), row[c])) {
+                throw std::runtime_error("Not a decimal number: '" + field + "'");
+            }
+            scales[c] = std::max(scales[c], row[c].scale);
+        }
+        rows.push_back(row);
+    }
+    if (rows.empty()) throw std::runtime_error("weatherdata.csv has no rows");
+    return rows;
+}
+
+// CSV text of rows records: the real rows repeated with their last digit
+// jittered, so each column keeps its number of fraction digits.
+std::string makeCsv(const std::vector<std::vector<h5util::Decimal>>& seed, const std::vector<int>& scales,
+                    size_t rows) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int64_t> jitter(-50, 50);
+    std::string text;
+    text.reserve(rows * COLUMNS * 8);
+    char buffer[32];
+    for (size_t r = 0; r < rows; ++r) {
+        const std::vector<h5util::Decimal>& base = seed[r % seed.size()];
+        for (int c = 0; c < COLUMNS; ++c) {
+            int64_t mantissa = 0;
+            h5util::rescaleDecimal(base[c], scales[c], mantissa);
+            mantissa = c == 0 ? 20000101 + static_cast<int64_t>(r) : std::max<int64_t>(0, mantissa + jitter(random));
+            if (c > 0) text.push_back(',');
+            text.append(buffer, h5util::formatDecimal(buffer, mantissa, scales[c], true));
+        }
+        text.push_back('\n');
+    }
+    return text;
+}
+
+// Calls fn(first, last, cell) for each field of the CSV text.
+template <typename Fn>
+void forEachField(const std::string& text, Fn fn) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    size_t cell = 0;
+    while (p < end) {
+        const char* q = p;
+        while (q < end && *q != ',' && *q != '\n') ++q;
+        fn(p, q, cell++);
+        p = q + 1;
+    }
+}
+
+H5::DataSet writeMatrix(H5::H5File& file, const std::string& name, const H5::DataType& type, const void* data,
+                        const H5::DataType& memType, hsize_t rows) {
+    hsize_t dims[2] = {rows, COLUMNS};
+    h5util::DatasetOptions options;
+    options.chunkDims = {std::min<hsize_t>(rows, 4096), COLUMNS};
+    options.deflateLevel = 6;
+    options.shuffle = true;
+    H5::DataSet dataset = h5util::createDataSet(file, name, type, H5::DataSpace(2, dims), options);
+    dataset.write(data, memType);
+    return dataset;
+}
+
+} // namespace
+
+// The weather matrix stored with the binary scale of 128 next to the exact
+// decimal encoding: N rows of CSV text in the style of weatherdata.csv are
+// formatted, parsed both ways, written gzip-compressed and decoded again. Every
+// decoded value is compared with strtod of its text.
+//
+// Usage: weatherdecimal [ROWS]  default 1000000
+int main(int argc, char* argv[]) {
+    const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    try {
+        std::vector<int> scales;
+        std::vector<std::vector<h5util::Decimal>> seed = readCsv(scales);
+
+        const std::string text = makeCsv(seed, scales, rows);
+        const size_t cells = rows * COLUMNS;
+        std::vector<double> expected(cells);
+        std::vector<uint32_t> binary(cells);
+        auto start = std::chrono::steady_clock::now();
+        forEachField(text, [&](const char* first, const char*, size_t cell) {
+            expected[cell] = std::strtod(first, nullptr);
+            binary[cell] = static_cast<uint32_t>(expected[cell] * 128.0 + 0.5);
+        });
+        const double strtodMillis = millisSince(start);
+
+        std::vector<int32_t> decimal(cells);
+        start = std::chrono::steady_clock::now();
+        forEachField(text, [&](const char* first, const char* last, size_t cell) {
+            h5util::Decimal value;
+            int64_t mantissa = 0;
+            if (!h5util::parseDecimal(first, last, value) ||
+                !h5util::rescaleDecimal(value, scales[cell % COLUMNS], mantissa)) {
+                throw std::runtime_error("Not a decimal number: '" + std::string(first, last) + "'");
+            }
+            decimal[cell] = static_cast<int32_t>(mantissa);
+        });
+        const double parseMillis = millisSince(start);
+
+        // Formatting back at the column scale, both ways; the texts must agree.
+        char buffer[64], other[64];
+        size_t formatBytes = 0, printfBytes = 0, formatMismatches = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < cells; ++i) {
+            formatBytes += h5util::formatDecimal(buffer, decimal[i], scales[i % COLUMNS]) - buffer;
+        }
+        const double formatMillis = millisSince(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < cells; ++i) {
+            printfBytes += std::snprintf(other, sizeof(other), "%.*f", scales[i % COLUMNS], expected[i]);
+        }
+        const double printfMillis = millisSince(start);
+        for (size_t i = 0; i < cells; ++i) {
+            *h5util::formatDecimal(buffer, decimal[i], scales[i % COLUMNS]) = '\0';
+            std::snprintf(other, sizeof(other), "%.*f", scales[i % COLUMNS], expected[i]);
+            formatMismatches += std::string(buffer) != other;
+        }
+
+        hid_t nativeType = H5Tcopy(H5T_NATIVE_UINT32);
+        H5Tset_precision(nativeType, 25);
+        H5Tset_offset(nativeType, 7);
+        H5Tset_size(nativeType, 4);
+        H5Tset_order(nativeType, H5T_ORDER_LE);
+        H5Tset_pad(nativeType, H5T_PAD_ZERO, H5T_PAD_ZERO);
+        H5::DataType binaryType(nativeType);
+        H5::H5File file(FILE_NAME, H5F_ACC_TRUNC);
+        H5::DataSet binarySet = writeMatrix(file, "binary", binaryType, binary.data(), binaryType, rows);
+        H5::DataSet decimalSet =
+            writeMatrix(file, "decimal", H5::PredType::STD_I32LE, decimal.data(), H5::PredType::NATIVE_INT32, rows);
+        h5util::writeDecimalScales(decimalSet, scales);
+
+        std::vector<double> decoded(cells);
+        start = std::chrono::steady_clock::now();
+        binarySet.read(binary.data(), binaryType);
+        for (size_t i = 0; i < cells; ++i) decoded[i] = binary[i] / 128.0;
+        const double binaryDecodeMillis = millisSince(start);
+        size_t binaryInexact = 0;
+        for (size_t i = 0; i < cells; ++i) binaryInexact += decoded[i] != expected[i];
+
+        start = std::chrono::steady_clock::now();
+        decimalSet.read(decimal.data(), H5::PredType::NATIVE_INT32);
+        h5util::decodeDecimalRows(decimal.data(), rows, COLUMNS, h5util::readDecimalScales(decimalSet),
+                                  decoded.data());
+        const double decimalDecodeMillis = millisSince(start);
+        size_t decimalInexact = 0;
+        for (size_t i = 0; i < cells; ++i) decimalInexact += decoded[i] != expected[i];
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << rows << " rows, " << cells << " values, " << text.size() / 1048576.0 << " MiB of CSV\n";
+        std::cout << "  parse:  parseDecimal " << parseMillis << " ms, strtod + scale 128 " << strtodMillis
+                  << " ms\n";
+        std::cout << "  format: formatDecimal " << formatMillis << " ms, snprintf %.*f " << printfMillis << " ms ("
+                  << formatBytes << " / " << printfBytes << " bytes, " << formatMismatches << " texts differ)\n";
+        std::cout << "  stored (gzip 6 + shuffle): binary " << binarySet.getStorageSize() / 1024.0 << " KiB, decimal "
+                  << decimalSet.getStorageSize() / 1024.0 << " KiB\n";
+        std::cout << "  read + decode: binary " << binaryDecodeMillis << " ms, decimal " << decimalDecodeMillis
+                  << " ms\n";
+        std::cout << "  values differing from their text: binary " << binaryInexact << ", decimal "
+                  << decimalInexact << std::endl;
+        H5Tclose(nativeType);
+    } catch (H5::Exception& error) {
+        std::cerr << "HDF5 Exception: " << error.getDetailMsg() << std::endl;
+        return -1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <H5Cpp.h>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "weather_reader.h"
+
+const H5std_string FILE_NAME("weatherdata.h5");
+
+// Usage: weatherquery FROM_DATE TO_DATE
+// Dates are yyyymmdd, inclusive; only the matching rows are read from the file.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: weatherquery FROM_DATE TO_DATE" << std::endl;
+        return 1;
+    }
+    try {
+        const int64_t from = std::stoll(argv[1]);
+        const int64_t to = std::stoll(argv[2]);
+
+        WeatherReader reader(FILE_NAME);
+        std::vector<uint32_t> values;
+        hsize_t rowCount = 0;
+        hsize_t first = reader.rowsBetween(from, to, values, rowCount);
+
+        std::cout << "Rows [" << first << ", " << first + rowCount << ") of " << reader.rows()
+                  << " match " << from << " - " << to << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+        for (hsize_t r = 0; r < rowCount; ++r) {
+            std::cout << reader.dates()[first + r];
+            // Column 0 repeats the date; print the measurements.
+            for (hsize_t c = 1; c < reader.columns(); ++c) {
+                std::cout << " " << reader.decode(values[r * reader.columns() + c], c);
+            }
+            std::cout << "\n";
+        }
+    } catch (H5::Exception& error) {
+        std::cerr << "HDF5 Exception: " << error.getDetailMsg() << std::endl;
+        return -1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
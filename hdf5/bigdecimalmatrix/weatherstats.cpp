@@ -0,0 +1,162 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dataset_factory.h"
+#include "decimal.h"
+#include "fixed_point.h"
+
+const H5std_string DATA_DATASET("weatherdata");
+const hsize_t BLOCK_ROWS = 64 * 1024;
+const size_t MAX_TEMPERATURE = 1;
+const size_t PRECIPITATION = 10;
+
+namespace {
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Summary {
+    std::vector<double> mean, min, max;
+    size_t hotDays = 0;
+    double precipitationMm = 0;
+    double computeMillis = 0; // excluding reads
+};
+
+// Calls fn(words, rows) for each block of raw fixed-point words, read through
+// the file type so the fractional bits survive.
+template <typename Fn>
+void forEachBlock(const H5::DataSet& dataset, hsize_t dims[2], Fn fn) {
+    H5::DataType fileType = dataset.getDataType();
+    std::vector<uint32_t> block(std::min(BLOCK_ROWS, dims[0]) * dims[1]);
+    for (hsize_t first = 0; first < dims[0]; first += BLOCK_ROWS) {
+        hsize_t offset[2] = {first, 0};
+        hsize_t count[2] = {std::min(BLOCK_ROWS, dims[0] - first), dims[1]};
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        dataset.read(block.data(), fileType, H5::DataSpace(2, count), fileSpace);
+        fn(block.data(), static_cast<size_t>(count[0]));
+    }
+}
+
+// Aggregates computed on the packed words.
+Summary fixedSummary(const H5::DataSet& dataset, hsize_t dims[2]) {
+    const size_t columns = static_cast<size_t>(dims[1]);
+    const uint32_t hot = h5util::toFixed(80.0);
+    const uint32_t millimetresPerInch = h5util::toFixed(25.4);
+    std::vector<h5util::FixedStats> stats;
+    h5util::FixedStats precipitation;
+    std::vector<uint8_t> mask(BLOCK_ROWS);
+    std::vector<uint32_t> millimetres(BLOCK_ROWS);
+    Summary summary;
+    forEachBlock(dataset, dims, [&](const uint32_t* words, size_t rows) {
+        auto start = std::chrono::steady_clock::now();
+        h5util::accumulateFixedColumns(words, rows, columns, stats);
+        summary.hotDays +=
+            h5util::fixedCompare(words + MAX_TEMPERATURE, rows, columns, h5util::Compare::Greater, hot, mask.data());
+        h5util::fixedMultiply(words + PRECIPITATION, rows, columns, millimetresPerInch, millimetres.data());
+        precipitation.merge(h5util::fixedStats(millimetres.data(), rows));
+        summary.computeMillis += millisSince(start);
+    });
+    for (const h5util::FixedStats& column : stats) {
+        summary.mean.push_back(column.mean());
+        summary.min.push_back(h5util::fromFixed(column.min));
+        summary.max.push_back(h5util::fromFixed(column.max));
+    }
+    summary.precipitationMm = h5util::fromFixed(precipitation.sum);
+    return summary;
+}
+
+// The same aggregates after converting every block to double first.
+Summary doubleSummary(const H5::DataSet& dataset, hsize_t dims[2]) {
+    const size_t columns = static_cast<size_t>(dims[1]);
+    std::vector<double> values, sums(columns, 0);
+    Summary summary;
+    summary.min.assign(columns, HUGE_VAL);
+    summary.max.assign(columns, -HUGE_VAL);
+    forEachBlock(dataset, dims, [&](const uint32_t* words, size_t rows) {
+        auto start = std::chrono::steady_clock::now();
+        values.resize(rows * columns);
+        for (size_t i = 0; i < values.size(); ++i) values[i] = words[i] / 128.0;
+        for (size_t r = 0; r < rows; ++r) {
+            const double* row = &values[r * columns];
+            for (size_t c = 0; c < columns; ++c) {
+                sums[c] += row[c];
+                summary.min[c] = std::min(summary.min[c], row[c]);
+                summary.max[c] = std::max(summary.max[c], row[c]);
+            }
+            summary.hotDays += row[MAX_TEMPERATURE] > 80.0;
+            summary.precipitationMm += row[PRECIPITATION] * 25.4;
+        }
+        summary.computeMillis += millisSince(start);
+    });
+    for (double sum : sums) summary.mean.push_back(sum / static_cast<double>(dims[0]));
+    return summary;
+}
+
+} // namespace
+
+// Column mean/min/max, the number of days above 80 °F and the total
+// precipitation in millimetres, computed straight from the fixed-point words of
+// the weather matrix and again after converting them to double.
+//
+// Usage: weatherstats [FILE]  default weatherdata.h5; weathercorr --rows N writes a large one
+int main(int argc, char* argv[]) {
+    const std::string fileName = argc > 1 ? argv[1] : "weatherdata.h5";
+    try {
+        H5::H5File file(fileName, H5F_ACC_RDONLY);
+        H5::DataSet dataset = file.openDataSet(DATA_DATASET);
+        if (dataset.getDataType().getSize() != sizeof(uint32_t) || dataset.getSpace().getSimpleExtentNdims() != 2) {
+            throw std::runtime_error(DATA_DATASET + " is not a 32-bit fixed-point matrix");
+        }
+        if (!h5util::readDecimalScales(dataset).empty()) {
+            throw std::runtime_error(DATA_DATASET + " was written with --decimal; these kernels need the binary scale");
+        }
+        hsize_t dims[2];
+        dataset.getSpace().getSimpleExtentDims(dims);
+        if (dims[1] <= PRECIPITATION) {
+            throw std::runtime_error(DATA_DATASET + " has too few columns");
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Summary fixed = fixedSummary(dataset, dims);
+        const double fixedMillis = millisSince(start);
+        start = std::chrono::steady_clock::now();
+        Summary converted = doubleSummary(dataset, dims);
+        const double doubleMillis = millisSince(start);
+
+        std::vector<std::string> names = h5util::readColumnNames(dataset);
+        names.resize(dims[1]);
+        double maxDifference = 0;
+        std::cout << std::fixed << std::setprecision(3);
+        for (hsize_t c = 1; c < dims[1]; ++c) {
+            std::cout << "  " << std::left << std::setw(40) << names[c] << std::right << " mean " << std::setw(10)
+                      << fixed.mean[c] << "  min " << std::setw(9) << fixed.min[c] << "  max " << std::setw(9)
+                      << fixed.max[c] << std::endl;
+            maxDifference = std::max({maxDifference, std::fabs(fixed.mean[c] - converted.mean[c]),
+                                      std::fabs(fixed.min[c] - converted.min[c]),
+                                      std::fabs(fixed.max[c] - converted.max[c])});
+        }
+        std::cout << "Days above 80 F: " << fixed.hotDays << " (double path " << converted.hotDays
+                  << "), precipitation " << fixed.precipitationMm << " mm (double path "
+                  << converted.precipitationMm << ")" << std::endl;
+        std::cout << std::setprecision(2) << dims[0] << " rows: fixed-point " << fixedMillis << " ms (compute "
+                  << fixed.computeMillis << "), via double " << doubleMillis << " ms (compute "
+                  << converted.computeMillis << "), max column difference " << std::scientific << maxDifference
+                  << std::endl;
+    } catch (H5::Exception& error) {
+        std::cerr << "HDF5 Exception: " << error.getDetailMsg() << std::endl;
+        return -1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
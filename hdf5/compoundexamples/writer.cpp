@@ -1,5 +1,6 @@
 // writer.cpp
 #include "common_cpp.h" // Includes Record (varStr is const char*), constants, createCompoundType()
+#include "dataset_factory.h"
 
 #include <iostream>
 #include <vector>
@@ -56,15 +57,21 @@ int main() {
 
         hsize_t dims[1] = {NUM_RECORDS}; // NUM_RECORDS macro from common.h
         H5::DataSpace dataspace(1, dims);
-        H5::DataSet dataset = file.createDataSet(DATASET_NAME, compound_type, dataspace);
-        std::cout << "Info (writer.cpp): Dataset '" << DATASET_NAME.c_str() << "' created." << std::endl;
-
-        // --- Add Attribute ---
+        // --- Attribute type, known up front so the dataset header can be sized for it ---
         H5std_string attribute_value_content = "Revision: , URL: ";
         H5::StrType attr_type(H5::PredType::C_S1, H5T_VARIABLE); 
         attr_type.setCset(H5T_CSET_UTF8);
         attr_type.setStrpad(H5T_STR_NULLTERM);
         H5::DataSpace attr_space(H5S_SCALAR); 
+
+        // The compound type message alone fills the default header; reserve room for
+        // the attribute so it does not land in a continuation block.
+        h5util::DatasetOptions options;
+        options.headerReserve = h5util::attributeHeaderBytes(ATTRIBUTE_NAME, attr_type);
+        H5::DataSet dataset = h5util::createDataSet(file, DATASET_NAME, compound_type, dataspace, options);
+        std::cout << "Info (writer.cpp): Dataset '" << DATASET_NAME.c_str() << "' created." << std::endl;
+
+        // --- Add Attribute ---
         H5::Attribute attribute = dataset.createAttribute(ATTRIBUTE_NAME, attr_type, attr_space);
         const char* attr_data_ptr = attribute_value_content.c_str();
         attribute.write(attr_type, &attr_data_ptr);
@@ -1,6 +1,7 @@
 #include <H5Cpp.h>
 #include <iostream>
 #include <vector>
+#include "dataset_factory.h"
 
 using namespace H5;
 
@@ -9,13 +10,16 @@ int main() {
         // Create an HDF5 file
         H5File file("dimensions.h5", H5F_ACC_TRUNC);
 
+        // All of these datasets are a few bytes: the shared factory makes them compact
+        h5util::DatasetOptions options;
+
         // 1. Scalar dataset (no dimensionality)
         {
             // Create scalar dataspace
             DataSpace scalar_space(H5S_SCALAR);
             
             // Create dataset with a single double value
-            DataSet dataset = file.createDataSet("scalar_dataset", PredType::NATIVE_DOUBLE, scalar_space);
+            DataSet dataset = h5util::createDataSet(file, "scalar_dataset", PredType::NATIVE_DOUBLE, scalar_space, options);
             
             // Write a single value
             double value = 42.0;
@@ -31,7 +35,7 @@ int main() {
             DataSpace dataspace(1, dims);
             
             // Create dataset
-            DataSet dataset = file.createDataSet("1d_dataset", PredType::NATIVE_DOUBLE, dataspace);
+            DataSet dataset = h5util::createDataSet(file, "1d_dataset", PredType::NATIVE_DOUBLE, dataspace, options);
             
             // Write data
             std::vector<double> data = {1.0, 2.0, 3.0, 4.0, 5.0};
@@ -47,7 +51,7 @@ int main() {
             DataSpace dataspace(2, dims);
             
             // Create dataset
-            DataSet dataset = file.createDataSet("2d_dataset", PredType::NATIVE_DOUBLE, dataspace);
+            DataSet dataset = h5util::createDataSet(file, "2d_dataset", PredType::NATIVE_DOUBLE, dataspace, options);
             
             // Write data
             std::vector<double> data = {1.1, 2.2, 3.3, 4.4, 5.5, 6.6};
@@ -63,7 +67,7 @@ int main() {
             DataSpace dataspace(2, dims);
             
             // Create dataset
-            DataSet dataset = file.createDataSet("2d_dataset_permuted", PredType::NATIVE_DOUBLE, dataspace);
+            DataSet dataset = h5util::createDataSet(file, "2d_dataset_permuted", PredType::NATIVE_DOUBLE, dataspace, options);
             
             // Write data
             std::vector<double> data = {7.7, 8.8, 9.9, 10.0, 11.1, 12.2};
@@ -3,6 +3,9 @@
 #include <random>
 #include <vector>
 #include <cstring>
+#include "dataset_factory.h"
+#include "multi_io.h"
+#include "attribute_bulk.h"
 
 using namespace H5;
 const H5std_string ATTRIBUTE_NAME("GIT root revision");
@@ -14,50 +17,48 @@ int main() {
     // Create a scalar dataspace for all datasets
     H5::DataSpace scalarSpace(H5S_SCALAR);
 
-    // Define the attribute value once
+    // Tiny datasets: the shared factory stores them compact, inside the object header
+    h5util::DatasetOptions options;
+
+    // Define the attribute once; it is written to every dataset at the end
     H5std_string attribute_value = "Revision: , URL: ";
-    StrType attr_type(PredType::C_S1, attribute_value.size());
-    DataSpace attr_space(H5S_SCALAR);
+    h5util::AttributeSet attributes;
+    attributes.addString(ATTRIBUTE_NAME, attribute_value);
+
+    // The four values go out in one batched write once every dataset exists
+    h5util::MultiWriter writer;
 
     // 1. "byte" dataset (8-bit signed integer)
     H5::IntType byteType(PredType::NATIVE_INT8); // 1 byte, signed
     byteType.setOrder(H5T_ORDER_LE);
-    H5::DataSet byteDataset = file.createDataSet("byte", byteType, scalarSpace);
+    H5::DataSet byteDataset = h5util::createDataSet(file, "byte", byteType, scalarSpace, options);
     int8_t byteValue = 42;
-    byteDataset.write(&byteValue, PredType::NATIVE_INT8);
-    Attribute byteAttr = byteDataset.createAttribute(ATTRIBUTE_NAME, attr_type, attr_space);
-    byteAttr.write(attr_type, attribute_value);
-    byteAttr.close();
+    writer.add(byteDataset, PredType::NATIVE_INT8, &byteValue);
 
     // 2. "short" dataset (16-bit signed integer)
     H5::IntType shortType(PredType::NATIVE_INT16); // 2 bytes, signed
     shortType.setOrder(H5T_ORDER_LE);
-    H5::DataSet shortDataset = file.createDataSet("short", shortType, scalarSpace);
+    H5::DataSet shortDataset = h5util::createDataSet(file, "short", shortType, scalarSpace, options);
     int16_t shortValue = 42;
-    shortDataset.write(&shortValue, PredType::NATIVE_INT16);
-    Attribute shortAttr = shortDataset.createAttribute(ATTRIBUTE_NAME, attr_type, attr_space);
-    shortAttr.write(attr_type, attribute_value);
-    shortAttr.close();
+    writer.add(shortDataset, PredType::NATIVE_INT16, &shortValue);
 
     // 3. "integer" dataset (32-bit signed integer)
     H5::IntType intType(PredType::NATIVE_INT32); // 4 bytes, signed
     intType.setOrder(H5T_ORDER_LE);
-    H5::DataSet intDataset = file.createDataSet("integer", intType, scalarSpace);
+    H5::DataSet intDataset = h5util::createDataSet(file, "integer", intType, scalarSpace, options);
     int32_t intValue = 42;
-    intDataset.write(&intValue, PredType::NATIVE_INT32);
-    Attribute intAttr = intDataset.createAttribute(ATTRIBUTE_NAME, attr_type, attr_space);
-    intAttr.write(attr_type, attribute_value);
-    intAttr.close();
+    writer.add(intDataset, PredType::NATIVE_INT32, &intValue);
 
     // 4. "long" dataset (64-bit signed integer)
     H5::IntType longType(PredType::NATIVE_INT64); // 8 bytes, signed
     longType.setOrder(H5T_ORDER_LE);
-    H5::DataSet longDataset = file.createDataSet("long", longType, scalarSpace);
+    H5::DataSet longDataset = h5util::createDataSet(file, "long", longType, scalarSpace, options);
     int64_t longValue = 42;
-    longDataset.write(&longValue, PredType::NATIVE_INT64);
-    Attribute longAttr = longDataset.createAttribute(ATTRIBUTE_NAME, attr_type, attr_space);
-    longAttr.write(attr_type, attribute_value);
-    longAttr.close();
+    writer.add(longDataset, PredType::NATIVE_INT64, &longValue);
+
+    writer.execute();
+    std::vector<H5::H5Object*> datasets = {&byteDataset, &shortDataset, &intDataset, &longDataset};
+    attributes.writeToAll(datasets);
 
     std::cout << "Created scalar.h5 with datasets: byte, short, integer, long" << std::endl;
     return 0;
@@ -3,15 +3,21 @@
 #include <random>
 #include <vector>
 #include <cstring>  // For memcpy
+#include <string>
+#include "dataset_factory.h"
 
 using namespace H5;
 
 const H5std_string FILE_NAME("vector.h5");
 const H5std_string DATASET_NAME("vector");
+const std::string RAW_FILE_NAME("vector.raw");
 const H5std_string ATTRIBUTE_NAME("GIT root revision");
 const uint32_t NUM_RECORDS = 1000;
 
-int main() {
+// Usage: writevector [--external]
+// --external keeps the raw int64 values in vector.raw, outside the HDF5 container.
+int main(int argc, char* argv[]) {
+    bool external = argc > 1 && std::string(argv[1]) == "--external";
     try {
         // Set up random number generation
         // std::random_device rd;
@@ -36,7 +42,11 @@ int main() {
         DataSpace dataspace(1, dim, maxdim);
 
         // Create the dataset
-        H5::DataSet dataset = file.createDataSet(DATASET_NAME, datatype, dataspace);
+        h5util::DatasetOptions options;
+        if (external) {
+            options = h5util::DatasetOptions::external(RAW_FILE_NAME);
+        }
+        H5::DataSet dataset = h5util::createDataSet(file, DATASET_NAME, datatype, dataspace, options);
 
         // ✅ ADD ATTRIBUTE: "GIT root revision"
         H5std_string attribute_value = "Revision: , URL: ";
@@ -54,10 +64,16 @@ int main() {
         file.close();
 
         std::cout << "HDF5 file '" << FILE_NAME << "' created with dataset '/temperature' containing RECORDS random values successfully.\n";
+        if (external) {
+            std::cout << "Raw data stored externally in '" << RAW_FILE_NAME << "'.\n";
+        }
 
     } catch (H5::Exception &error) {
         std::cerr << "HDF5 Exception: " << error.getDetailMsg() << std::endl;
         return -1;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
     }
 
     return 0;
@@ -1,31 +1,21 @@
 #include <H5Cpp.h>
 #include <string>
+#include "monitoring_common.h"
 
 using namespace H5;
 
-struct EnvData {
-    char site_name[20];  // Fixed-size string
-    float aqi;
-    double temp;
-    int sample_count;
-};
-
 int main() {
     H5File file("monitoring.h5", H5F_ACC_TRUNC);
 
     // Define compound datatype
-    CompType datatype(sizeof(EnvData));
-    datatype.insertMember("siteName", HOFFSET(EnvData, site_name), StrType(PredType::C_S1, 20));
-    datatype.insertMember("airQualityIndex", HOFFSET(EnvData, aqi), PredType::NATIVE_FLOAT);
-    datatype.insertMember("temperature", HOFFSET(EnvData, temp), PredType::NATIVE_DOUBLE);
-    datatype.insertMember("sampleCount", HOFFSET(EnvData, sample_count), PredType::NATIVE_INT);
+    CompType datatype = createEnvDataType();
 
     // Define dataspace (10 rows)
     hsize_t dims[1] = {10};
     DataSpace dataspace(1, dims);
 
     // Create dataset
-    DataSet dataset = file.createDataSet("monitoring", datatype, dataspace);
+    DataSet dataset = file.createDataSet(MONITORING_DATASET, datatype, dataspace);
 
     // Example data (manually filled for brevity)
     EnvData data[10] = {
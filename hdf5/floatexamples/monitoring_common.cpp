@@ -0,0 +1,25 @@
+// monitoring_common.cpp
+#include "monitoring_common.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace H5;
+
+CompType createEnvDataType() {
+    CompType datatype(sizeof(EnvData));
+    datatype.insertMember("siteName", HOFFSET(EnvData, site_name), StrType(PredType::C_S1, SITE_NAME_LEN));
+    datatype.insertMember("airQualityIndex", HOFFSET(EnvData, aqi), PredType::NATIVE_FLOAT);
+    datatype.insertMember("temperature", HOFFSET(EnvData, temp), PredType::NATIVE_DOUBLE);
+    datatype.insertMember("sampleCount", HOFFSET(EnvData, sample_count), PredType::NATIVE_INT);
+    return datatype;
+}
+
+EnvData makeSample(long index) {
+    EnvData sample{};
+    std::snprintf(sample.site_name, SITE_NAME_LEN, "Station %c", static_cast<char>('A' + index % 5));
+    double t = static_cast<double>(index) / 5.0;
+    sample.aqi = static_cast<float>(100.0 + 80.0 * std::sin(t / 360.0) + (index % 7) * 3.5);
+    sample.temp = 10.0 + 15.0 * std::sin(t / 1440.0) + (index % 11) * 0.25;
+    sample.sample_count = static_cast<int>(index % 30);
+    return sample;
+}
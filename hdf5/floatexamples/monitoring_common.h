@@ -0,0 +1,24 @@
+// monitoring_common.h
+#ifndef MONITORING_COMMON_H
+#define MONITORING_COMMON_H
+
+#include <H5Cpp.h>
+
+#define MONITORING_DATASET "monitoring"
+#define SITE_NAME_LEN 20
+
+struct EnvData {
+    char site_name[SITE_NAME_LEN];  // Fixed-size string
+    float aqi;
+    double temp;
+    int sample_count;
+};
+
+// Compound type shared by every monitoring writer and reader.
+H5::CompType createEnvDataType();
+
+// Deterministic synthetic reading for the streaming writers: five stations
+// reporting in turn with slowly drifting values.
+EnvData makeSample(long index);
+
+#endif // MONITORING_COMMON_H
@@ -0,0 +1,105 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "monitoring_common.h"
+#include "group_by.h"
+
+using namespace H5;
+
+namespace {
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void writeSamples(const char* fileName, long records) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    CompType datatype = createEnvDataType();
+    hsize_t dims[1] = {static_cast<hsize_t>(records)};
+    DataSet dataset = file.createDataSet(MONITORING_DATASET, datatype, DataSpace(1, dims));
+    std::vector<EnvData> samples(records);
+    for (long i = 0; i < records; ++i) samples[i] = makeSample(i);
+    dataset.write(samples.data(), datatype);
+}
+
+struct Baseline {
+    hsize_t rows = 0;
+    double aqiSum = 0;
+    double maxTemp = -INFINITY;
+};
+
+} // namespace
+
+// Average airQualityIndex and max temperature per siteName, computed by the
+// streaming h5util::GroupBy and, as a check, by reading every record into
+// EnvData and accumulating in a std::map.
+//
+// Usage: monitoring_groupby [FILE]            default monitoring_ingest.h5
+//        monitoring_groupby --write N [FILE]  first write N synthetic samples
+int main(int argc, char* argv[]) {
+    const char* fileName = "monitoring_ingest.h5";
+    try {
+        if (argc > 2 && std::string(argv[1]) == "--write") {
+            fileName = argc > 3 ? argv[3] : "monitoring_groupby.h5";
+            writeSamples(fileName, std::strtol(argv[2], nullptr, 10));
+        } else if (argc > 1) {
+            fileName = argv[1];
+        }
+
+        H5File file(fileName, H5F_ACC_RDONLY);
+        DataSet dataset = file.openDataSet(MONITORING_DATASET);
+
+        auto start = std::chrono::steady_clock::now();
+        h5util::GroupBy groupBy(dataset, "siteName",
+                                {{h5util::Aggregate::Mean, "airQualityIndex"}, {h5util::Aggregate::Max, "temperature"}});
+        groupBy.consumeAll();
+        std::vector<h5util::GroupRow> groups = groupBy.result();
+        const double groupByMillis = millisSince(start);
+
+        start = std::chrono::steady_clock::now();
+        hsize_t rows = dataset.getSpace().getSimpleExtentNpoints();
+        std::vector<EnvData> records(rows);
+        dataset.read(records.data(), createEnvDataType());
+        std::map<std::string, Baseline> baseline;
+        for (const EnvData& record : records) {
+            Baseline& site = baseline[std::string(record.site_name, strnlen(record.site_name, SITE_NAME_LEN))];
+            ++site.rows;
+            site.aqiSum += record.aqi;
+            site.maxTemp = std::max(site.maxTemp, record.temp);
+        }
+        const double baselineMillis = millisSince(start);
+
+        std::cout << std::left << std::setw(SITE_NAME_LEN) << "siteName" << std::right << std::setw(10) << "rows"
+                  << std::setw(14) << "avg AQI" << std::setw(14) << "max temp" << std::endl;
+        bool matches = groups.size() == baseline.size();
+        for (const h5util::GroupRow& group : groups) {
+            std::cout << std::left << std::setw(SITE_NAME_LEN) << group.key << std::right << std::setw(10)
+                      << group.rows << std::fixed << std::setprecision(3) << std::setw(14) << group.values[0]
+                      << std::setw(14) << group.values[1] << std::endl;
+            auto expected = baseline.find(group.key);
+            matches = matches && expected != baseline.end() && expected->second.rows == group.rows &&
+                      std::fabs(expected->second.aqiSum / expected->second.rows - group.values[0]) < 1e-6 &&
+                      expected->second.maxTemp == group.values[1];
+        }
+        const h5util::GroupByStats& stats = groupBy.stats();
+        std::cout << std::setprecision(2) << rows << " rows: GroupBy " << groupByMillis << " ms (read "
+                  << stats.readSeconds * 1000 << ", aggregate " << stats.aggregateSeconds * 1000 << ", merge "
+                  << stats.mergeSeconds * 1000 << "), full read + std::map " << baselineMillis << " ms, results "
+                  << (matches ? "match" : "DIFFER") << std::endl;
+        return matches ? 0 : 1;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,126 @@
+#include <H5Cpp.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "monitoring_common.h"
+#include "hash_join.h"
+
+using namespace H5;
+
+namespace {
+
+const char* STATIONS_DATASET = "stations";
+const char* JOINED_DATASET = "monitoring_with_station";
+
+struct Station {
+    char site_name[SITE_NAME_LEN];
+    double latitude;
+    double longitude;
+    float elevation;
+};
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+CompType createStationType() {
+    CompType type(sizeof(Station));
+    type.insertMember("siteName", HOFFSET(Station, site_name), StrType(PredType::C_S1, SITE_NAME_LEN));
+    type.insertMember("latitude", HOFFSET(Station, latitude), PredType::NATIVE_DOUBLE);
+    type.insertMember("longitude", HOFFSET(Station, longitude), PredType::NATIVE_DOUBLE);
+    type.insertMember("elevation", HOFFSET(Station, elevation), PredType::NATIVE_FLOAT);
+    return type;
+}
+
+// Metadata for the five stations makeSample reports from.
+void writeStations(const char* fileName) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    std::vector<Station> stations(5);
+    for (size_t i = 0; i < stations.size(); ++i) {
+        std::snprintf(stations[i].site_name, SITE_NAME_LEN, "Station %c", static_cast<char>('A' + i));
+        stations[i].latitude = 47.0 + 0.25 * i;
+        stations[i].longitude = 8.0 + 0.5 * i;
+        stations[i].elevation = static_cast<float>(400 + 150 * i);
+    }
+    hsize_t dims[1] = {stations.size()};
+    CompType datatype = createStationType();
+    DataSet dataset = file.createDataSet(STATIONS_DATASET, datatype, DataSpace(1, dims));
+    dataset.write(stations.data(), datatype);
+}
+
+void writeSamples(const char* fileName, long records) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    CompType datatype = createEnvDataType();
+    hsize_t dims[1] = {static_cast<hsize_t>(records)};
+    DataSet dataset = file.createDataSet(MONITORING_DATASET, datatype, DataSpace(1, dims));
+    std::vector<EnvData> samples(records);
+    for (long i = 0; i < records; ++i) samples[i] = makeSample(i);
+    dataset.write(samples.data(), datatype);
+}
+
+} // namespace
+
+// Joins every monitoring sample to its station's coordinates with
+// h5util::hashJoin and writes the widened rows next to the samples.
+//
+// Usage: monitoring_join [--budget MiB] [FILE]            default monitoring_ingest.h5
+//        monitoring_join [--budget MiB] --write N [FILE]  first write N synthetic samples
+int main(int argc, char* argv[]) {
+    const char* fileName = "monitoring_ingest.h5";
+    const char* stationsFile = "monitoring_join_stations.h5";
+    h5util::JoinOptions options;
+    try {
+        int arg = 1;
+        if (argc > arg + 1 && std::string(argv[arg]) == "--budget") {
+            options.memoryBudget = static_cast<size_t>(std::strtoul(argv[arg + 1], nullptr, 10)) << 20;
+            arg += 2;
+        }
+        if (argc > arg + 1 && std::string(argv[arg]) == "--write") {
+            fileName = argc > arg + 2 ? argv[arg + 2] : "monitoring_join.h5";
+            writeSamples(fileName, std::strtol(argv[arg + 1], nullptr, 10));
+        } else if (argc > arg) {
+            fileName = argv[arg];
+        }
+        writeStations(stationsFile);
+
+        H5File file(fileName, H5F_ACC_RDWR);
+        H5File stations(stationsFile, H5F_ACC_RDONLY);
+        DataSet samples = file.openDataSet(MONITORING_DATASET);
+        H5E_BEGIN_TRY {
+            H5Ldelete(file.getId(), JOINED_DATASET, H5P_DEFAULT);
+        } H5E_END_TRY;
+
+        auto start = std::chrono::steady_clock::now();
+        h5util::JoinStats stats = h5util::hashJoin(samples, "siteName", stations.openDataSet(STATIONS_DATASET),
+                                                   "siteName", file, JOINED_DATASET, options);
+        const double joinMillis = millisSince(start);
+
+        const hsize_t rows = samples.getSpace().getSimpleExtentNpoints();
+        DataSet joined = file.openDataSet(JOINED_DATASET);
+        CompType joinedType = joined.getCompType();
+        std::cout << JOINED_DATASET << ":";
+        for (int i = 0; i < joinedType.getNmembers(); ++i) {
+            std::cout << " " << joinedType.getMemberName(static_cast<unsigned>(i));
+        }
+        std::cout << std::endl;
+        std::cout << std::fixed << std::setprecision(2) << rows << " samples x " << stats.buildRows
+                  << " stations -> " << stats.outputRows << " rows in " << joinMillis << " ms (";
+        if (stats.partitions > 0) {
+            std::cout << stats.partitions << " partitions " << stats.partitionSeconds * 1000 << ", ";
+        }
+        std::cout << "build " << stats.buildSeconds * 1000 << ", probe " << stats.probeSeconds * 1000 << ")"
+                  << std::endl;
+        return stats.outputRows == rows ? 0 : 1;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
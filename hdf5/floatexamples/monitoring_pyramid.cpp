@@ -0,0 +1,146 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "monitoring_common.h"
+#include "append_buffer.h"
+#include "pyramid.h"
+
+using namespace H5;
+
+namespace {
+
+const char* PYRAMID_GROUP = "temperature_pyramid";
+const size_t BLOCK_ROWS = 10000;
+const size_t PIXELS = 2000;
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Appends records samples in blocks, as a logger would, and keeps the
+// temperature pyramid up to date with the row index as time. The pyramid
+// writer is closed and reopened halfway to show it resuming from its tail.
+void writeSamples(const char* fileName, long records) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    CompType datatype = createEnvDataType();
+    DataSet dataset = h5util::createAppendableDataSet(file, MONITORING_DATASET, datatype, {}, 4096);
+    h5util::AppendBuffer out(dataset, datatype);
+    std::unique_ptr<h5util::PyramidWriter> pyramid(new h5util::PyramidWriter(file, PYRAMID_GROUP));
+
+    std::vector<EnvData> block;
+    std::vector<double> times, temperatures;
+    for (long first = 0; first < records; first += BLOCK_ROWS) {
+        const long rows = std::min<long>(BLOCK_ROWS, records - first);
+        block.resize(rows);
+        times.resize(rows);
+        temperatures.resize(rows);
+        for (long i = 0; i < rows; ++i) {
+            block[i] = makeSample(first + i);
+            times[i] = static_cast<double>(first + i);
+            temperatures[i] = block[i].temp;
+        }
+        out.append(block.data(), rows);
+        pyramid->append(times.data(), temperatures.data(), rows);
+        if (first < records / 2 && first + rows >= records / 2) {
+            pyramid->close();
+            pyramid.reset(new h5util::PyramidWriter(file, PYRAMID_GROUP));
+        }
+    }
+}
+
+// Compares every bucket of one level with the raw rows it summarises.
+bool matchesRaw(const std::vector<EnvData>& samples, const std::vector<h5util::PyramidBucket>& buckets,
+                hsize_t bucketRows) {
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        const size_t first = b * bucketRows;
+        const size_t last = std::min<size_t>(samples.size(), first + bucketRows);
+        double sum = 0, low = INFINITY, high = -INFINITY;
+        for (size_t i = first; i < last; ++i) {
+            sum += samples[i].temp;
+            low = std::min(low, samples[i].temp);
+            high = std::max(high, samples[i].temp);
+        }
+        const h5util::PyramidBucket& bucket = buckets[b];
+        if (bucket.count != last - first || bucket.start != first || bucket.end != last - 1 || bucket.min != low ||
+            bucket.max != high || std::fabs(bucket.mean - sum / (last - first)) > 1e-9) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Downsampled temperature for a 2000-pixel chart: the whole series, then a
+// narrow range, each answered from the pyramid level that fits the width.
+// With --write the samples and the pyramid are written first; the level chosen
+// for the whole series is checked against the raw rows, and the narrow range,
+// small enough to need raw rows, is thinned with LTTB.
+//
+// Usage: monitoring_pyramid [FILE]            default monitoring_pyramid.h5
+//        monitoring_pyramid --write N [FILE]  first write N synthetic samples
+int main(int argc, char* argv[]) {
+    const char* fileName = "monitoring_pyramid.h5";
+    try {
+        if (argc > 2 && std::string(argv[1]) == "--write") {
+            fileName = argc > 3 ? argv[3] : fileName;
+            auto start = std::chrono::steady_clock::now();
+            writeSamples(fileName, std::strtol(argv[2], nullptr, 10));
+            std::cout << "Wrote " << argv[2] << " samples with pyramid in " << std::fixed << std::setprecision(2)
+                      << millisSince(start) << " ms" << std::endl;
+        } else if (argc > 1) {
+            fileName = argv[1];
+        }
+
+        H5File file(fileName, H5F_ACC_RDONLY);
+        h5util::PyramidReader pyramid(file, PYRAMID_GROUP);
+        const double lastTime = static_cast<double>(pyramid.rows()) - 1;
+
+        auto start = std::chrono::steady_clock::now();
+        h5util::PyramidSelection whole = pyramid.select(0, lastTime, PIXELS);
+        std::vector<h5util::PyramidBucket> buckets = pyramid.read(whole);
+        const double wholeMillis = millisSince(start);
+
+        DataSet dataset = file.openDataSet(MONITORING_DATASET);
+        std::vector<EnvData> samples(dataset.getSpace().getSimpleExtentNpoints());
+        start = std::chrono::steady_clock::now();
+        dataset.read(samples.data(), createEnvDataType());
+        const double rawMillis = millisSince(start);
+        bool matches = samples.size() == pyramid.rows() &&
+                       (whole.level == 0 || matchesRaw(samples, buckets, hsize_t(1) << whole.level));
+
+        std::cout << std::fixed << std::setprecision(2) << "0 - " << lastTime << ": level " << whole.level << ", "
+                  << buckets.size() << " buckets in " << wholeMillis << " ms (full raw read " << rawMillis
+                  << " ms), " << (matches ? "matches raw rows" : "DIFFERS from raw rows") << std::endl;
+
+        const double from = lastTime / 3, to = from + PIXELS * 0.75;
+        h5util::PyramidSelection narrow = pyramid.select(from, to, PIXELS);
+        std::cout << from << " - " << to << ": level " << narrow.level << ", rows [" << narrow.first << ", "
+                  << narrow.first + narrow.count << ")";
+        if (narrow.level == 0) {
+            std::vector<double> times, temperatures;
+            for (hsize_t i = narrow.first; i < narrow.first + narrow.count; ++i) {
+                times.push_back(static_cast<double>(i));
+                temperatures.push_back(samples[i].temp);
+            }
+            std::vector<size_t> points =
+                h5util::largestTriangleThreeBuckets(times.data(), temperatures.data(), times.size(), PIXELS / 4);
+            std::cout << ", LTTB keeps " << points.size() << " points";
+        }
+        std::cout << std::endl;
+        return matches ? 0 : 1;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,137 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "monitoring_common.h"
+#include "append_buffer.h"
+#include "sketch.h"
+
+using namespace H5;
+
+namespace {
+
+const char* SKETCH_GROUP = "monitoring_sketches";
+const size_t BLOCK_ROWS = 10000;
+const std::vector<std::string> SKETCHED = {"siteName", "airQualityIndex", "temperature", "sampleCount"};
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Appends samples in blocks and sketches them on the way, as a logger would.
+void writeSamples(const char* fileName, long records) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    CompType datatype = createEnvDataType();
+    DataSet dataset = h5util::createAppendableDataSet(file, MONITORING_DATASET, datatype, {}, 4096);
+    h5util::AppendBuffer out(dataset, datatype);
+    h5util::SketchWriter sketches(file, SKETCH_GROUP, datatype, SKETCHED);
+    std::vector<EnvData> block;
+    for (long first = 0; first < records; first += BLOCK_ROWS) {
+        const long rows = std::min<long>(BLOCK_ROWS, records - first);
+        block.resize(rows);
+        for (long i = 0; i < rows; ++i) block[i] = makeSample(first + i);
+        out.append(block.data(), rows);
+        sketches.append(block.data(), rows);
+    }
+}
+
+// Exact value at quantile q, by selection on a copy.
+double exactQuantile(std::vector<double> values, double q) {
+    const size_t rank = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+} // namespace
+
+// Percentiles and distinct counts of the monitoring columns from sketches,
+// compared with exact answers from a full read. Without --write the sketches
+// of an existing file are built by one scan first.
+//
+// Usage: monitoring_sketch [FILE]            default monitoring_ingest.h5
+//        monitoring_sketch --write N [FILE]  write N samples, sketched while written
+int main(int argc, char* argv[]) {
+    const char* fileName = "monitoring_ingest.h5";
+    try {
+        if (argc > 2 && std::string(argv[1]) == "--write") {
+            fileName = argc > 3 ? argv[3] : "monitoring_sketch.h5";
+            auto start = std::chrono::steady_clock::now();
+            writeSamples(fileName, std::strtol(argv[2], nullptr, 10));
+            std::cout << "Wrote and sketched " << argv[2] << " samples in " << std::fixed << std::setprecision(2)
+                      << millisSince(start) << " ms" << std::endl;
+        } else {
+            if (argc > 1) fileName = argv[1];
+            H5File file(fileName, H5F_ACC_RDWR);
+            H5E_BEGIN_TRY {
+                H5Ldelete(file.getId(), SKETCH_GROUP, H5P_DEFAULT);
+            } H5E_END_TRY;
+            auto start = std::chrono::steady_clock::now();
+            h5util::sketchDataSet(file.openDataSet(MONITORING_DATASET), file, SKETCH_GROUP, SKETCHED);
+            std::cout << "Sketched " << fileName << " in " << std::fixed << std::setprecision(2)
+                      << millisSince(start) << " ms" << std::endl;
+        }
+
+        H5File file(fileName, H5F_ACC_RDONLY);
+        auto start = std::chrono::steady_clock::now();
+        h5util::SketchReader reader(file, SKETCH_GROUP);
+        h5util::TDigest temperature = reader.quantiles("temperature");
+        h5util::TDigest aqi = reader.quantiles("airQualityIndex");
+        const double sketch[6] = {temperature.quantile(0.5), temperature.quantile(0.99), aqi.quantile(0.5),
+                                  aqi.quantile(0.99), reader.distinct("siteName").estimate(),
+                                  reader.distinct("temperature").estimate()};
+        const hsize_t chunks = std::min<hsize_t>(10, reader.chunks());
+        const double firstChunksP99 = reader.quantiles("temperature", 0, chunks).quantile(0.99);
+        const double sketchMillis = millisSince(start);
+
+        start = std::chrono::steady_clock::now();
+        DataSet dataset = file.openDataSet(MONITORING_DATASET);
+        std::vector<EnvData> samples(dataset.getSpace().getSimpleExtentNpoints());
+        dataset.read(samples.data(), createEnvDataType());
+        std::vector<double> temperatures, aqis;
+        std::unordered_set<std::string> sites;
+        std::unordered_set<double> distinctTemperatures;
+        for (const EnvData& sample : samples) {
+            temperatures.push_back(sample.temp);
+            aqis.push_back(sample.aqi);
+            sites.insert(std::string(sample.site_name, strnlen(sample.site_name, SITE_NAME_LEN)));
+            distinctTemperatures.insert(sample.temp);
+        }
+        const double exact[6] = {exactQuantile(temperatures, 0.5),
+                                 exactQuantile(temperatures, 0.99),
+                                 exactQuantile(aqis, 0.5),
+                                 exactQuantile(aqis, 0.99),
+                                 static_cast<double>(sites.size()),
+                                 static_cast<double>(distinctTemperatures.size())};
+        const size_t firstRows = std::min<size_t>(samples.size(), chunks * reader.chunkRows());
+        const double firstChunksExact =
+            exactQuantile(std::vector<double>(temperatures.begin(), temperatures.begin() + firstRows), 0.99);
+        const double exactMillis = millisSince(start);
+
+        const char* labels[6] = {"temperature p50", "temperature p99", "airQualityIndex p50",
+                                 "airQualityIndex p99", "distinct siteName", "distinct temperature"};
+        std::cout << std::left << std::setw(24) << "" << std::right << std::setw(14) << "sketch" << std::setw(14)
+                  << "exact" << std::endl;
+        for (int i = 0; i < 6; ++i) {
+            std::cout << std::left << std::setw(24) << labels[i] << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(14) << sketch[i] << std::setw(14) << exact[i] << std::endl;
+        }
+        std::cout << std::left << std::setw(24) << ("temperature p99, " + std::to_string(chunks) + " chunks")
+                  << std::right << std::setw(14) << firstChunksP99 << std::setw(14) << firstChunksExact << std::endl;
+        std::cout << std::setprecision(2) << samples.size() << " rows: sketches " << sketchMillis
+                  << " ms, full read + exact " << exactMillis << " ms" << std::endl;
+        return 0;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
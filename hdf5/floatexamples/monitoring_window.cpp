@@ -0,0 +1,122 @@
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "monitoring_common.h"
+#include "window.h"
+
+using namespace H5;
+
+namespace {
+
+const size_t ROLLING_ROWS = 100;
+const size_t TUMBLING_ROWS = 1000;
+const double HALF_LIFE_ROWS = 50;
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void writeSamples(const char* fileName, long records) {
+    H5File file(fileName, H5F_ACC_TRUNC);
+    CompType datatype = createEnvDataType();
+    hsize_t dims[1] = {static_cast<hsize_t>(records)};
+    DataSet dataset = file.createDataSet(MONITORING_DATASET, datatype, DataSpace(1, dims));
+    std::vector<EnvData> samples(records);
+    for (long i = 0; i < records; ++i) samples[i] = makeSample(i);
+    dataset.write(samples.data(), datatype);
+}
+
+template <typename Row>
+std::vector<Row> readAll(const DataSet& dataset, const CompType& type) {
+    std::vector<Row> rows(dataset.getSpace().getSimpleExtentNpoints());
+    dataset.read(rows.data(), type);
+    return rows;
+}
+
+// Recomputes every output from the full temperature column with a
+// straightforward rescan of each window.
+bool matchesRescan(const H5File& file) {
+    std::vector<EnvData> samples(file.openDataSet(MONITORING_DATASET).getSpace().getSimpleExtentNpoints());
+    file.openDataSet(MONITORING_DATASET).read(samples.data(), createEnvDataType());
+
+    auto rolling = readAll<h5util::RollingRow>(file.openDataSet("temperature_rolling"), h5util::rollingRowType());
+    bool matches = rolling.size() == samples.size();
+    for (size_t i = 0; matches && i < samples.size(); ++i) {
+        const size_t first = i + 1 >= ROLLING_ROWS ? i + 1 - ROLLING_ROWS : 0;
+        double sum = 0, low = INFINITY, high = -INFINITY;
+        for (size_t j = first; j <= i; ++j) {
+            sum += samples[j].temp;
+            low = std::min(low, samples[j].temp);
+            high = std::max(high, samples[j].temp);
+        }
+        matches = rolling[i].count == i + 1 - first && std::fabs(rolling[i].mean - sum / (i + 1 - first)) < 1e-9 &&
+                  rolling[i].min == low && rolling[i].max == high;
+    }
+
+    auto tumbling = readAll<h5util::WindowRow>(file.openDataSet("temperature_tumbling"), h5util::windowRowType());
+    matches = matches && tumbling.size() == (samples.size() + TUMBLING_ROWS - 1) / TUMBLING_ROWS;
+    for (size_t w = 0; matches && w < tumbling.size(); ++w) {
+        const size_t first = w * TUMBLING_ROWS;
+        const size_t last = std::min(samples.size(), first + TUMBLING_ROWS);
+        double sum = 0;
+        for (size_t j = first; j < last; ++j) sum += samples[j].temp;
+        matches = tumbling[w].count == last - first && std::fabs(tumbling[w].mean - sum / (last - first)) < 1e-9;
+    }
+    return matches;
+}
+
+} // namespace
+
+// Rolling statistics of the temperature column, treating the row index as
+// time: mean/min/max over the last 100 samples, means of each block of 1000
+// samples and an exponentially weighted mean with a 50-sample half-life,
+// written next to the samples as temperature_rolling, temperature_tumbling and
+// temperature_ewma. The first two are checked by rescanning every window.
+//
+// Usage: monitoring_window [FILE]            default monitoring_ingest.h5
+//        monitoring_window --write N [FILE]  first write N synthetic samples
+int main(int argc, char* argv[]) {
+    const char* fileName = "monitoring_ingest.h5";
+    try {
+        if (argc > 2 && std::string(argv[1]) == "--write") {
+            fileName = argc > 3 ? argv[3] : "monitoring_window.h5";
+            writeSamples(fileName, std::strtol(argv[2], nullptr, 10));
+        } else if (argc > 1) {
+            fileName = argv[1];
+        }
+
+        H5File file(fileName, H5F_ACC_RDWR);
+        const char* outputs[3] = {"temperature_rolling", "temperature_tumbling", "temperature_ewma"};
+        for (const char* output : outputs) {
+            H5E_BEGIN_TRY {
+                H5Ldelete(file.getId(), output, H5P_DEFAULT);
+            } H5E_END_TRY;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        h5util::SeriesReader series(file.openDataSet(MONITORING_DATASET), "temperature");
+        h5util::WindowStats stats = h5util::runWindows(series, file,
+                                                       {{h5util::Window::Sliding, ROLLING_ROWS, outputs[0]},
+                                                        {h5util::Window::Tumbling, TUMBLING_ROWS, outputs[1]},
+                                                        {h5util::Window::Ewma, HALF_LIFE_ROWS, outputs[2]}});
+        const double windowMillis = millisSince(start);
+
+        const bool matches = matchesRescan(file);
+        std::cout << std::fixed << std::setprecision(2) << stats.rows << " rows in " << stats.batches
+                  << " batches: " << windowMillis << " ms (read " << stats.readSeconds * 1000 << ", windows + write "
+                  << stats.computeSeconds * 1000 << "), rescan " << (matches ? "matches" : "DIFFERS") << std::endl;
+        return matches ? 0 : 1;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
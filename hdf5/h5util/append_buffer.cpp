@@ -0,0 +1,141 @@
+// append_buffer.cpp
+#include "append_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace h5util {
+
+H5::DataSet createAppendableDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& fileType,
+                                    const std::vector<hsize_t>& rowDims, hsize_t chunkRows,
+                                    const H5::DSetCreatPropList& baseDcpl) {
+    const int rank = static_cast<int>(rowDims.size()) + 1;
+    std::vector<hsize_t> dims(rank, 0), maxDims(rank), chunkDims(rank);
+    maxDims[0] = H5S_UNLIMITED;
+    chunkDims[0] = chunkRows;
+    for (int d = 1; d < rank; ++d) {
+        dims[d] = maxDims[d] = chunkDims[d] = rowDims[d - 1];
+    }
+    H5::DataSpace space(rank, dims.data(), maxDims.data());
+    H5::DSetCreatPropList dcpl(baseDcpl);
+    dcpl.setChunk(rank, chunkDims.data());
+    return parent.createDataSet(name, fileType, space, dcpl);
+}
+
+AppendBuffer::AppendBuffer(const H5::DataSet& dataset, const H5::DataType& memType, const FlushPolicy& policy)
+    : dataset(dataset), memType(memType), policy(policy), rank(0), rowBytes(0), chunk(0), extent(0),
+      buffered(0), closed(false) {
+    H5::DataSpace space = dataset.getSpace();
+    rank = space.getSimpleExtentNdims();
+    if (rank < 1) {
+        throw std::invalid_argument("AppendBuffer: dataset must have at least one dimension");
+    }
+    std::vector<hsize_t> dims(rank), maxDims(rank);
+    space.getSimpleExtentDims(dims.data(), maxDims.data());
+    if (maxDims[0] != H5S_UNLIMITED) {
+        throw std::invalid_argument("AppendBuffer: first dimension must be unlimited");
+    }
+    H5::DSetCreatPropList dcpl = dataset.getCreatePlist();
+    if (dcpl.getLayout() != H5D_CHUNKED) {
+        throw std::invalid_argument("AppendBuffer: dataset must be chunked");
+    }
+    std::vector<hsize_t> chunkDims(rank);
+    dcpl.getChunk(rank, chunkDims.data());
+
+    extent = dims[0];
+    chunk = chunkDims[0];
+    rowDims.assign(dims.begin() + 1, dims.end());
+    rowBytes = memType.getSize();
+    for (hsize_t d : rowDims) rowBytes *= d;
+
+    size_t reserveRows = policy.maxRecords;
+    if (policy.maxBytes > 0) reserveRows = std::max(reserveRows, policy.maxBytes / rowBytes);
+    reserveRows = ((reserveRows + chunk - 1) / chunk + 1) * chunk;
+    buffer.reserve(reserveRows * rowBytes);
+}
+
+AppendBuffer::~AppendBuffer() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void AppendBuffer::append(const void* records, size_t rows) {
+    if (closed) {
+        throw std::logic_error("AppendBuffer: append after close");
+    }
+    if (rows == 0) return;
+    if (buffered == 0) oldest = std::chrono::steady_clock::now();
+    const size_t used = buffered * rowBytes;
+    buffer.resize(used + rows * rowBytes);
+    std::memcpy(buffer.data() + used, records, rows * rowBytes);
+    buffered += rows;
+    counters.recordsAppended += rows;
+    maybeFlush();
+}
+
+void AppendBuffer::poll() {
+    if (!closed) maybeFlush();
+}
+
+void AppendBuffer::flush() {
+    if (buffered > 0) writeRows(buffered);
+}
+
+void AppendBuffer::close() {
+    if (closed) return;
+    flush();
+    closed = true;
+}
+
+void AppendBuffer::maybeFlush() {
+    if (buffered == 0) return;
+    if (policy.maxAge.count() > 0 && std::chrono::steady_clock::now() - oldest >= policy.maxAge) {
+        flush();
+        return;
+    }
+    const bool full = (policy.maxRecords > 0 && buffered >= policy.maxRecords) ||
+                      (policy.maxBytes > 0 && buffered * rowBytes >= policy.maxBytes);
+    if (!full) return;
+
+    // Write up to the last chunk boundary so that no chunk is written twice; the
+    // remainder stays buffered. A threshold below one chunk writes everything.
+    const hsize_t toBoundary = (chunk - extent % chunk) % chunk;
+    size_t rows = 0;
+    if (buffered >= toBoundary) {
+        rows = static_cast<size_t>(toBoundary + (buffered - toBoundary) / chunk * chunk);
+    }
+    writeRows(rows > 0 ? rows : buffered);
+}
+
+void AppendBuffer::writeRows(size_t rows) {
+    std::vector<hsize_t> newDims(rank), start(rank, 0), count(rank);
+    newDims[0] = extent + rows;
+    start[0] = extent;
+    count[0] = rows;
+    for (int d = 1; d < rank; ++d) {
+        newDims[d] = count[d] = rowDims[d - 1];
+    }
+
+    dataset.extend(newDims.data());
+    ++counters.extendCalls;
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), start.data());
+    H5::DataSpace memSpace(rank, count.data());
+    dataset.write(buffer.data(), memType, memSpace, fileSpace);
+    ++counters.writeCalls;
+    if (policy.flushFile) {
+        H5Fflush(dataset.getId(), H5F_SCOPE_LOCAL);
+    }
+
+    extent += rows;
+    buffered -= rows;
+    counters.recordsWritten += rows;
+    std::memmove(buffer.data(), buffer.data() + rows * rowBytes, buffered * rowBytes);
+    buffer.resize(buffered * rowBytes);
+}
+
+} // namespace h5util
@@ -0,0 +1,85 @@
+// append_buffer.h
+#ifndef APPEND_BUFFER_H
+#define APPEND_BUFFER_H
+
+#include <H5Cpp.h>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace h5util {
+
+// When an AppendBuffer pushes its records into the dataset. A limit of 0 disables
+// that trigger. Count and byte triggers only write whole chunks; the age trigger
+// (and flush()/close()) write everything that is buffered.
+struct FlushPolicy {
+    size_t maxRecords = 0;
+    size_t maxBytes = 1 << 20;
+    std::chrono::milliseconds maxAge{0};
+    bool flushFile = false; // call H5Fflush after each write for durability
+};
+
+// Counters for an AppendBuffer, useful when comparing against per-record writes.
+struct AppendStats {
+    hsize_t recordsAppended = 0;
+    hsize_t recordsWritten = 0;
+    size_t extendCalls = 0;
+    size_t writeCalls = 0;
+};
+
+// Creates a dataset that grows along dimension 0, chunked by chunkRows rows.
+// rowDims are the fixed trailing dimensions (empty for a 1-D dataset).
+H5::DataSet createAppendableDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& fileType,
+                                    const std::vector<hsize_t>& rowDims, hsize_t chunkRows,
+                                    const H5::DSetCreatPropList& baseDcpl = H5::DSetCreatPropList());
+
+// Accumulates small appends to a dataset created by createAppendableDataSet() (or
+// any chunked dataset with an unlimited first dimension) and writes them with one
+// H5Dset_extent and one hyperslab write per flush, aligned to chunk boundaries.
+class AppendBuffer {
+public:
+    AppendBuffer(const H5::DataSet& dataset, const H5::DataType& memType, const FlushPolicy& policy = FlushPolicy());
+    ~AppendBuffer();
+
+    AppendBuffer(const AppendBuffer&) = delete;
+    AppendBuffer& operator=(const AppendBuffer&) = delete;
+
+    // Append rows records, each laid out as one row of the memory type.
+    void append(const void* records, size_t rows = 1);
+
+    // Checks the age trigger without appending anything.
+    void poll();
+
+    // Write everything that is buffered.
+    void flush();
+
+    // Flush and stop accepting records. Called by the destructor.
+    void close();
+
+    hsize_t rowsInFile() const { return extent; }
+    size_t rowsBuffered() const { return buffered; }
+    hsize_t chunkRows() const { return chunk; }
+    const AppendStats& stats() const { return counters; }
+
+private:
+    void writeRows(size_t rows);
+    void maybeFlush();
+
+    H5::DataSet dataset;
+    H5::DataType memType;
+    FlushPolicy policy;
+    int rank;
+    std::vector<hsize_t> rowDims;
+    size_t rowBytes;
+    hsize_t chunk;
+    hsize_t extent;
+    std::vector<unsigned char> buffer;
+    size_t buffered;
+    std::chrono::steady_clock::time_point oldest;
+    AppendStats counters;
+    bool closed;
+};
+
+} // namespace h5util
+
+#endif // APPEND_BUFFER_H
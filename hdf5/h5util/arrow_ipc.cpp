@@ -0,0 +1,1189 @@
+// arrow_ipc.cpp
+#include "arrow_ipc.h"
+#include "decimal.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5util {
+
+namespace {
+
+// The IPC file format (Arrow columnar format, "IPC File Format"): magic, the
+// schema message, record batch messages, an end-of-stream marker, the footer
+// flatbuffer, its length and the magic again.
+const char MAGIC[] = "ARROW1";
+const size_t MAGIC_SIZE = 6;
+const uint32_t CONTINUATION = 0xFFFFFFFF;
+const size_t ALIGNMENT = 8;
+
+// Enum values and union tags of Schema.fbs, Message.fbs and File.fbs.
+const int16_t METADATA_V5 = 4;
+const uint8_t HEADER_SCHEMA = 1;
+const uint8_t HEADER_RECORD_BATCH = 3;
+const uint8_t TYPE_INT = 2;
+const uint8_t TYPE_FLOATING_POINT = 3;
+const uint8_t TYPE_UTF8 = 5;
+const uint8_t TYPE_LIST = 12;
+const int16_t PRECISION_SINGLE = 1;
+const int16_t PRECISION_DOUBLE = 2;
+
+// Sizes of the Block, FieldNode and Buffer structs.
+const size_t BLOCK_SIZE = 24;
+const size_t FIELD_NODE_SIZE = 16;
+const size_t BUFFER_SIZE = 16;
+
+const char* const LAYOUT_KEY = "hdf5.layout";
+const char* const BIT_OFFSET_KEY = "hdf5.bitOffset";
+const char* const PRECISION_KEY = "hdf5.precision";
+const char* const DECIMAL_SCALE_KEY = "hdf5.decimalScale";
+const char* const STRING_SIZE_KEY = "hdf5.stringSize";
+
+template <typename T>
+void store(std::vector<unsigned char>& out, size_t pos, T value) {
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+template <typename T>
+void append(std::vector<unsigned char>& out, T value) {
+    out.resize(out.size() + sizeof(T));
+    store(out, out.size() - sizeof(T), value);
+}
+
+size_t padded(size_t size) {
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+void pad(std::vector<unsigned char>& out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+void checkLittleEndian(const char* function) {
+    if (H5Tget_order(H5T_NATIVE_INT) != H5T_ORDER_LE) {
+        throw std::invalid_argument(std::string(function) + ": Arrow buffers are little-endian, this host is not");
+    }
+}
+
+// A flatbuffer table being built. Offsets to strings, vectors and other tables
+// may only point forward, so a table is written first and what it refers to
+// after it, each vtable just in front of its table. No vtables are shared.
+class FlatTable {
+public:
+    template <typename T>
+    FlatTable& scalar(int id, T value) {
+        Slot& slot = add(id, Ref::None, sizeof(T));
+        std::memcpy(&slot.bits, &value, sizeof(T));
+        return *this;
+    }
+
+    FlatTable& string(int id, const std::string& text) {
+        add(id, Ref::String, 4).bytes.assign(text.begin(), text.end());
+        return *this;
+    }
+
+    FlatTable& table(int id, FlatTable child) {
+        add(id, Ref::Table, 4).tables.push_back(std::move(child));
+        return *this;
+    }
+
+    FlatTable& tables(int id, std::vector<FlatTable> children) {
+        add(id, Ref::Tables, 4).tables = std::move(children);
+        return *this;
+    }
+
+    // A vector of count structs of 8-byte alignment, already encoded.
+    FlatTable& structs(int id, std::vector<unsigned char> bytes, size_t count) {
+        Slot& slot = add(id, Ref::Structs, 4);
+        slot.bytes = std::move(bytes);
+        slot.count = count;
+        return *this;
+    }
+
+    // The table as the root of a buffer, padded to 8 bytes.
+    std::vector<unsigned char> finish() const {
+        std::vector<unsigned char> out(4, 0);
+        store<uint32_t>(out, 0, static_cast<uint32_t>(write(out)));
+        pad(out, ALIGNMENT);
+        return out;
+    }
+
+private:
+    enum class Ref { None, String, Table, Tables, Structs };
+
+    struct Slot {
+        int id = 0;
+        Ref ref = Ref::None;
+        size_t size = 0; // inline bytes
+        uint64_t bits = 0;
+        std::vector<unsigned char> bytes;
+        size_t count = 0;
+        std::vector<FlatTable> tables;
+    };
+
+    Slot& add(int id, Ref ref, size_t size) {
+        slots_.emplace_back();
+        slots_.back().id = id;
+        slots_.back().ref = ref;
+        slots_.back().size = size;
+        return slots_.back();
+    }
+
+    // Appends vtable, table and referenced objects; returns the table position.
+    size_t write(std::vector<unsigned char>& out) const {
+        // Fields largest first after the vtable offset, so only the first 8-byte
+        // field may need padding. Tables start 8-aligned.
+        std::vector<size_t> order(slots_.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) { return slots_[a].size > slots_[b].size; });
+        int fields = 0;
+        for (const Slot& slot : slots_) fields = std::max(fields, slot.id + 1);
+        std::vector<uint16_t> vtable(2 + static_cast<size_t>(fields), 0);
+        std::vector<size_t> fieldOffset(slots_.size());
+        size_t inlineSize = 4;
+        for (size_t i : order) {
+            inlineSize = (inlineSize + slots_[i].size - 1) / slots_[i].size * slots_[i].size;
+            fieldOffset[i] = inlineSize;
+            vtable[2 + static_cast<size_t>(slots_[i].id)] = static_cast<uint16_t>(inlineSize);
+            inlineSize += slots_[i].size;
+        }
+        vtable[0] = static_cast<uint16_t>(vtable.size() * 2);
+        vtable[1] = static_cast<uint16_t>(inlineSize);
+
+        pad(out, 2);
+        const size_t vtablePos = out.size();
+        for (uint16_t entry : vtable) append(out, entry);
+        pad(out, ALIGNMENT);
+        const size_t tablePos = out.size();
+        out.resize(tablePos + inlineSize, 0);
+        store<int32_t>(out, tablePos, static_cast<int32_t>(tablePos - vtablePos));
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].ref == Ref::None) {
+                std::memcpy(out.data() + tablePos + fieldOffset[i], &slots_[i].bits, slots_[i].size);
+            }
+        }
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].ref == Ref::None) continue;
+            const size_t fieldPos = tablePos + fieldOffset[i];
+            store<uint32_t>(out, fieldPos, static_cast<uint32_t>(writeRef(slots_[i], out) - fieldPos));
+        }
+        return tablePos;
+    }
+
+    static size_t writeRef(const Slot& slot, std::vector<unsigned char>& out) {
+        switch (slot.ref) {
+        case Ref::Table:
+            return slot.tables[0].write(out);
+        case Ref::Tables: {
+            pad(out, 4);
+            const size_t pos = out.size();
+            append(out, static_cast<uint32_t>(slot.tables.size()));
+            out.resize(out.size() + 4 * slot.tables.size(), 0);
+            for (size_t i = 0; i < slot.tables.size(); ++i) {
+                const size_t entry = pos + 4 + 4 * i;
+                store<uint32_t>(out, entry, static_cast<uint32_t>(slot.tables[i].write(out) - entry));
+            }
+            return pos;
+        }
+        case Ref::Structs: {
+            while (out.size() % ALIGNMENT != 4) out.push_back(0); // elements 8-aligned after the length
+            const size_t pos = out.size();
+            append(out, static_cast<uint32_t>(slot.count));
+            out.insert(out.end(), slot.bytes.begin(), slot.bytes.end());
+            return pos;
+        }
+        default: { // String
+            pad(out, 4);
+            const size_t pos = out.size();
+            append(out, static_cast<uint32_t>(slot.bytes.size()));
+            out.insert(out.end(), slot.bytes.begin(), slot.bytes.end());
+            out.push_back(0);
+            return pos;
+        }
+        }
+    }
+
+    std::vector<Slot> slots_;
+};
+
+// Read access to a table of a flatbuffer. Every access is bounds-checked, so
+// a corrupt file throws instead of reading past the buffer.
+class FlatView {
+public:
+    static FlatView root(const unsigned char* data, size_t size) {
+        FlatView view(data, size, 0);
+        view.table_ = view.follow(0);
+        return view;
+    }
+
+    bool has(int id) const {
+        return field(id) != 0;
+    }
+
+    template <typename T>
+    T scalar(int id, T fallback) const {
+        const size_t pos = field(id);
+        return pos ? load<T>(at(pos, sizeof(T))) : fallback;
+    }
+
+    FlatView table(int id) const {
+        const size_t pos = field(id);
+        if (!pos) malformed();
+        return FlatView(data_, size_, follow(pos));
+    }
+
+    std::string string(int id) const {
+        const size_t pos = field(id);
+        if (!pos) return std::string();
+        const size_t start = follow(pos);
+        const uint32_t length = load<uint32_t>(at(start, 4));
+        return std::string(reinterpret_cast<const char*>(at(start + 4, length)), length);
+    }
+
+    // Element count of a vector; first receives the position of element 0.
+    size_t vector(int id, size_t& first) const {
+        const size_t pos = field(id);
+        if (!pos) {
+            first = 0;
+            return 0;
+        }
+        const size_t start = follow(pos);
+        first = start + 4;
+        return load<uint32_t>(at(start, 4));
+    }
+
+    FlatView tableAt(size_t first, size_t index) const {
+        return FlatView(data_, size_, follow(first + 4 * index));
+    }
+
+    const unsigned char* at(size_t pos, size_t bytes) const {
+        if (pos > size_ || bytes > size_ - pos) malformed();
+        return data_ + pos;
+    }
+
+private:
+    FlatView(const unsigned char* data, size_t size, size_t table) : data_(data), size_(size), table_(table) {}
+
+    [[noreturn]] static void malformed() {
+        throw std::runtime_error("importArrow: malformed Arrow metadata");
+    }
+
+    size_t follow(size_t pos) const {
+        return pos + load<uint32_t>(at(pos, 4));
+    }
+
+    // Position of field id, 0 when absent.
+    size_t field(int id) const {
+        const int64_t vtable = static_cast<int64_t>(table_) - load<int32_t>(at(table_, 4));
+        if (vtable < 0) malformed();
+        const size_t vtablePos = static_cast<size_t>(vtable);
+        const size_t slot = 4 + 2 * static_cast<size_t>(id);
+        if (slot + 2 > load<uint16_t>(at(vtablePos, 2))) return 0;
+        const uint16_t offset = load<uint16_t>(at(vtablePos + slot, 2));
+        return offset ? table_ + offset : 0;
+    }
+
+    const unsigned char* data_;
+    size_t size_;
+    size_t table_;
+};
+
+enum class Layout { Records, Matrix, Vector };
+
+const char* layoutName(Layout layout) {
+    return layout == Layout::Matrix ? "matrix" : layout == Layout::Vector ? "vector" : "records";
+}
+
+enum class Kind { Int, Float, FixedString, VarString, Sequence };
+
+// One Arrow column and where its values sit in an HDF5 record in memory.
+struct Column {
+    std::string name;
+    Kind kind = Kind::Int;
+    size_t offset = 0;       // within the record
+    size_t width = 0;        // bytes per value, per item of a Sequence, the size of a FixedString
+    bool isSigned = false;
+    bool floatItems = false; // Sequence of floating-point items
+    int bitOffset = 0;       // fixed-point integers: bit offset and precision of the value
+    int precision = 0;
+    int decimalScale = -1;
+};
+
+bool isValueWidth(size_t width) {
+    return width == 1 || width == 2 || width == 4 || width == 8;
+}
+
+void addColumns(hid_t type, size_t offset, const std::string& name, std::vector<Column>& columns) {
+    Column column;
+    column.name = name;
+    column.offset = offset;
+    column.width = H5Tget_size(type);
+    switch (H5Tget_class(type)) {
+    case H5T_COMPOUND: {
+        const unsigned members = static_cast<unsigned>(H5Tget_nmembers(type));
+        for (unsigned i = 0; i < members; ++i) {
+            hid_t member = H5Tget_member_type(type, i);
+            const std::string inner = memberName(type, i);
+            addColumns(member, offset + H5Tget_member_offset(type, i), name.empty() ? inner : name + "." + inner,
+                       columns);
+            H5Tclose(member);
+        }
+        return;
+    }
+    case H5T_ARRAY: {
+        hid_t super = H5Tget_super(type);
+        const size_t elementSize = H5Tget_size(super);
+        const size_t count = column.width / elementSize;
+        for (size_t k = 0; k < count; ++k) {
+            addColumns(super, offset + k * elementSize, name + "[" + std::to_string(k) + "]", columns);
+        }
+        H5Tclose(super);
+        return;
+    }
+    case H5T_INTEGER:
+        column.kind = Kind::Int;
+        column.isSigned = H5Tget_sign(type) == H5T_SGN_2;
+        column.bitOffset = static_cast<int>(H5Tget_offset(type));
+        column.precision = static_cast<int>(H5Tget_precision(type));
+        break;
+    case H5T_FLOAT:
+        column.kind = Kind::Float;
+        break;
+    case H5T_STRING:
+        column.kind = H5Tis_variable_str(type) > 0 ? Kind::VarString : Kind::FixedString;
+        break;
+    case H5T_VLEN: {
+        hid_t super = H5Tget_super(type);
+        const H5T_class_t itemClass = H5Tget_class(super);
+        column.kind = Kind::Sequence;
+        column.width = H5Tget_size(super);
+        column.isSigned = itemClass == H5T_INTEGER && H5Tget_sign(super) == H5T_SGN_2;
+        column.floatItems = itemClass == H5T_FLOAT;
+        const bool plain = (itemClass == H5T_INTEGER && H5Tget_offset(super) == 0) || itemClass == H5T_FLOAT;
+        H5Tclose(super);
+        if (!plain) {
+            throw std::invalid_argument("exportArrow: field " + name + " is a sequence of non-numbers");
+        }
+        break;
+    }
+    default:
+        throw std::invalid_argument("exportArrow: unsupported type for field " + name);
+    }
+    if ((column.kind == Kind::Int || column.kind == Kind::Sequence) && !isValueWidth(column.width)) {
+        throw std::invalid_argument("exportArrow: unsupported integer size for field " + name);
+    }
+    if ((column.kind == Kind::Float || column.floatItems) && column.width != 4 && column.width != 8) {
+        throw std::invalid_argument("exportArrow: unsupported float size for field " + name);
+    }
+    columns.push_back(column);
+}
+
+FlatTable keyValue(const std::string& key, const std::string& value) {
+    FlatTable pair;
+    pair.string(0, key).string(1, value);
+    return pair;
+}
+
+// Int or FloatingPoint type table; tag receives its Type union tag.
+FlatTable numericType(bool isFloat, size_t width, bool isSigned, uint8_t& tag) {
+    FlatTable type;
+    if (isFloat) {
+        tag = TYPE_FLOATING_POINT;
+        type.scalar<int16_t>(0, width == 4 ? PRECISION_SINGLE : PRECISION_DOUBLE);
+    } else {
+        tag = TYPE_INT;
+        type.scalar<int32_t>(0, static_cast<int32_t>(width * 8)).scalar<uint8_t>(1, isSigned);
+    }
+    return type;
+}
+
+FlatTable field(const std::string& name, uint8_t tag, FlatTable type, std::vector<FlatTable> children,
+                std::vector<FlatTable> metadata) {
+    FlatTable result;
+    result.string(0, name).scalar<uint8_t>(1, 0).scalar<uint8_t>(2, tag).table(3, std::move(type));
+    result.tables(5, std::move(children));
+    if (!metadata.empty()) result.tables(6, std::move(metadata));
+    return result;
+}
+
+FlatTable columnField(const Column& column) {
+    std::vector<FlatTable> children, metadata;
+    uint8_t tag = TYPE_UTF8;
+    FlatTable type;
+    switch (column.kind) {
+    case Kind::Int:
+    case Kind::Float:
+        type = numericType(column.kind == Kind::Float, column.width, column.isSigned, tag);
+        break;
+    case Kind::FixedString:
+        metadata.push_back(keyValue(STRING_SIZE_KEY, std::to_string(column.width)));
+        break;
+    case Kind::VarString:
+        break;
+    case Kind::Sequence: {
+        uint8_t itemTag = 0;
+        FlatTable itemType = numericType(column.floatItems, column.width, column.isSigned, itemTag);
+        children.push_back(field("item", itemTag, std::move(itemType), {}, {}));
+        tag = TYPE_LIST;
+        break;
+    }
+    }
+    if (column.kind == Kind::Int && (column.bitOffset > 0 || column.precision < static_cast<int>(column.width * 8))) {
+        metadata.push_back(keyValue(BIT_OFFSET_KEY, std::to_string(column.bitOffset)));
+        metadata.push_back(keyValue(PRECISION_KEY, std::to_string(column.precision)));
+    }
+    if (column.decimalScale >= 0) {
+        metadata.push_back(keyValue(DECIMAL_SCALE_KEY, std::to_string(column.decimalScale)));
+    }
+    return field(column.name, tag, std::move(type), std::move(children), std::move(metadata));
+}
+
+FlatTable schemaTable(const std::vector<Column>& columns, Layout layout) {
+    std::vector<FlatTable> fields, metadata;
+    for (const Column& column : columns) fields.push_back(columnField(column));
+    metadata.push_back(keyValue(LAYOUT_KEY, layoutName(layout)));
+    FlatTable schema;
+    schema.scalar<int16_t>(0, 0).tables(1, std::move(fields)).tables(2, std::move(metadata));
+    return schema;
+}
+
+std::vector<unsigned char> message(uint8_t headerType, FlatTable header, int64_t bodyLength) {
+    FlatTable result;
+    result.scalar<int16_t>(0, METADATA_V5).scalar<uint8_t>(1, headerType).table(2, std::move(header));
+    result.scalar<int64_t>(3, bodyLength);
+    return result.finish();
+}
+
+void writeBytes(std::ostream& out, const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+// Writes the encapsulated message: continuation marker, metadata length and
+// the metadata (8-byte padded by finish()). Returns the bytes written.
+size_t writeMessage(std::ostream& out, const std::vector<unsigned char>& metadata) {
+    std::vector<unsigned char> prefix;
+    append(prefix, CONTINUATION);
+    append(prefix, static_cast<int32_t>(metadata.size()));
+    writeBytes(out, prefix.data(), prefix.size());
+    writeBytes(out, metadata.data(), metadata.size());
+    return prefix.size() + metadata.size();
+}
+
+template <typename T>
+void gather(const unsigned char* records, size_t count, size_t stride, unsigned char* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const T value = load<T>(records + r * stride);
+        std::memcpy(out + r * sizeof(T), &value, sizeof(T));
+    }
+}
+
+// Copies width-byte values spaced stride apart into a packed array.
+void gatherValues(const unsigned char* records, size_t count, size_t stride, size_t width, unsigned char* out) {
+    switch (width) {
+    case 1: gather<uint8_t>(records, count, stride, out); break;
+    case 2: gather<uint16_t>(records, count, stride, out); break;
+    case 4: gather<uint32_t>(records, count, stride, out); break;
+    default: gather<uint64_t>(records, count, stride, out); break;
+    }
+}
+
+template <typename T>
+void scatter(const unsigned char* values, size_t count, size_t stride, unsigned char* records) {
+    for (size_t r = 0; r < count; ++r) {
+        const T value = load<T>(values + r * sizeof(T));
+        std::memcpy(records + r * stride, &value, sizeof(T));
+    }
+}
+
+// The reverse of gatherValues.
+void scatterValues(const unsigned char* values, size_t count, size_t stride, size_t width, unsigned char* records) {
+    switch (width) {
+    case 1: scatter<uint8_t>(values, count, stride, records); break;
+    case 2: scatter<uint16_t>(values, count, stride, records); break;
+    case 4: scatter<uint32_t>(values, count, stride, records); break;
+    default: scatter<uint64_t>(values, count, stride, records); break;
+    }
+}
+
+// The Arrow buffers of one column of a batch being exported.
+struct ColumnBuffers {
+    std::vector<int32_t> offsets;       // strings and sequences
+    std::vector<unsigned char> values;
+    const unsigned char* direct = nullptr; // values used in place, from the read buffer
+    size_t items = 0;                   // sequence items
+};
+
+void appendVariable(ColumnBuffers& buffers, const Column& column, const void* data, size_t bytes, size_t r) {
+    if (buffers.values.size() + bytes > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::runtime_error("exportArrow: more than 2 GiB in one batch of " + column.name +
+                                 "; lower batchRows");
+    }
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    buffers.values.insert(buffers.values.end(), p, p + bytes);
+    const size_t end = column.kind == Kind::Sequence ? buffers.values.size() / column.width : buffers.values.size();
+    buffers.offsets[r + 1] = static_cast<int32_t>(end);
+}
+
+void fillBuffers(ColumnBuffers& buffers, const Column& column, const unsigned char* records, size_t rows,
+                 size_t recordBytes, bool inPlace) {
+    const unsigned char* first = records + column.offset;
+    switch (column.kind) {
+    case Kind::Int:
+    case Kind::Float:
+        if (inPlace) {
+            buffers.direct = records;
+        } else {
+            buffers.values.resize(rows * column.width);
+            gatherValues(first, rows, recordBytes, column.width, buffers.values.data());
+        }
+        return;
+    case Kind::FixedString:
+    case Kind::VarString:
+    case Kind::Sequence:
+        break;
+    }
+    buffers.offsets.assign(rows + 1, 0);
+    buffers.values.clear();
+    for (size_t r = 0; r < rows; ++r) {
+        const unsigned char* p = first + r * recordBytes;
+        if (column.kind == Kind::FixedString) {
+            const char* text = reinterpret_cast<const char*>(p);
+            appendVariable(buffers, column, text, strnlen(text, column.width), r);
+        } else if (column.kind == Kind::VarString) {
+            const char* text = load<const char*>(p);
+            appendVariable(buffers, column, text, text ? std::strlen(text) : 0, r);
+        } else {
+            const hvl_t sequence = load<hvl_t>(p);
+            appendVariable(buffers, column, sequence.p, sequence.len * column.width, r);
+        }
+    }
+    buffers.items = buffers.values.size() / column.width;
+}
+
+struct BodyBuffer {
+    const void* data;
+    size_t length;
+};
+
+void addNode(std::vector<unsigned char>& nodes, size_t length) {
+    append(nodes, static_cast<int64_t>(length));
+    append(nodes, static_cast<int64_t>(0)); // null count
+}
+
+// Writes one record batch message and its body; returns the file Block.
+std::vector<unsigned char> writeBatch(std::ostream& out, uint64_t position, const std::vector<Column>& columns,
+                                      const std::vector<ColumnBuffers>& buffers, size_t rows) {
+    std::vector<unsigned char> nodes;
+    std::vector<BodyBuffer> body;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const Column& column = columns[c];
+        const ColumnBuffers& data = buffers[c];
+        addNode(nodes, rows);
+        body.push_back({nullptr, 0}); // validity: no nulls
+        if (column.kind == Kind::Int || column.kind == Kind::Float) {
+            body.push_back({data.direct ? data.direct : data.values.data(), rows * column.width});
+            continue;
+        }
+        body.push_back({data.offsets.data(), data.offsets.size() * sizeof(int32_t)});
+        if (column.kind == Kind::Sequence) {
+            addNode(nodes, data.items);
+            body.push_back({nullptr, 0});
+        }
+        body.push_back({data.values.data(), data.values.size()});
+    }
+    std::vector<unsigned char> layout;
+    size_t bodyLength = 0;
+    for (const BodyBuffer& buffer : body) {
+        append(layout, static_cast<int64_t>(bodyLength));
+        append(layout, static_cast<int64_t>(buffer.length));
+        bodyLength += padded(buffer.length);
+    }
+    const size_t nodeCount = nodes.size() / FIELD_NODE_SIZE;
+    FlatTable batch;
+    batch.scalar<int64_t>(0, static_cast<int64_t>(rows));
+    batch.structs(1, std::move(nodes), nodeCount).structs(2, std::move(layout), body.size());
+    const size_t metadataLength =
+        writeMessage(out, message(HEADER_RECORD_BATCH, std::move(batch), static_cast<int64_t>(bodyLength)));
+
+    const char zeros[ALIGNMENT] = {};
+    for (const BodyBuffer& buffer : body) {
+        writeBytes(out, buffer.data, buffer.length);
+        writeBytes(out, zeros, padded(buffer.length) - buffer.length);
+    }
+
+    std::vector<unsigned char> block;
+    append(block, static_cast<int64_t>(position));
+    append(block, static_cast<int32_t>(metadataLength));
+    append(block, static_cast<int32_t>(0)); // padding
+    append(block, static_cast<int64_t>(bodyLength));
+    return block;
+}
+
+std::string baseName(const H5::DataSet& dataset) {
+    const std::string path = dataset.getObjName();
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+// Import side.
+
+struct Block {
+    uint64_t offset = 0;
+    size_t metadataLength = 0;
+    size_t bodyLength = 0;
+};
+
+void readAt(std::istream& in, uint64_t position, void* data, size_t size) {
+    in.seekg(static_cast<std::streamoff>(position));
+    in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+    if (!in) {
+        throw std::runtime_error("importArrow: unexpected end of file");
+    }
+}
+
+int metadataInt(const FlatView& field, const char* key, int fallback) {
+    size_t first = 0;
+    const size_t count = field.vector(6, first);
+    for (size_t i = 0; i < count; ++i) {
+        const FlatView pair = field.tableAt(first, i);
+        if (pair.string(0) == key) return std::stoi(pair.string(1));
+    }
+    return fallback;
+}
+
+// Value width and kind of an Int or FloatingPoint type.
+bool readNumericType(const FlatView& field, size_t& width, bool& isFloat, bool& isSigned) {
+    const uint8_t tag = field.scalar<uint8_t>(2, 0);
+    if (tag == TYPE_INT) {
+        const FlatView type = field.table(3);
+        width = static_cast<size_t>(type.scalar<int32_t>(0, 0)) / 8;
+        isSigned = type.scalar<uint8_t>(1, 0) != 0;
+        isFloat = false;
+        return isValueWidth(width);
+    }
+    if (tag == TYPE_FLOATING_POINT) {
+        const int16_t precision = field.has(3) ? field.table(3).scalar<int16_t>(0, 0) : 0;
+        width = precision == PRECISION_SINGLE ? 4 : 8;
+        isFloat = true;
+        isSigned = true;
+        return precision == PRECISION_SINGLE || precision == PRECISION_DOUBLE;
+    }
+    return false;
+}
+
+Column schemaColumn(const FlatView& field) {
+    Column column;
+    column.name = field.string(0);
+    if (field.has(4)) {
+        throw std::invalid_argument("importArrow: dictionary-encoded field " + column.name + " is not supported");
+    }
+    bool isFloat = false;
+    const uint8_t tag = field.scalar<uint8_t>(2, 0);
+    if (readNumericType(field, column.width, isFloat, column.isSigned)) {
+        column.kind = isFloat ? Kind::Float : Kind::Int;
+        column.precision = static_cast<int>(column.width * 8);
+        column.bitOffset = metadataInt(field, BIT_OFFSET_KEY, 0);
+        column.precision = metadataInt(field, PRECISION_KEY, column.precision);
+        column.decimalScale = metadataInt(field, DECIMAL_SCALE_KEY, -1);
+    } else if (tag == TYPE_UTF8) {
+        column.width = static_cast<size_t>(metadataInt(field, STRING_SIZE_KEY, 0));
+        column.kind = column.width > 0 ? Kind::FixedString : Kind::VarString;
+    } else if (tag == TYPE_LIST) {
+        size_t first = 0;
+        if (field.vector(5, first) != 1 ||
+            !readNumericType(field.tableAt(first, 0), column.width, column.floatItems, column.isSigned)) {
+            throw std::invalid_argument("importArrow: list field " + column.name + " must hold numbers");
+        }
+        column.kind = Kind::Sequence;
+    } else {
+        throw std::invalid_argument("importArrow: unsupported Arrow type for field " + column.name);
+    }
+    return column;
+}
+
+hid_t valueType(bool isFloat, size_t width, bool isSigned) {
+    if (isFloat) return H5Tcopy(width == 4 ? H5T_IEEE_F32LE : H5T_IEEE_F64LE);
+    switch (width) {
+    case 1: return H5Tcopy(isSigned ? H5T_STD_I8LE : H5T_STD_U8LE);
+    case 2: return H5Tcopy(isSigned ? H5T_STD_I16LE : H5T_STD_U16LE);
+    case 4: return H5Tcopy(isSigned ? H5T_STD_I32LE : H5T_STD_U32LE);
+    default: return H5Tcopy(isSigned ? H5T_STD_I64LE : H5T_STD_U64LE);
+    }
+}
+
+// The HDF5 type of a column's values, in memory and in the file alike.
+hid_t columnType(const Column& column) {
+    switch (column.kind) {
+    case Kind::Int: {
+        hid_t type = valueType(false, column.width, column.isSigned);
+        if (column.bitOffset > 0 || column.precision < static_cast<int>(column.width * 8)) {
+            if (column.bitOffset < 0 || column.precision <= 0 ||
+                column.bitOffset + column.precision > static_cast<int>(column.width * 8)) {
+                H5Tclose(type);
+                throw std::invalid_argument("importArrow: bad bit offset or precision for field " + column.name);
+            }
+            H5Tset_precision(type, static_cast<size_t>(column.precision));
+            H5Tset_offset(type, static_cast<size_t>(column.bitOffset));
+        }
+        return type;
+    }
+    case Kind::Float:
+        return valueType(true, column.width, true);
+    case Kind::FixedString:
+    case Kind::VarString: {
+        hid_t type = H5Tcopy(H5T_C_S1);
+        H5Tset_size(type, column.kind == Kind::FixedString ? column.width : H5T_VARIABLE);
+        H5Tset_strpad(type, H5T_STR_NULLTERM);
+        H5Tset_cset(type, H5T_CSET_UTF8);
+        return type;
+    }
+    case Kind::Sequence: {
+        hid_t item = valueType(column.floatItems, column.width, column.isSigned);
+        hid_t type = H5Tvlen_create(item);
+        H5Tclose(item);
+        return type;
+    }
+    }
+    return -1;
+}
+
+// The Arrow buffers of one column of a batch being imported, inside the body.
+struct ColumnSource {
+    const unsigned char* offsets = nullptr;
+    const unsigned char* values = nullptr;
+    size_t valuesLength = 0;
+};
+
+// Start and end of element r of a string or list column, checked against the
+// values buffer.
+std::pair<size_t, size_t> range(const ColumnSource& source, const Column& column, size_t r) {
+    const int32_t begin = load<int32_t>(source.offsets + 4 * r);
+    const int32_t end = load<int32_t>(source.offsets + 4 * (r + 1));
+    const size_t unit = column.kind == Kind::Sequence ? column.width : 1;
+    if (begin < 0 || end < begin || static_cast<size_t>(end) * unit > source.valuesLength) {
+        throw std::runtime_error("importArrow: bad offsets in field " + column.name);
+    }
+    return {static_cast<size_t>(begin), static_cast<size_t>(end)};
+}
+
+void fillRecords(const Column& column, const ColumnSource& source, size_t rows, size_t recordBytes,
+                 unsigned char* records, std::vector<char>& text) {
+    unsigned char* first = records + column.offset;
+    switch (column.kind) {
+    case Kind::Int:
+    case Kind::Float:
+        scatterValues(source.values, rows, recordBytes, column.width, first);
+        return;
+    case Kind::FixedString:
+        for (size_t r = 0; r < rows; ++r) {
+            const std::pair<size_t, size_t> span = range(source, column, r);
+            unsigned char* p = first + r * recordBytes;
+            const size_t length = std::min(span.second - span.first, column.width);
+            std::memcpy(p, source.values + span.first, length);
+            std::memset(p + length, 0, column.width - length);
+        }
+        return;
+    case Kind::VarString: {
+        // HDF5 wants NUL-terminated strings: copy them, one terminator each.
+        const size_t begin = range(source, column, 0).first;
+        text.resize(range(source, column, rows - 1).second - begin + rows);
+        char* out = text.data();
+        for (size_t r = 0; r < rows; ++r) {
+            const std::pair<size_t, size_t> span = range(source, column, r);
+            const char* start = out;
+            std::memcpy(out, source.values + span.first, span.second - span.first);
+            out += span.second - span.first;
+            *out++ = '\0';
+            std::memcpy(first + r * recordBytes, &start, sizeof(start));
+        }
+        return;
+    }
+    case Kind::Sequence:
+        for (size_t r = 0; r < rows; ++r) {
+            const std::pair<size_t, size_t> span = range(source, column, r);
+            hvl_t sequence;
+            sequence.len = span.second - span.first;
+            sequence.p = const_cast<unsigned char*>(source.values + span.first * column.width);
+            std::memcpy(first + r * recordBytes, &sequence, sizeof(sequence));
+        }
+        return;
+    }
+}
+
+} // namespace
+
+ArrowStats exportArrow(const H5::DataSet& dataset, std::ostream& out, const ArrowExportOptions& options) {
+    checkLittleEndian("exportArrow");
+    H5::DataSpace space = dataset.getSpace();
+    const int rank = space.getSimpleExtentNdims();
+    std::vector<hsize_t> dims(static_cast<size_t>(std::max(rank, 0)));
+    space.getSimpleExtentDims(dims.data());
+    H5::DataType fileType = dataset.getDataType();
+    const H5T_class_t typeClass = fileType.getClass();
+    const bool compound = typeClass == H5T_COMPOUND;
+    if (compound ? rank != 1 : rank != 1 && rank != 2) {
+        throw std::invalid_argument(compound ? "exportArrow: compound datasets must be one-dimensional"
+                                             : "exportArrow: datasets must have rank 1 or 2");
+    }
+    if (!compound && typeClass != H5T_INTEGER && typeClass != H5T_FLOAT && typeClass != H5T_STRING &&
+        typeClass != H5T_VLEN) {
+        throw std::invalid_argument("exportArrow: needs a compound, numeric, string or sequence dataset");
+    }
+
+    hid_t memId = memoryType(fileType.getId());
+    const H5::DataType memType(memId);
+    H5Tclose(memId);
+    const size_t elementSize = memType.getSize();
+
+    std::vector<Column> columns;
+    const Layout layout = compound ? Layout::Records : rank == 1 ? Layout::Vector : Layout::Matrix;
+    const size_t recordElements = layout == Layout::Matrix ? static_cast<size_t>(dims[1]) : 1;
+    if (compound) {
+        addColumns(memType.getId(), 0, "", columns);
+    } else {
+        const std::vector<std::string> names =
+            layout == Layout::Matrix ? readColumnNames(dataset) : std::vector<std::string>();
+        const std::vector<int> scales = typeClass == H5T_INTEGER ? readDecimalScales(dataset) : std::vector<int>();
+        if (!scales.empty() && scales.size() != recordElements) {
+            throw std::invalid_argument("exportArrow: expected one decimal scale per column");
+        }
+        for (size_t c = 0; c < recordElements; ++c) {
+            const std::string name = layout == Layout::Vector ? baseName(dataset)
+                                     : c < names.size()       ? names[c]
+                                                              : "column" + std::to_string(c);
+            addColumns(memType.getId(), c * elementSize, name, columns);
+            if (!scales.empty()) columns.back().decimalScale = scales[c];
+        }
+    }
+    const size_t recordBytes = recordElements * elementSize;
+    // A single numeric column filling the record: the read buffer is its Arrow buffer.
+    const bool inPlace = columns.size() == 1 && columns[0].width == recordBytes &&
+                         (columns[0].kind == Kind::Int || columns[0].kind == Kind::Float);
+
+    ArrowStats stats;
+    std::vector<unsigned char> head(MAGIC, MAGIC + MAGIC_SIZE);
+    pad(head, ALIGNMENT);
+    writeBytes(out, head.data(), head.size());
+    stats.bytes = head.size();
+    stats.bytes += writeMessage(out, message(HEADER_SCHEMA, schemaTable(columns, layout), 0));
+
+    const unsigned threads = options.threads > 0 ? options.threads : defaultThreads();
+    const hsize_t batchRows = std::max<hsize_t>(1, options.batchRows);
+    const bool variable = hasVariableParts(memType.getId());
+    std::vector<unsigned char> block(static_cast<size_t>(std::min(batchRows, dims[0])) * recordBytes);
+    std::vector<ColumnBuffers> buffers(columns.size());
+    std::vector<unsigned char> blocks;
+
+    for (hsize_t start = 0; start < dims[0]; start += batchRows) {
+        auto clock = Clock::now();
+        std::vector<hsize_t> offset(dims.size(), 0), count = dims;
+        offset[0] = start;
+        count[0] = std::min(batchRows, dims[0] - start);
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+        H5::DataSpace memSpace(rank, count.data());
+        dataset.read(block.data(), memType, memSpace, fileSpace);
+        stats.readSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        const size_t rows = static_cast<size_t>(count[0]);
+        parallelFor(columns.size(), threads, [&](size_t c) {
+            fillBuffers(buffers[c], columns[c], block.data(), rows, recordBytes, inPlace);
+        });
+        stats.zeroCopyBuffers += inPlace ? 1 : 0;
+        stats.convertSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        const std::vector<unsigned char> entry = writeBatch(out, stats.bytes, columns, buffers, rows);
+        blocks.insert(blocks.end(), entry.begin(), entry.end());
+        stats.bytes += load<int32_t>(entry.data() + 8) + load<int64_t>(entry.data() + 16);
+        if (!out) {
+            throw std::runtime_error("exportArrow: write failed");
+        }
+        stats.writeSeconds += secondsSince(clock);
+        stats.rows += rows;
+        ++stats.batches;
+
+        if (variable) reclaimVariable(memType, memSpace, block.data());
+    }
+
+    auto clock = Clock::now();
+    std::vector<unsigned char> tail;
+    append(tail, CONTINUATION);
+    append(tail, static_cast<int32_t>(0)); // end of stream
+    FlatTable footer;
+    footer.scalar<int16_t>(0, METADATA_V5).table(1, schemaTable(columns, layout));
+    footer.structs(2, {}, 0).structs(3, std::move(blocks), stats.batches);
+    const std::vector<unsigned char> footerBytes = footer.finish();
+    tail.insert(tail.end(), footerBytes.begin(), footerBytes.end());
+    append(tail, static_cast<int32_t>(footerBytes.size()));
+    tail.insert(tail.end(), MAGIC, MAGIC + MAGIC_SIZE);
+    writeBytes(out, tail.data(), tail.size());
+    if (!out) {
+        throw std::runtime_error("exportArrow: write failed");
+    }
+    stats.bytes += tail.size();
+    stats.writeSeconds += secondsSince(clock);
+    return stats;
+}
+
+ArrowStats importArrow(std::istream& in, H5::Group& destParent, const std::string& name,
+                       const ArrowImportOptions& options) {
+    checkLittleEndian("importArrow");
+    ArrowStats stats;
+    auto clock = Clock::now();
+    in.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    const size_t trailer = 4 + MAGIC_SIZE;
+    if (fileSize < ALIGNMENT + trailer) {
+        throw std::invalid_argument("importArrow: not an Arrow IPC file");
+    }
+    char head[MAGIC_SIZE];
+    unsigned char tail[4 + MAGIC_SIZE];
+    readAt(in, 0, head, sizeof(head));
+    readAt(in, fileSize - trailer, tail, sizeof(tail));
+    if (std::memcmp(head, MAGIC, MAGIC_SIZE) != 0 || std::memcmp(tail + 4, MAGIC, MAGIC_SIZE) != 0) {
+        throw std::invalid_argument("importArrow: not an Arrow IPC file");
+    }
+    const int32_t footerLength = load<int32_t>(tail);
+    if (footerLength <= 0 || static_cast<uint64_t>(footerLength) > fileSize - ALIGNMENT - trailer) {
+        throw std::runtime_error("importArrow: bad footer length");
+    }
+    std::vector<unsigned char> footerBytes(static_cast<size_t>(footerLength));
+    readAt(in, fileSize - trailer - footerBytes.size(), footerBytes.data(), footerBytes.size());
+    const FlatView footer = FlatView::root(footerBytes.data(), footerBytes.size());
+
+    // Schema: columns and the layout exportArrow recorded, if any.
+    const FlatView schema = footer.table(1);
+    if (schema.scalar<int16_t>(0, 0) != 0) {
+        throw std::invalid_argument("importArrow: big-endian Arrow files are not supported");
+    }
+    std::vector<Column> columns;
+    size_t first = 0;
+    const size_t fieldCount = schema.vector(1, first);
+    for (size_t f = 0; f < fieldCount; ++f) columns.push_back(schemaColumn(schema.tableAt(first, f)));
+    if (columns.empty()) {
+        throw std::invalid_argument("importArrow: the schema has no fields");
+    }
+    std::string layoutValue;
+    const size_t pairs = schema.vector(2, first);
+    for (size_t i = 0; i < pairs; ++i) {
+        const FlatView pair = schema.tableAt(first, i);
+        if (pair.string(0) == LAYOUT_KEY) layoutValue = pair.string(1);
+    }
+    Layout layout = Layout::Records;
+    if (layoutValue == layoutName(Layout::Vector) && columns.size() == 1) layout = Layout::Vector;
+    if (layoutValue == layoutName(Layout::Matrix)) {
+        layout = Layout::Matrix;
+        const Column& lead = columns[0];
+        for (const Column& column : columns) {
+            if ((column.kind != Kind::Int && column.kind != Kind::Float) || column.kind != lead.kind ||
+                column.width != lead.width || column.isSigned != lead.isSigned ||
+                column.bitOffset != lead.bitOffset || column.precision != lead.precision) {
+                layout = Layout::Records;
+            }
+        }
+    }
+
+    // The record batches, whose metadata gives the row count up front.
+    std::vector<Block> blocks;
+    const size_t blockCount = footer.vector(3, first);
+    const unsigned char* blockBytes = footer.at(first, blockCount * BLOCK_SIZE);
+    std::vector<std::vector<unsigned char>> metadata(blockCount);
+    std::vector<size_t> batchRows(blockCount);
+    hsize_t totalRows = 0;
+    for (size_t b = 0; b < blockCount; ++b) {
+        Block entry;
+        entry.offset = load<uint64_t>(blockBytes + b * BLOCK_SIZE);
+        const int32_t metadataLength = load<int32_t>(blockBytes + b * BLOCK_SIZE + 8);
+        const int64_t bodyLength = load<int64_t>(blockBytes + b * BLOCK_SIZE + 16);
+        if (metadataLength < 8 || bodyLength < 0 || entry.offset > fileSize ||
+            static_cast<uint64_t>(metadataLength) + static_cast<uint64_t>(bodyLength) > fileSize - entry.offset) {
+            throw std::runtime_error("importArrow: bad record batch block");
+        }
+        entry.metadataLength = static_cast<size_t>(metadataLength);
+        entry.bodyLength = static_cast<size_t>(bodyLength);
+        blocks.push_back(entry);
+        metadata[b].resize(entry.metadataLength);
+        readAt(in, entry.offset, metadata[b].data(), metadata[b].size());
+    }
+    std::vector<FlatView> batches;
+    for (size_t b = 0; b < blockCount; ++b) {
+        // Continuation marker and length; files before Arrow 0.15 have only the length.
+        const std::vector<unsigned char>& bytes = metadata[b];
+        const size_t start = load<uint32_t>(bytes.data()) == CONTINUATION ? 8 : 4;
+        const int32_t length = load<int32_t>(bytes.data() + start - 4);
+        if (length <= 0 || start + static_cast<size_t>(length) > bytes.size()) {
+            throw std::runtime_error("importArrow: bad message length");
+        }
+        const FlatView message = FlatView::root(bytes.data() + start, static_cast<size_t>(length));
+        if (message.scalar<uint8_t>(1, 0) != HEADER_RECORD_BATCH) {
+            throw std::invalid_argument("importArrow: expected a record batch message");
+        }
+        batches.push_back(message.table(2));
+        if (batches.back().has(3)) {
+            throw std::invalid_argument("importArrow: compressed record batches are not supported");
+        }
+        const int64_t rows = batches.back().scalar<int64_t>(0, 0);
+        if (rows < 0) {
+            throw std::runtime_error("importArrow: bad record batch length");
+        }
+        batchRows[b] = static_cast<size_t>(rows);
+        totalRows += batchRows[b];
+    }
+    stats.readSeconds += secondsSince(clock);
+
+    // Memory record layout; the file type is the same, packed.
+    std::vector<hid_t> types;
+    for (const Column& column : columns) types.push_back(columnType(column));
+    hid_t memId = -1;
+    size_t recordBytes = 0;
+    if (layout == Layout::Records) {
+        for (size_t c = 0; c < columns.size(); ++c) {
+            const size_t size = H5Tget_size(types[c]);
+            size_t align = 1;
+            while (align < 8 && align * 2 <= size) align *= 2;
+            columns[c].offset = (recordBytes + align - 1) / align * align;
+            recordBytes = columns[c].offset + size;
+        }
+        memId = H5Tcreate(H5T_COMPOUND, std::max<size_t>(recordBytes, 1));
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (H5Tinsert(memId, columns[c].name.c_str(), columns[c].offset, types[c]) < 0) {
+                for (hid_t type : types) H5Tclose(type);
+                H5Tclose(memId);
+                throw std::invalid_argument("importArrow: cannot add field " + columns[c].name);
+            }
+        }
+    } else {
+        memId = H5Tcopy(types[0]);
+        for (size_t c = 0; c < columns.size(); ++c) columns[c].offset = c * columns[c].width;
+        recordBytes = columns.size() * H5Tget_size(memId);
+    }
+    for (hid_t type : types) H5Tclose(type);
+    hid_t fileId = H5Tcopy(memId);
+    if (layout == Layout::Records) H5Tpack(fileId);
+    const H5::DataType memType(memId), fileType(fileId);
+    H5Tclose(memId);
+    H5Tclose(fileId);
+
+    const int rank = layout == Layout::Matrix ? 2 : 1;
+    const hsize_t dims[2] = {totalRows, static_cast<hsize_t>(columns.size())};
+    DatasetOptions datasetOptions = options.dataset;
+    if (datasetOptions.chunkDims.empty() && totalRows > 0) {
+        const size_t largest = *std::max_element(batchRows.begin(), batchRows.end());
+        datasetOptions.chunkDims.push_back(std::max<hsize_t>(1, std::min<hsize_t>(totalRows, largest)));
+        if (rank == 2) datasetOptions.chunkDims.push_back(dims[1]);
+    }
+    H5::DataSet dataset = createDataSet(destParent, name, fileType, H5::DataSpace(rank, dims), datasetOptions);
+    if (layout == Layout::Matrix) {
+        std::vector<std::string> names;
+        std::vector<int> scales;
+        for (const Column& column : columns) {
+            names.push_back(column.name);
+            if (column.decimalScale >= 0) scales.push_back(column.decimalScale);
+        }
+        writeColumnNames(dataset, names);
+        if (scales.size() == columns.size()) writeDecimalScales(dataset, scales);
+    } else if (layout == Layout::Vector && columns[0].decimalScale >= 0) {
+        writeDecimalScales(dataset, std::vector<int>(1, columns[0].decimalScale));
+    }
+
+    const unsigned threads = options.threads > 0 ? options.threads : defaultThreads();
+    std::vector<unsigned char> body, records;
+    std::vector<std::vector<char>> text(columns.size());
+    std::vector<ColumnSource> sources(columns.size());
+    hsize_t start = 0;
+    for (size_t b = 0; b < blockCount; ++b) {
+        clock = Clock::now();
+        body.resize(blocks[b].bodyLength);
+        readAt(in, blocks[b].offset + blocks[b].metadataLength, body.data(), body.size());
+        stats.readSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        const size_t rows = batchRows[b];
+        const FlatView& batch = batches[b];
+        size_t nodesFirst = 0, buffersFirst = 0;
+        const size_t nodeCount = batch.vector(1, nodesFirst);
+        const size_t bufferCount = batch.vector(2, buffersFirst);
+        const unsigned char* nodes = batch.at(nodesFirst, nodeCount * FIELD_NODE_SIZE);
+        const unsigned char* buffers = batch.at(buffersFirst, bufferCount * BUFFER_SIZE);
+        size_t node = 0, buffer = 0;
+        // Each node must have no nulls; each buffer at least minimum bytes.
+        auto nextNode = [&](const Column& column) {
+            if (node == nodeCount) throw std::runtime_error("importArrow: missing field node for " + column.name);
+            const int64_t length = load<int64_t>(nodes + node * FIELD_NODE_SIZE);
+            if (load<int64_t>(nodes + node * FIELD_NODE_SIZE + 8) != 0) {
+                throw std::invalid_argument("importArrow: null values in " + column.name + " are not supported");
+            }
+            ++node;
+            return static_cast<size_t>(std::max<int64_t>(length, 0));
+        };
+        auto nextBuffer = [&](const Column& column, size_t minimum, size_t& length) -> const unsigned char* {
+            if (buffer == bufferCount) throw std::runtime_error("importArrow: missing buffer for " + column.name);
+            const uint64_t offset = load<uint64_t>(buffers + buffer * BUFFER_SIZE);
+            length = static_cast<size_t>(load<uint64_t>(buffers + buffer * BUFFER_SIZE + 8));
+            ++buffer;
+            if (offset > body.size() || length > body.size() - offset || length < minimum) {
+                throw std::runtime_error("importArrow: buffer out of range for " + column.name);
+            }
+            return body.data() + offset;
+        };
+        for (size_t c = 0; c < columns.size(); ++c) {
+            const Column& column = columns[c];
+            ColumnSource& source = sources[c];
+            size_t length = 0;
+            if (nextNode(column) != rows) {
+                throw std::runtime_error("importArrow: length mismatch in " + column.name);
+            }
+            nextBuffer(column, 0, length); // validity, unused without nulls
+            if (column.kind == Kind::Int || column.kind == Kind::Float) {
+                source.values = nextBuffer(column, rows * column.width, source.valuesLength);
+                continue;
+            }
+            source.offsets = nextBuffer(column, rows > 0 ? (rows + 1) * 4 : 0, length);
+            if (column.kind == Kind::Sequence) {
+                nextNode(column);
+                nextBuffer(column, 0, length);
+            }
+            source.values = nextBuffer(column, 0, source.valuesLength);
+        }
+
+        const void* data = nullptr;
+        if (layout == Layout::Vector && (columns[0].kind == Kind::Int || columns[0].kind == Kind::Float)) {
+            data = sources[0].values;
+            ++stats.zeroCopyBuffers;
+        } else if (rows > 0) {
+            records.resize(rows * recordBytes);
+            parallelFor(columns.size(), threads, [&](size_t c) {
+                fillRecords(columns[c], sources[c], rows, recordBytes, records.data(), text[c]);
+            });
+            data = records.data();
+        }
+        stats.convertSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        if (rows > 0) {
+            const hsize_t offset[2] = {start, 0};
+            const hsize_t count[2] = {rows, dims[1]};
+            H5::DataSpace fileSpace = dataset.getSpace();
+            fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+            H5::DataSpace memSpace(rank, count);
+            dataset.write(data, memType, memSpace, fileSpace);
+        }
+        stats.writeSeconds += secondsSince(clock);
+        start += rows;
+        stats.rows += rows;
+        ++stats.batches;
+    }
+    stats.bytes = fileSize;
+    return stats;
+}
+
+} // namespace h5util
@@ -0,0 +1,71 @@
+// arrow_ipc.h
+#ifndef ARROW_IPC_H
+#define ARROW_IPC_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "dataset_factory.h"
+
+namespace h5util {
+
+struct ArrowExportOptions {
+    static constexpr hsize_t DEFAULT_BATCH_ROWS = 64 * 1024;
+
+    hsize_t batchRows = DEFAULT_BATCH_ROWS; // rows per record batch
+    unsigned threads = 0;                   // column conversion workers, 0: hardware concurrency
+};
+
+struct ArrowImportOptions {
+    DatasetOptions dataset; // chunkDims empty: one chunk per record batch of the largest size
+    unsigned threads = 0;   // column conversion workers, 0: hardware concurrency
+};
+
+struct ArrowStats {
+    hsize_t rows = 0;
+    size_t batches = 0;
+    uint64_t bytes = 0;         // size of the Arrow file
+    size_t zeroCopyBuffers = 0; // value buffers passed between HDF5 and Arrow without a copy
+    double readSeconds = 0;
+    double convertSeconds = 0;
+    double writeSeconds = 0;
+};
+
+// Writes a dataset as an Arrow IPC file (Feather V2): the schema, one record
+// batch per batchRows rows and the footer, encoded by hand (format version V5,
+// little-endian, uncompressed, no nulls).
+//
+// - A one-dimensional compound dataset gives one Arrow column per member;
+//   nested compounds and arrays are flattened into "outer.inner" and
+//   "member[i]" columns, as in exportCsv.
+// - A numeric or string dataset of rank 1 gives one column named after the
+//   dataset. Of rank 2 it gives one column per matrix column, named by
+//   COLUMN_NAMES_ATTRIBUTE (see dataset_factory.h) when present.
+//
+// Integers map to Int, floats to FloatingPoint, fixed and variable-length
+// strings to Utf8 and variable-length sequences of numbers to List. Integers
+// are copied as raw words: the bit offset and precision of fixed-point types
+// (the weather matrix) and DECIMAL_SCALE_ATTRIBUTE (see decimal.h) are kept in
+// "hdf5.*" field metadata, so importArrow restores the exact HDF5 type. The
+// value buffer of a rank-1 numeric dataset is the HDF5 read buffer itself;
+// other columns are gathered out of the records in parallel.
+ArrowStats exportArrow(const H5::DataSet& dataset, std::ostream& out,
+                       const ArrowExportOptions& options = ArrowExportOptions());
+
+// Reads an Arrow IPC file from the seekable stream in into a new dataset name
+// under destParent, one hyperslab write per record batch. Files written by
+// exportArrow come back with their original shape and types (flattened
+// compound members keep their dotted names); other files give a
+// one-dimensional compound dataset with one member per column. Supports the
+// column types exportArrow writes; nulls, dictionaries and compressed batches
+// are rejected. Numeric vectors are written to HDF5 straight from the Arrow
+// body, and variable-length sequences point into it.
+ArrowStats importArrow(std::istream& in, H5::Group& destParent, const std::string& name,
+                       const ArrowImportOptions& options = ArrowImportOptions());
+
+} // namespace h5util
+
+#endif // ARROW_IPC_H
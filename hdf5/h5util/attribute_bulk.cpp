@@ -0,0 +1,175 @@
+// attribute_bulk.cpp
+#include "attribute_bulk.h"
+#include "dataset_factory.h"
+#include "internal.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace h5util {
+
+void AttributeSet::add(const std::string& name, const H5::DataType& memType, const void* value,
+                       const std::vector<hsize_t>& dims) {
+    add(name, memType, memType, value, dims);
+}
+
+void AttributeSet::add(const std::string& name, const H5::DataType& fileType, const H5::DataType& memType,
+                       const void* value, const std::vector<hsize_t>& dims) {
+    if (memType.detectClass(H5T_VLEN) || (memType.getClass() == H5T_STRING && memType.isVariableStr())) {
+        throw std::invalid_argument("AttributeSet: " + name + " must have a fixed-size type");
+    }
+    Entry entry;
+    entry.name = name;
+    entry.fileType = fileType;
+    entry.memType = memType;
+    hsize_t elements = 1;
+    if (dims.empty()) {
+        entry.space = H5::DataSpace(H5S_SCALAR);
+    } else {
+        entry.space = H5::DataSpace(static_cast<int>(dims.size()), dims.data());
+        for (hsize_t d : dims) elements *= d;
+    }
+    const unsigned char* bytes = static_cast<const unsigned char*>(value);
+    entry.value.assign(bytes, bytes + elements * memType.getSize());
+    entries.push_back(std::move(entry));
+}
+
+void AttributeSet::addString(const std::string& name, const std::string& value) {
+    H5::StrType type(H5::PredType::C_S1, value.empty() ? 1 : value.size());
+    add(name, type, value.data());
+}
+
+hsize_t AttributeSet::headerBytes() const {
+    hsize_t bytes = 0;
+    for (const Entry& entry : entries) {
+        bytes += attributeHeaderBytes(entry.name, entry.fileType, entry.space.getSimpleExtentNdims(),
+                                      entry.space.getSimpleExtentNpoints());
+    }
+    return bytes;
+}
+
+void AttributeSet::writeTo(H5::H5Object& object) const {
+    for (const Entry& entry : entries) {
+        hid_t attr = H5Acreate2(object.getId(), entry.name.c_str(), entry.fileType.getId(), entry.space.getId(),
+                                H5P_DEFAULT, H5P_DEFAULT);
+        if (attr < 0) {
+            throw H5::AttributeIException("AttributeSet::writeTo", "H5Acreate2 failed for " + entry.name);
+        }
+        herr_t status = H5Awrite(attr, entry.memType.getId(), entry.value.data());
+        H5Aclose(attr);
+        if (status < 0) {
+            throw H5::AttributeIException("AttributeSet::writeTo", "H5Awrite failed for " + entry.name);
+        }
+    }
+}
+
+size_t AttributeSet::writeToAll(std::vector<H5::H5Object*>& objects) const {
+    for (H5::H5Object* object : objects) {
+        writeTo(*object);
+    }
+    return objects.size() * entries.size();
+}
+
+void setDenseAttributes(H5::ObjCreatPropList& plist) {
+    plist.setAttrPhaseChange(0, 0);
+}
+
+H5::FileAccPropList denseAttributeAccessPlist() {
+    H5::FileAccPropList fapl;
+    fapl.setLibverBounds(H5F_LIBVER_V18, H5F_LIBVER_LATEST);
+    return fapl;
+}
+
+AttributeReader::AttributeReader(size_t arenaBytes) : arena(arenaBytes) {}
+
+AttributeReader::~AttributeReader() {
+    reclaim();
+}
+
+size_t AttributeReader::readAll(const H5::H5Object& object, const std::string& path) {
+    const size_t before = attributes.size();
+    currentObject = path;
+    hsize_t index = 0;
+    failure = nullptr;
+    herr_t status = H5Aiterate2(object.getId(), H5_INDEX_NAME, H5_ITER_NATIVE, &index, &AttributeReader::visit, this);
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    if (status < 0) {
+        throw H5::AttributeIException("AttributeReader::readAll", "H5Aiterate2 failed on " + path);
+    }
+    return attributes.size() - before;
+}
+
+herr_t AttributeReader::visit(hid_t location, const char* name, const H5A_info_t*, void* self) {
+    AttributeReader* reader = static_cast<AttributeReader*>(self);
+    try {
+        reader->readOne(location, name);
+        return 0;
+    } catch (...) {
+        reader->failure = std::current_exception();
+        return -1;
+    }
+}
+
+void AttributeReader::readOne(hid_t location, const char* name) {
+    hid_t attr = H5Aopen(location, name, H5P_DEFAULT);
+    if (attr < 0) {
+        throw H5::AttributeIException("AttributeReader", std::string("H5Aopen failed for ") + name);
+    }
+    hid_t fileType = H5Aget_type(attr);
+    hid_t space = H5Aget_space(attr);
+    const hssize_t elements = H5Sget_simple_extent_npoints(space);
+    H5Sclose(space);
+    size_t typeIndex = typeFor(fileType);
+    H5Tclose(fileType);
+
+    const CachedType& cached = types[typeIndex];
+    const size_t bytes = static_cast<size_t>(elements) * cached.memType.getSize();
+    used = (used + 7) & ~static_cast<size_t>(7);
+    if (used + bytes > arena.size()) {
+        arena.resize(std::max(arena.size() * 2, used + bytes));
+    }
+    herr_t status = H5Aread(attr, cached.memType.getId(), arena.data() + used);
+    H5Aclose(attr);
+    if (status < 0) {
+        throw H5::AttributeIException("AttributeReader", std::string("H5Aread failed for ") + name);
+    }
+    attributes.push_back(AttributeRecord{currentObject, name, typeIndex, static_cast<hsize_t>(elements), used, bytes});
+    used += bytes;
+}
+
+size_t AttributeReader::typeFor(hid_t fileType) {
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (H5Tequal(types[i].fileType.getId(), fileType) > 0) {
+            return i;
+        }
+    }
+    // The wrappers take their own references: close the ids they were made from.
+    hid_t fileCopy = H5Tcopy(fileType);
+    hid_t nativeType = H5Tget_native_type(fileType, H5T_DIR_ASCEND);
+    CachedType cached;
+    cached.fileType = H5::DataType(fileCopy);
+    cached.memType = H5::DataType(nativeType);
+    H5Tclose(fileCopy);
+    H5Tclose(nativeType);
+    cached.variable = hasVariableParts(fileType);
+    types.push_back(cached);
+    return types.size() - 1;
+}
+
+void AttributeReader::reclaim() {
+    for (const AttributeRecord& record : attributes) {
+        const CachedType& cached = types[record.typeIndex];
+        if (!cached.variable) continue;
+        reclaimVariable(cached.memType, H5::DataSpace(1, &record.elements), arena.data() + record.offset);
+    }
+}
+
+void AttributeReader::clear() {
+    reclaim();
+    attributes.clear();
+    used = 0;
+}
+
+} // namespace h5util
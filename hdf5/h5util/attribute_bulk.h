@@ -0,0 +1,121 @@
+// attribute_bulk.h
+#ifndef ATTRIBUTE_BULK_H
+#define ATTRIBUTE_BULK_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+// A named group of attributes written together. Types, dataspaces and values are
+// built once when added and reused for every object the set is written to.
+class AttributeSet {
+public:
+    AttributeSet() = default;
+    AttributeSet(const AttributeSet&) = delete;
+    AttributeSet& operator=(const AttributeSet&) = delete;
+
+    // value holds product(dims) elements of memType; an empty dims is scalar. The
+    // attribute is stored with fileType, or with memType when fileType is omitted.
+    void add(const std::string& name, const H5::DataType& memType, const void* value,
+             const std::vector<hsize_t>& dims = {});
+    void add(const std::string& name, const H5::DataType& fileType, const H5::DataType& memType,
+             const void* value, const std::vector<hsize_t>& dims = {});
+
+    // Fixed-length string attribute sized to the value.
+    void addString(const std::string& name, const std::string& value);
+
+    size_t size() const { return entries.size(); }
+
+    // Approximate object header bytes the set takes on one object, for
+    // DatasetOptions::headerReserve.
+    hsize_t headerBytes() const;
+
+    // Creates every attribute of the set on object.
+    void writeTo(H5::H5Object& object) const;
+
+    // Writes the set to each object; returns the number of attributes created.
+    size_t writeToAll(std::vector<H5::H5Object*>& objects) const;
+
+private:
+    struct Entry {
+        std::string name;
+        H5::DataType fileType;
+        H5::DataType memType;
+        H5::DataSpace space;
+        std::vector<unsigned char> value;
+    };
+    std::vector<Entry> entries;
+};
+
+// Stores attributes of objects created with plist densely (fractal heap and
+// name index) from the first one instead of after 8 in the object header. Only
+// takes effect in files created with libver bounds of 1.8 or later.
+void setDenseAttributes(H5::ObjCreatPropList& plist);
+
+// File access property list with the 1.8 object header format, which dense
+// attribute storage and attribute counts above 64K bytes of header require.
+H5::FileAccPropList denseAttributeAccessPlist();
+
+// One attribute returned by AttributeReader.
+struct AttributeRecord {
+    std::string object;  // path given to readAll()
+    std::string name;
+    size_t typeIndex;    // into the reader's type cache
+    hsize_t elements;
+    size_t offset;       // into the reader's value arena
+    size_t bytes;
+};
+
+// Reads every attribute of many objects in one pass per object (H5Aiterate2).
+// Values are converted to the native type and packed into one arena that grows
+// geometrically and is reused across clear() calls; file types are cached so
+// objects sharing attribute types resolve the native type once.
+// Each value starts on an 8-byte boundary. Variable-length values stay owned by
+// the reader until clear().
+class AttributeReader {
+public:
+    static constexpr size_t DEFAULT_ARENA_BYTES = 64 * 1024;
+
+    explicit AttributeReader(size_t arenaBytes = DEFAULT_ARENA_BYTES);
+    AttributeReader(const AttributeReader&) = delete;
+    AttributeReader& operator=(const AttributeReader&) = delete;
+    ~AttributeReader();
+
+    // Appends every attribute of object; returns how many were read.
+    size_t readAll(const H5::H5Object& object, const std::string& path);
+
+    const std::vector<AttributeRecord>& records() const { return attributes; }
+    const unsigned char* data(const AttributeRecord& record) const { return arena.data() + record.offset; }
+    const H5::DataType& memType(const AttributeRecord& record) const { return types[record.typeIndex].memType; }
+    size_t cachedTypes() const { return types.size(); }
+
+    // Drops the records (keeping the arena capacity and type cache).
+    void clear();
+
+private:
+    struct CachedType {
+        H5::DataType fileType;
+        H5::DataType memType;
+        bool variable;
+    };
+
+    static herr_t visit(hid_t location, const char* name, const H5A_info_t* info, void* self);
+    void readOne(hid_t location, const char* name);
+    size_t typeFor(hid_t fileType);
+    void reclaim();
+
+    std::string currentObject;
+    std::exception_ptr failure; // thrown inside the H5Aiterate2 callback
+    std::vector<CachedType> types;
+    std::vector<AttributeRecord> attributes;
+    std::vector<unsigned char> arena;
+    size_t used = 0;
+};
+
+} // namespace h5util
+
+#endif // ATTRIBUTE_BULK_H
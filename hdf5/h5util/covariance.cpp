@@ -0,0 +1,215 @@
+// covariance.cpp
+#include "covariance.h"
+#include "dataset_factory.h"
+#include "decimal.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+constexpr size_t TILE_ROWS = 64;
+
+// Column sums and upper-triangle cross products of shifted values.
+struct Accumulator {
+    hsize_t rows = 0;
+    std::vector<double> sums;
+    std::vector<double> products;
+
+    explicit Accumulator(size_t n) : sums(n, 0), products(n * n, 0) {}
+};
+
+// How block cells become doubles: raw words of a fixed-point or decimal type
+// times a per-column inverse scale, or doubles converted by HDF5.
+struct Decoder {
+    bool raw = false;
+    size_t wordSize = sizeof(double);
+    bool isSigned = false;
+    std::vector<double> inverse; // per selected column
+
+    double operator()(const unsigned char* cell, size_t column) const {
+        if (!raw) return load<double>(cell);
+        const double scale = inverse[column];
+        switch (wordSize) {
+        case 1: return (isSigned ? load<int8_t>(cell) : load<uint8_t>(cell)) * scale;
+        case 2: return (isSigned ? load<int16_t>(cell) : load<uint16_t>(cell)) * scale;
+        case 4: return (isSigned ? load<int32_t>(cell) : static_cast<double>(load<uint32_t>(cell))) * scale;
+        default:
+            return (isSigned ? static_cast<double>(load<int64_t>(cell)) : static_cast<double>(load<uint64_t>(cell))) *
+                   scale;
+        }
+    }
+};
+
+void accumulate(Accumulator& acc, const unsigned char* block, size_t rows, size_t rowBytes,
+                const std::vector<size_t>& cellOffsets, const Decoder& decode, const std::vector<double>& shift) {
+    const size_t n = cellOffsets.size();
+    std::vector<double> tile(TILE_ROWS * n);
+    for (size_t first = 0; first < rows; first += TILE_ROWS) {
+        const size_t count = std::min(TILE_ROWS, rows - first);
+        for (size_t r = 0; r < count; ++r) {
+            const unsigned char* row = block + (first + r) * rowBytes;
+            double* d = &tile[r * n];
+            for (size_t c = 0; c < n; ++c) d[c] = decode(row + cellOffsets[c], c) - shift[c];
+        }
+        for (size_t r = 0; r < count; ++r) {
+            const double* d = &tile[r * n];
+            for (size_t i = 0; i < n; ++i) {
+                const double di = d[i];
+                acc.sums[i] += di;
+                double* q = &acc.products[i * n];
+                for (size_t j = i; j < n; ++j) q[j] += di * d[j];
+            }
+        }
+    }
+    acc.rows += rows;
+}
+
+} // namespace
+
+std::vector<double> CovarianceResult::correlation() const {
+    const size_t n = size();
+    std::vector<double> result(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const double scale = std::sqrt(covariance[i * n + i] * covariance[j * n + j]);
+            result[i * n + j] = scale > 0 ? covariance[i * n + j] / scale : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return result;
+}
+
+CovarianceResult covariance(const H5::DataSet& matrix, const CovarianceOptions& options) {
+    H5::DataSpace space = matrix.getSpace();
+    if (space.getSimpleExtentNdims() != 2) {
+        throw std::invalid_argument("covariance: the dataset must be two-dimensional");
+    }
+    const H5T_class_t typeClass = matrix.getTypeClass();
+    if (typeClass != H5T_INTEGER && typeClass != H5T_FLOAT) {
+        throw std::invalid_argument("covariance: the dataset must be numeric");
+    }
+    hsize_t dims[2];
+    space.getSimpleExtentDims(dims);
+
+    CovarianceResult result;
+    std::vector<hsize_t> columns = options.columns;
+    if (columns.empty()) {
+        for (hsize_t c = 0; c < dims[1]; ++c) columns.push_back(c);
+    }
+    std::vector<std::string> allNames = readColumnNames(matrix);
+    for (hsize_t c : columns) {
+        if (c >= dims[1]) {
+            throw std::invalid_argument("covariance: column " + std::to_string(c) + " out of range");
+        }
+        result.names.push_back(c < allNames.size() ? allNames[c] : "column" + std::to_string(c));
+    }
+    const size_t n = columns.size();
+
+    // Whole rows are read (one contiguous hyperslab per block); only the
+    // selected cells are decoded.
+    H5::DataType fileType = matrix.getDataType();
+    const std::vector<int> decimalScales = typeClass == H5T_INTEGER ? readDecimalScales(matrix) : std::vector<int>();
+    if (!decimalScales.empty() && decimalScales.size() != dims[1]) {
+        throw std::invalid_argument("covariance: expected one decimal scale per column");
+    }
+    Decoder decode;
+    decode.raw = typeClass == H5T_INTEGER && (!decimalScales.empty() || H5Tget_offset(fileType.getId()) > 0);
+    if (decode.raw) {
+        decode.wordSize = fileType.getSize();
+        decode.isSigned = H5Tget_sign(fileType.getId()) == H5T_SGN_2;
+    }
+    const H5::DataType memType = decode.raw ? fileType : H5::DataType(H5::PredType::NATIVE_DOUBLE);
+    if (!decode.raw && options.divisor > 0 && options.divisor != 1) {
+        throw std::invalid_argument("covariance: a divisor needs a fixed-point or decimal integer dataset");
+    }
+    for (hsize_t c : columns) {
+        const double divisor = options.divisor > 0       ? options.divisor
+                               : !decimalScales.empty() ? powerOfTen(decimalScales[c])
+                               : decode.raw             ? std::ldexp(1.0, H5Tget_offset(fileType.getId()))
+                                                        : 1;
+        decode.inverse.push_back(1 / divisor);
+    }
+    const size_t cellBytes = decode.wordSize;
+    const size_t rowBytes = dims[1] * cellBytes;
+    std::vector<size_t> cellOffsets;
+    for (hsize_t c : columns) cellOffsets.push_back(static_cast<size_t>(c) * cellBytes);
+
+    const unsigned threads = options.threads > 0 ? options.threads : defaultThreads();
+    const hsize_t blockRows = std::max<hsize_t>(1, options.blockRows);
+    std::vector<Accumulator> partial(threads, Accumulator(n));
+    std::vector<double> shift(n, 0);
+    std::vector<unsigned char> block(static_cast<size_t>(std::min(blockRows, dims[0])) * rowBytes);
+
+    for (hsize_t start = 0; start < dims[0]; start += blockRows) {
+        auto clock = Clock::now();
+        hsize_t offset[2] = {start, 0};
+        hsize_t count[2] = {std::min(blockRows, dims[0] - start), dims[1]};
+        H5::DataSpace fileSpace = matrix.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        matrix.read(block.data(), memType, H5::DataSpace(2, count), fileSpace);
+        result.readSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        if (start == 0) {
+            for (size_t c = 0; c < n; ++c) shift[c] = decode(block.data() + cellOffsets[c], c);
+        }
+        const size_t rows = static_cast<size_t>(count[0]);
+        const size_t sliceRows = (rows + threads - 1) / threads;
+        parallelFor(threads, threads, [&](size_t s) {
+            const size_t first = s * sliceRows;
+            if (first >= rows) return;
+            accumulate(partial[s], block.data() + first * rowBytes, std::min(sliceRows, rows - first), rowBytes,
+                       cellOffsets, decode, shift);
+        });
+        result.computeSeconds += secondsSince(clock);
+    }
+
+    auto clock = Clock::now();
+    Accumulator total(n);
+    for (const Accumulator& acc : partial) {
+        total.rows += acc.rows;
+        for (size_t i = 0; i < n; ++i) total.sums[i] += acc.sums[i];
+        for (size_t i = 0; i < n * n; ++i) total.products[i] += acc.products[i];
+    }
+    result.rows = total.rows;
+    result.mean.resize(n);
+    result.covariance.assign(n * n, std::numeric_limits<double>::quiet_NaN());
+    const double rows = static_cast<double>(total.rows);
+    for (size_t i = 0; i < n && total.rows > 0; ++i) result.mean[i] = shift[i] + total.sums[i] / rows;
+    if (total.rows > 1) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i; j < n; ++j) {
+                const double value =
+                    (total.products[i * n + j] - total.sums[i] * total.sums[j] / rows) / (rows - 1);
+                result.covariance[i * n + j] = value;
+                result.covariance[j * n + i] = value;
+            }
+        }
+    }
+    result.computeSeconds += secondsSince(clock);
+    return result;
+}
+
+H5::DataSet writeSquareMatrix(H5::Group& parent, const std::string& name, const std::vector<double>& values,
+                              const std::vector<std::string>& names) {
+    const hsize_t n = names.size();
+    if (values.size() != n * n) {
+        throw std::invalid_argument("writeSquareMatrix: " + name + " does not match the column names");
+    }
+    hsize_t dims[2] = {n, n};
+    H5::DataSet dataset = parent.createDataSet(name, H5::PredType::NATIVE_DOUBLE, H5::DataSpace(2, dims));
+    dataset.write(values.data(), H5::PredType::NATIVE_DOUBLE);
+    writeColumnNames(dataset, names);
+    return dataset;
+}
+
+} // namespace h5util
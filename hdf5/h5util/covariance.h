@@ -0,0 +1,59 @@
+// covariance.h
+#ifndef COVARIANCE_H
+#define COVARIANCE_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+struct CovarianceOptions {
+    static constexpr hsize_t DEFAULT_BLOCK_ROWS = 64 * 1024;
+
+    std::vector<hsize_t> columns; // columns to correlate, in order; empty: all
+    hsize_t blockRows = DEFAULT_BLOCK_ROWS;
+    unsigned threads = 0;         // 0: hardware concurrency
+    double divisor = 0;           // 0: 2^offset for fixed-point integer types, 10^scale per
+                                  // column for decimal ones (see decimal.h), else 1
+};
+
+struct CovarianceResult {
+    hsize_t rows = 0;
+    std::vector<std::string> names;  // selected columns, from COLUMN_NAMES_ATTRIBUTE or "column<i>"
+    std::vector<double> mean;
+    std::vector<double> covariance;  // names.size() squared, row-major, sample (n - 1) normalisation
+    double readSeconds = 0;
+    double computeSeconds = 0;
+
+    size_t size() const { return names.size(); }
+
+    // Pearson correlation matrix; NaN where a column is constant.
+    std::vector<double> correlation() const;
+};
+
+// Covariance of the columns of a two-dimensional numeric dataset, streamed in
+// row blocks so the matrix is never held in memory.
+//
+// Integer datasets whose type has a bit offset, like the weather matrix (25
+// significant bits above 7 fractional ones), are read through the file type
+// as raw words and decoded on the fly by dividing by 2^offset; a plain read
+// would convert away the fraction. Integer datasets with DECIMAL_SCALE_ATTRIBUTE
+// are read the same way and divided by 10^scale of each column. Other types are
+// converted to double by HDF5.
+// Each block is split into one slice per thread. A slice decodes a tile of rows
+// into doubles, shifted by the first row so that sums of squares do not cancel,
+// then adds every row to its own column sums and upper-triangle cross products
+// with a contiguous inner loop the compiler can vectorise (GCC does at -O3).
+// The per-slice sums are added once at the end.
+CovarianceResult covariance(const H5::DataSet& matrix, const CovarianceOptions& options = CovarianceOptions());
+
+// Writes a square matrix of doubles as a new dataset with the column names as
+// COLUMN_NAMES_ATTRIBUTE (see dataset_factory.h).
+H5::DataSet writeSquareMatrix(H5::Group& parent, const std::string& name, const std::vector<double>& values,
+                              const std::vector<std::string>& names);
+
+} // namespace h5util
+
+#endif // COVARIANCE_H
@@ -0,0 +1,322 @@
+// csv_export.cpp
+#include "csv_export.h"
+#include "dataset_factory.h"
+#include "decimal.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+namespace {
+
+// Slices per thread and block, so a slow slice does not hold up the others.
+constexpr size_t SLICES_PER_THREAD = 4;
+
+enum class Kind { Signed, Unsigned, Fixed, Decimal, Float, String, VarString };
+
+struct Field {
+    std::string name;
+    size_t offset = 0; // within the line
+    Kind kind = Kind::Signed;
+    size_t size = 0;
+    bool isSigned = false;
+    int scale = 0; // fraction bits (Fixed) or digits (Decimal)
+};
+
+void addFields(hid_t type, size_t offset, const std::string& name, std::vector<Field>& fields) {
+    Field field;
+    field.name = name;
+    field.offset = offset;
+    field.size = H5Tget_size(type);
+    switch (H5Tget_class(type)) {
+    case H5T_COMPOUND: {
+        const unsigned members = static_cast<unsigned>(H5Tget_nmembers(type));
+        for (unsigned i = 0; i < members; ++i) {
+            hid_t member = H5Tget_member_type(type, i);
+            const std::string inner = memberName(type, i);
+            addFields(member, offset + H5Tget_member_offset(type, i), name.empty() ? inner : name + "." + inner,
+                      fields);
+            H5Tclose(member);
+        }
+        return;
+    }
+    case H5T_ARRAY: {
+        hid_t super = H5Tget_super(type);
+        const size_t elementSize = H5Tget_size(super);
+        const size_t count = field.size / elementSize;
+        for (size_t k = 0; k < count; ++k) {
+            addFields(super, offset + k * elementSize, name + "[" + std::to_string(k) + "]", fields);
+        }
+        H5Tclose(super);
+        return;
+    }
+    case H5T_INTEGER:
+        field.isSigned = H5Tget_sign(type) == H5T_SGN_2;
+        field.scale = static_cast<int>(H5Tget_offset(type));
+        field.kind = field.scale > 0 ? Kind::Fixed : field.isSigned ? Kind::Signed : Kind::Unsigned;
+        break;
+    case H5T_FLOAT:
+        field.kind = Kind::Float;
+        break;
+    case H5T_STRING:
+        field.kind = H5Tis_variable_str(type) > 0 ? Kind::VarString : Kind::String;
+        break;
+    default:
+        throw std::invalid_argument("exportCsv: unsupported type for field " + name);
+    }
+    fields.push_back(field);
+}
+
+int64_t loadSigned(const unsigned char* p, size_t size) {
+    switch (size) {
+    case 1: return load<int8_t>(p);
+    case 2: return load<int16_t>(p);
+    case 4: return load<int32_t>(p);
+    default: return load<int64_t>(p);
+    }
+}
+
+uint64_t loadUnsigned(const unsigned char* p, size_t size) {
+    switch (size) {
+    case 1: return load<uint8_t>(p);
+    case 2: return load<uint16_t>(p);
+    case 4: return load<uint32_t>(p);
+    default: return load<uint64_t>(p);
+    }
+}
+
+void appendText(std::string& out, const char* text, size_t length, char delimiter) {
+    bool quote = false;
+    for (size_t i = 0; i < length && !quote; ++i) {
+        quote = text[i] == delimiter || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+    }
+    if (!quote) {
+        out.append(text, length);
+        return;
+    }
+    out.push_back('"');
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] == '"') out.push_back('"');
+        out.push_back(text[i]);
+    }
+    out.push_back('"');
+}
+
+// raw / 2^bits exactly, via raw * 5^bits / 10^bits when that fits int64. An
+// exact decimal this short is also the shortest text that round-trips.
+char* formatFixed(char* buffer, int64_t raw, int bits) {
+    static const int64_t POW5[] = {1,     5,      25,      125,      625,       3125,      15625,
+                                   78125, 390625, 1953125, 9765625, 48828125, 244140625, 1220703125};
+    // Negated as unsigned: std::abs(INT64_MIN) overflows.
+    const uint64_t magnitude = raw < 0 ? 0 - static_cast<uint64_t>(raw) : static_cast<uint64_t>(raw);
+    if (bits < static_cast<int>(sizeof(POW5) / sizeof(POW5[0])) &&
+        magnitude <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max() / POW5[bits])) {
+        return formatDecimal(buffer, raw * POW5[bits], bits, true);
+    }
+    return std::to_chars(buffer, buffer + 64, std::ldexp(static_cast<double>(raw), -bits)).ptr;
+}
+
+void appendField(std::string& out, const Field& field, const unsigned char* line, char delimiter) {
+    const unsigned char* p = line + field.offset;
+    char buffer[64];
+    char* end = buffer;
+    switch (field.kind) {
+    case Kind::Signed:
+        end = std::to_chars(buffer, buffer + sizeof(buffer), loadSigned(p, field.size)).ptr;
+        break;
+    case Kind::Unsigned:
+        end = std::to_chars(buffer, buffer + sizeof(buffer), loadUnsigned(p, field.size)).ptr;
+        break;
+    case Kind::Fixed:
+        if (field.isSigned) {
+            end = formatFixed(buffer, loadSigned(p, field.size), field.scale);
+        } else {
+            const uint64_t raw = loadUnsigned(p, field.size);
+            end = raw <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())
+                      ? formatFixed(buffer, static_cast<int64_t>(raw), field.scale)
+                      : std::to_chars(buffer, buffer + sizeof(buffer),
+                                      std::ldexp(static_cast<double>(raw), -field.scale))
+                            .ptr;
+        }
+        break;
+    case Kind::Decimal:
+        end = formatDecimal(buffer, field.isSigned ? loadSigned(p, field.size)
+                                                   : static_cast<int64_t>(loadUnsigned(p, field.size)),
+                            field.scale, true);
+        break;
+    case Kind::Float:
+        if (field.size == sizeof(float)) {
+            end = std::to_chars(buffer, buffer + sizeof(buffer), load<float>(p)).ptr;
+        } else if (field.size == sizeof(double)) {
+            end = std::to_chars(buffer, buffer + sizeof(buffer), load<double>(p)).ptr;
+        } else {
+            end = std::to_chars(buffer, buffer + sizeof(buffer), load<long double>(p)).ptr;
+        }
+        break;
+    case Kind::String:
+        appendText(out, reinterpret_cast<const char*>(p), strnlen(reinterpret_cast<const char*>(p), field.size),
+                   delimiter);
+        return;
+    case Kind::VarString: {
+        const char* text = load<const char*>(p);
+        if (text) appendText(out, text, std::strlen(text), delimiter);
+        return;
+    }
+    }
+    out.append(buffer, end);
+}
+
+std::string baseName(const H5::DataSet& dataset) {
+    const std::string path = dataset.getObjName();
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+} // namespace
+
+CsvStats exportCsv(const H5::DataSet& dataset, std::ostream& out, const CsvOptions& options) {
+    H5::DataSpace space = dataset.getSpace();
+    const int rank = space.getSimpleExtentNdims();
+    if (rank < 1) {
+        throw std::invalid_argument("exportCsv: scalar datasets are not supported");
+    }
+    std::vector<hsize_t> dims(static_cast<size_t>(rank));
+    space.getSimpleExtentDims(dims.data());
+    H5::DataType fileType = dataset.getDataType();
+    const H5T_class_t typeClass = fileType.getClass();
+    const bool compound = typeClass == H5T_COMPOUND;
+    if (compound && rank != 1) {
+        throw std::invalid_argument("exportCsv: compound datasets must be one-dimensional");
+    }
+    if (!compound && typeClass != H5T_INTEGER && typeClass != H5T_FLOAT && typeClass != H5T_STRING) {
+        throw std::invalid_argument("exportCsv: needs a compound, numeric or string dataset");
+    }
+
+    hid_t memId = memoryType(fileType.getId());
+    const H5::DataType memType(memId);
+    H5Tclose(memId);
+    const size_t elementSize = memType.getSize();
+
+    // The fields of one line, at offsets from the start of the line.
+    std::vector<Field> fields;
+    const size_t lineElements = compound || rank == 1 ? 1 : static_cast<size_t>(dims.back());
+    if (compound) {
+        addFields(memType.getId(), 0, "", fields);
+    } else {
+        const std::vector<std::string> names = rank == 1 ? std::vector<std::string>() : readColumnNames(dataset);
+        const std::vector<int> scales = typeClass == H5T_INTEGER ? readDecimalScales(dataset) : std::vector<int>();
+        if (!scales.empty() && scales.size() != lineElements) {
+            throw std::invalid_argument("exportCsv: expected one decimal scale per column");
+        }
+        for (size_t c = 0; c < lineElements; ++c) {
+            const std::string name = rank == 1 ? baseName(dataset)
+                                     : c < names.size() ? names[c]
+                                                        : "column" + std::to_string(c);
+            addFields(memType.getId(), c * elementSize, name, fields);
+            if (!scales.empty()) {
+                fields.back().kind = Kind::Decimal;
+                fields.back().scale = scales[c];
+            }
+        }
+    }
+    const size_t lineBytes = lineElements * elementSize;
+    const int indexFields = rank > 2 ? rank - 1 : 0;
+    hsize_t linesPerIndex = 1;
+    for (int d = 1; d < rank - 1; ++d) linesPerIndex *= dims[static_cast<size_t>(d)];
+
+    CsvStats stats;
+    const char delimiter = options.delimiter;
+    if (options.header) {
+        std::string header;
+        for (int d = 0; d < indexFields; ++d) header += "dim" + std::to_string(d) + delimiter;
+        for (size_t f = 0; f < fields.size(); ++f) {
+            if (f > 0) header.push_back(delimiter);
+            appendText(header, fields[f].name.data(), fields[f].name.size(), delimiter);
+        }
+        header.push_back('\n');
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        stats.bytes += header.size();
+    }
+    if (linesPerIndex == 0 || lineBytes == 0) {
+        return stats; // an empty inner dimension: no values to write
+    }
+
+    const unsigned threads = options.threads > 0 ? options.threads : defaultThreads();
+    const hsize_t blockRows = std::max<hsize_t>(1, options.blockRows);
+    const bool variable = hasVariableParts(memType.getId());
+    std::vector<unsigned char> block(static_cast<size_t>(std::min(blockRows, dims[0]) * linesPerIndex) * lineBytes);
+    std::vector<std::string> slices(threads * SLICES_PER_THREAD);
+
+    for (hsize_t start = 0; start < dims[0]; start += blockRows) {
+        auto clock = Clock::now();
+        std::vector<hsize_t> offset(dims.size(), 0), count = dims;
+        offset[0] = start;
+        count[0] = std::min(blockRows, dims[0] - start);
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), offset.data());
+        H5::DataSpace memSpace(rank, count.data());
+        dataset.read(block.data(), memType, memSpace, fileSpace);
+        stats.readSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        const size_t lines = static_cast<size_t>(count[0] * linesPerIndex);
+        const size_t sliceCount = std::min(slices.size(), lines);
+        const size_t sliceLines = (lines + sliceCount - 1) / sliceCount;
+        parallelFor(sliceCount, threads, [&](size_t s) {
+            std::string& text = slices[s];
+            text.clear();
+            const size_t first = s * sliceLines;
+            const size_t last = std::min(lines, first + sliceLines);
+            for (size_t l = first; l < last; ++l) {
+                if (indexFields > 0) {
+                    // Leading indices of line l, last varying fastest.
+                    hsize_t index[H5S_MAX_RANK];
+                    hsize_t rest = start * linesPerIndex + l;
+                    for (int d = indexFields - 1; d >= 0; --d) {
+                        index[d] = d == 0 ? rest : rest % dims[static_cast<size_t>(d)];
+                        rest /= dims[static_cast<size_t>(d)];
+                    }
+                    char buffer[24];
+                    for (int d = 0; d < indexFields; ++d) {
+                        text.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), index[d]).ptr);
+                        text.push_back(delimiter);
+                    }
+                }
+                const unsigned char* line = block.data() + l * lineBytes;
+                for (size_t f = 0; f < fields.size(); ++f) {
+                    if (f > 0) text.push_back(delimiter);
+                    appendField(text, fields[f], line, delimiter);
+                }
+                text.push_back('\n');
+            }
+        });
+        stats.formatSeconds += secondsSince(clock);
+
+        clock = Clock::now();
+        for (size_t s = 0; s < sliceCount; ++s) {
+            out.write(slices[s].data(), static_cast<std::streamsize>(slices[s].size()));
+            stats.bytes += slices[s].size();
+        }
+        if (!out) {
+            throw std::runtime_error("exportCsv: write failed");
+        }
+        stats.writeSeconds += secondsSince(clock);
+        stats.lines += lines;
+
+        if (variable) {
+            reclaimVariable(memType, memSpace, block.data());
+        }
+    }
+    return stats;
+}
+
+} // namespace h5util
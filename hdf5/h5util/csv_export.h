@@ -0,0 +1,52 @@
+// csv_export.h
+#ifndef CSV_EXPORT_H
+#define CSV_EXPORT_H
+
+#include <H5Cpp.h>
+#include <cstdint>
+#include <ostream>
+
+namespace h5util {
+
+struct CsvOptions {
+    static constexpr hsize_t DEFAULT_BLOCK_ROWS = 64 * 1024;
+
+    char delimiter = ',';                   // '\t' for TSV
+    bool header = true;
+    hsize_t blockRows = DEFAULT_BLOCK_ROWS; // dimension-0 indices read and formatted at a time
+    unsigned threads = 0;                   // 0: hardware concurrency
+};
+
+struct CsvStats {
+    hsize_t lines = 0; // excluding the header
+    uint64_t bytes = 0;
+    double readSeconds = 0;
+    double formatSeconds = 0;
+    double writeSeconds = 0;
+};
+
+// Writes a dataset as CSV (or TSV with delimiter '\t').
+//
+// - A one-dimensional compound dataset gives one line per record and one field
+//   per member; nested compounds and arrays are flattened into "outer.inner"
+//   and "member[i]" fields.
+// - A numeric or string dataset of rank 1 gives one field per line. Of rank 2
+//   it gives one line per row, headed by COLUMN_NAMES_ATTRIBUTE (see
+//   dataset_factory.h) when present. Higher ranks add the leading indices as
+//   "dim0", "dim1", ... fields in front of each line of the last dimension.
+//
+// Floating-point values are written with std::to_chars, the shortest text that
+// parses back to the same value. Fixed-point integers (types with a bit offset,
+// like the weather matrix) and decimal integers (DECIMAL_SCALE_ATTRIBUTE, see
+// decimal.h) are read as raw words and written as their exact decimal value,
+// which is also the shortest round-trip text, so weatherdata re-imports an
+// exported matrix bit for bit. Strings are quoted when they contain the
+// delimiter, a quote or a line break.
+//
+// Blocks are read on the calling thread, split into slices formatted in
+// parallel into separate buffers, and written in order.
+CsvStats exportCsv(const H5::DataSet& dataset, std::ostream& out, const CsvOptions& options = CsvOptions());
+
+} // namespace h5util
+
+#endif // CSV_EXPORT_H
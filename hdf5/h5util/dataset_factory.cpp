@@ -0,0 +1,214 @@
+// dataset_factory.cpp
+#include "dataset_factory.h"
+#include "internal.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace h5util {
+
+const char* const COLUMN_NAMES_ATTRIBUTE = "columnNames";
+
+DatasetOptions DatasetOptions::sparse(const std::vector<hsize_t>& chunkDims) {
+    DatasetOptions options;
+    options.chunkDims = chunkDims;
+    options.allocation = AllocationMode::Incremental;
+    return options;
+}
+
+DatasetOptions DatasetOptions::external(const std::string& rawFile) {
+    DatasetOptions options;
+    options.externalFile = rawFile;
+    return options;
+}
+
+bool usesCompactLayout(const DatasetOptions& options, const H5::DataType& type, const H5::DataSpace& space) {
+    if (options.compactThreshold == 0 || !options.chunkDims.empty() || !options.externalFile.empty() ||
+        options.deflateLevel >= 0 || options.shuffle || options.allocation == AllocationMode::Incremental ||
+        options.allocation == AllocationMode::Late) {
+        return false;
+    }
+    H5S_class_t spaceClass = space.getSimpleExtentType();
+    if (spaceClass == H5S_NULL) return false;
+    if (spaceClass == H5S_SIMPLE) {
+        // Compact datasets cannot be extended.
+        const int rank = space.getSimpleExtentNdims();
+        std::vector<hsize_t> dims(rank), maxDims(rank);
+        space.getSimpleExtentDims(dims.data(), maxDims.data());
+        for (int d = 0; d < rank; ++d) {
+            if (maxDims[d] != dims[d]) return false;
+        }
+    }
+    if (type.detectClass(H5T_VLEN) || (type.getClass() == H5T_STRING && H5Tis_variable_str(type.getId()) > 0)) {
+        return false;
+    }
+    const hsize_t bytes = static_cast<hsize_t>(space.getSimpleExtentNpoints()) * type.getSize();
+    return bytes <= std::min(options.compactThreshold, DatasetOptions::MAX_COMPACT_SIZE);
+}
+
+H5::DSetCreatPropList makeCreatePlist(const DatasetOptions& options, const H5::DataType& type,
+                                      const H5::DataSpace& space) {
+    H5::DSetCreatPropList dcpl;
+    if (usesCompactLayout(options, type, space)) {
+        dcpl.setLayout(H5D_COMPACT);
+    }
+    if (options.noAttributes && (options.headerReserve > 0 || options.maxCompactAttributes > 0)) {
+        throw std::invalid_argument("makeCreatePlist: noAttributes contradicts an attribute header reserve");
+    }
+    if (options.maxCompactAttributes > 0) {
+        dcpl.setAttrPhaseChange(options.maxCompactAttributes, options.maxCompactAttributes);
+    }
+    if (options.noAttributes) {
+#if H5_VERSION_GE(1, 10, 5)
+        H5Pset_dset_no_attrs_hint(dcpl.getId(), true);
+#endif
+    }
+    if (!options.chunkDims.empty()) {
+        dcpl.setChunk(static_cast<int>(options.chunkDims.size()), options.chunkDims.data());
+        if (options.shuffle) {
+            dcpl.setShuffle();
+        }
+        if (options.deflateLevel >= 0) {
+            dcpl.setDeflate(options.deflateLevel);
+        }
+    } else if (options.deflateLevel >= 0 || options.shuffle) {
+        throw std::invalid_argument("makeCreatePlist: compression requires a chunked layout");
+    }
+
+    if (!options.externalFile.empty()) {
+        if (!options.chunkDims.empty()) {
+            throw std::invalid_argument("makeCreatePlist: external storage requires a contiguous layout");
+        }
+        if (type.detectClass(H5T_VLEN) || (type.getClass() == H5T_STRING && H5Tis_variable_str(type.getId()) > 0)) {
+            throw std::invalid_argument("makeCreatePlist: external storage requires a fixed-size type");
+        }
+        // One segment that may grow to the end of the raw file.
+        dcpl.setExternal(options.externalFile.c_str(), 0, H5F_UNLIMITED);
+    }
+
+    switch (options.allocation) {
+    case AllocationMode::Early:
+        dcpl.setAllocTime(H5D_ALLOC_TIME_EARLY);
+        break;
+    case AllocationMode::Incremental:
+        if (options.chunkDims.empty()) {
+            throw std::invalid_argument("makeCreatePlist: incremental allocation requires a chunked layout");
+        }
+        dcpl.setAllocTime(H5D_ALLOC_TIME_INCR);
+        break;
+    case AllocationMode::Late:
+        dcpl.setAllocTime(H5D_ALLOC_TIME_LATE);
+        break;
+    case AllocationMode::Default:
+        break;
+    }
+
+    if (!options.writeFill) {
+        dcpl.setFillTime(H5D_FILL_TIME_NEVER);
+    }
+    if (options.hasFillValue) {
+        if (options.fillValue.size() != type.getSize()) {
+            throw std::invalid_argument("makeCreatePlist: fill value size does not match the dataset type");
+        }
+        dcpl.setFillValue(type, options.fillValue.data());
+    }
+    return dcpl;
+}
+
+H5::DataSet createDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& type,
+                          const H5::DataSpace& space, const DatasetOptions& options) {
+    H5::DSetCreatPropList dcpl = makeCreatePlist(options, type, space);
+    if (options.headerReserve == 0) {
+        return parent.createDataSet(name, type, space, dcpl);
+    }
+    // Create the dataset unlinked and reserve first: inserting the link can
+    // allocate group metadata right behind the new header and stop it from
+    // growing in place.
+    hid_t id = H5Dcreate_anon(parent.getId(), type.getId(), space.getId(), dcpl.getId(), H5P_DEFAULT);
+    if (id < 0) {
+        throw H5::DataSetIException("createDataSet", "H5Dcreate_anon failed for " + name);
+    }
+    H5::DataSet dataset(id); // holds its own reference
+    H5Dclose(id);
+    reserveHeaderSpace(dataset, options.headerReserve);
+    if (H5Olink(dataset.getId(), parent.getId(), name.c_str(), H5P_DEFAULT, H5P_DEFAULT) < 0) {
+        throw H5::DataSetIException("createDataSet", "H5Olink failed for " + name);
+    }
+    return dataset;
+}
+
+H5::Group createGroup(H5::Group& parent, const H5std_string& name, unsigned estimatedLinks,
+                      unsigned estimatedNameLength) {
+    hid_t gcpl = H5Pcreate(H5P_GROUP_CREATE);
+    if (gcpl < 0 || H5Pset_est_link_info(gcpl, estimatedLinks, estimatedNameLength) < 0) {
+        if (gcpl >= 0) H5Pclose(gcpl);
+        throw H5::PropListIException("createGroup", "H5Pset_est_link_info failed");
+    }
+    hid_t group = H5Gcreate2(parent.getId(), name.c_str(), H5P_DEFAULT, gcpl, H5P_DEFAULT);
+    H5Pclose(gcpl);
+    if (group < 0) {
+        throw H5::GroupIException("createGroup", "H5Gcreate2 failed for " + name);
+    }
+    H5::Group result(group); // holds its own reference
+    H5Gclose(group);
+    return result;
+}
+
+namespace {
+
+constexpr hsize_t MESSAGE_HEADER_BYTES = 8;
+constexpr hsize_t VARIABLE_ELEMENT_BYTES = 16; // global heap id stored per vlen element
+constexpr hsize_t MAX_RESERVE_BYTES = 60000;   // attribute messages must stay below 64 KiB
+
+hsize_t align8(hsize_t bytes) {
+    return (bytes + 7) & ~static_cast<hsize_t>(7);
+}
+
+} // namespace
+
+hsize_t attributeHeaderBytes(const std::string& name, const H5::DataType& type, int rank, hsize_t elements) {
+    size_t typeBytes = 0;
+    if (H5Tencode(type.getId(), nullptr, &typeBytes) < 0) {
+        throw H5::DataTypeIException("attributeHeaderBytes", "H5Tencode failed");
+    }
+    const bool variable =
+        type.detectClass(H5T_VLEN) || (type.getClass() == H5T_STRING && H5Tis_variable_str(type.getId()) > 0);
+    const hsize_t elementBytes = variable ? VARIABLE_ELEMENT_BYTES : type.getSize();
+    // Messages are padded to 8 bytes, and carving one out of reserved space
+    // leaves a null message with its own header behind.
+    return 2 * MESSAGE_HEADER_BYTES + 8 + align8(name.size() + 1) + align8(typeBytes) + align8(8 + 8 * rank) +
+           align8(elements * elementBytes);
+}
+
+void reserveHeaderSpace(H5::H5Object& object, hsize_t bytes) {
+    static const char* PLACEHOLDER = ".h5util_header_reserve";
+    // The placeholder's own name, type and dataspace count towards the space left behind.
+    const hsize_t overhead = attributeHeaderBytes(PLACEHOLDER, H5::PredType::NATIVE_UCHAR, 1, 0);
+    hsize_t payload[1] = {std::min(bytes, MAX_RESERVE_BYTES)};
+    payload[0] = payload[0] > overhead ? payload[0] - overhead : 1;
+    H5::DataSpace space(1, payload);
+    object.createAttribute(PLACEHOLDER, H5::PredType::NATIVE_UCHAR, space).close();
+    object.removeAttr(PLACEHOLDER);
+}
+
+std::vector<std::string> readColumnNames(const H5::DataSet& dataset) {
+    std::vector<std::string> names;
+    if (!dataset.attrExists(COLUMN_NAMES_ATTRIBUTE)) return names;
+    H5::Attribute attribute = dataset.openAttribute(COLUMN_NAMES_ATTRIBUTE);
+    H5::StrType type(H5::PredType::C_S1, H5T_VARIABLE);
+    std::vector<char*> values(attribute.getSpace().getSimpleExtentNpoints());
+    attribute.read(type, values.data());
+    for (char* value : values) names.push_back(value ? value : "");
+    reclaimVariable(type, attribute.getSpace(), values.data());
+    return names;
+}
+
+void writeColumnNames(H5::DataSet& dataset, const std::vector<std::string>& names) {
+    std::vector<const char*> values;
+    for (const std::string& name : names) values.push_back(name.c_str());
+    hsize_t dims[1] = {values.size()};
+    H5::StrType type(H5::PredType::C_S1, H5T_VARIABLE);
+    dataset.createAttribute(COLUMN_NAMES_ATTRIBUTE, type, H5::DataSpace(1, dims)).write(type, values.data());
+}
+
+} // namespace h5util
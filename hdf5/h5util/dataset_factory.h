@@ -0,0 +1,98 @@
+// dataset_factory.h
+#ifndef DATASET_FACTORY_H
+#define DATASET_FACTORY_H
+
+#include <H5Cpp.h>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+// When HDF5 allocates raw-data storage. Default keeps the library's choice for
+// the layout (late for contiguous, incremental for chunked).
+enum class AllocationMode {
+    Default,
+    Early,       // at creation / on extend
+    Incremental, // per chunk, when the chunk is first written
+    Late         // on the first write
+};
+
+// Storage choices shared by the example writers. A default-constructed value
+// reproduces a plain file.createDataSet() call, except that fixed-size datasets
+// whose raw data fits in compactThreshold bytes get compact layout: the data is
+// stored inside the object header, saving a separate raw-data block and a seek.
+struct DatasetOptions {
+    static constexpr hsize_t DEFAULT_COMPACT_THRESHOLD = 1024;
+    static constexpr hsize_t MAX_COMPACT_SIZE = 64000; // layout message limit, less headroom
+
+    std::vector<hsize_t> chunkDims; // empty: contiguous layout
+    hsize_t compactThreshold = DEFAULT_COMPACT_THRESHOLD; // 0 disables compact selection
+    bool noAttributes = false;      // hint that no attributes follow: minimal object header
+    AllocationMode allocation = AllocationMode::Default;
+    bool writeFill = true;          // false: H5D_FILL_TIME_NEVER
+    bool hasFillValue = false;      // store fillValue (in the dataset's type) as the fill value
+    std::vector<unsigned char> fillValue;
+    int deflateLevel = -1;          // 0..9 enables gzip (chunked only)
+    bool shuffle = false;           // byte shuffle ahead of gzip (chunked only)
+    std::string externalFile;       // raw data in this flat file (contiguous only)
+    hsize_t headerReserve = 0;      // object header bytes to keep free for attributes added later
+    unsigned maxCompactAttributes = 0; // >0: keep up to this many attributes in the header
+
+    // Chunked with incremental allocation: nothing is allocated or written for
+    // chunks the program never touches, and reads of them return the fill value.
+    // Writing whole chunks avoids the fill pass HDF5 makes over a partly written one.
+    static DatasetOptions sparse(const std::vector<hsize_t>& chunkDims);
+
+    // Contiguous raw data stored in rawFile (H5Pset_external) instead of the HDF5
+    // container, written in the dataset's file type with no header, so other
+    // processes can map the bytes directly (see ExternalView). The name is
+    // resolved relative to the working directory of the process opening the file.
+    static DatasetOptions external(const std::string& rawFile);
+};
+
+// Builds the dataset creation property list for the options and a dataset of
+// the given type and shape.
+H5::DSetCreatPropList makeCreatePlist(const DatasetOptions& options, const H5::DataType& type,
+                                      const H5::DataSpace& space);
+
+// True if the options select compact layout for this type and shape.
+bool usesCompactLayout(const DatasetOptions& options, const H5::DataType& type, const H5::DataSpace& space);
+
+// file.createDataSet() with the options applied.
+H5::DataSet createDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& type,
+                          const H5::DataSpace& space, const DatasetOptions& options = DatasetOptions());
+
+// Group with its header sized for estimatedLinks links of about estimatedNameLength
+// characters (H5Pset_est_link_info). Only files using the 1.8 group format store
+// links in the header; older-format groups ignore the estimate.
+H5::Group createGroup(H5::Group& parent, const H5std_string& name, unsigned estimatedLinks,
+                      unsigned estimatedNameLength);
+
+// Approximate object header bytes taken by an attribute of the given name, type
+// and rank: message header, name, encoded type and dataspace, and the value,
+// plus the header of the null message left when it is carved out of reserved
+// space.
+hsize_t attributeHeaderBytes(const std::string& name, const H5::DataType& type, int rank = 0,
+                             hsize_t elements = 1);
+
+// Grows the object header of a freshly created object by about bytes of free
+// space, so attributes added later fit without a continuation block. HDF5 has
+// no direct size hint for dataset headers: this adds and deletes a placeholder
+// attribute, leaving a null message that later attribute messages are carved
+// from. Works best right after creation, while the header can still be extended
+// in place.
+void reserveHeaderSpace(H5::H5Object& object, hsize_t bytes);
+
+// Attribute listing the column names of a matrix, one variable-length string per
+// column; weatherdata writes it from the CSV header.
+extern const char* const COLUMN_NAMES_ATTRIBUTE;
+
+// Reads COLUMN_NAMES_ATTRIBUTE; empty when the dataset has none.
+std::vector<std::string> readColumnNames(const H5::DataSet& dataset);
+
+// Writes names as COLUMN_NAMES_ATTRIBUTE.
+void writeColumnNames(H5::DataSet& dataset, const std::vector<std::string>& names);
+
+} // namespace h5util
+
+#endif // DATASET_FACTORY_H
@@ -0,0 +1,214 @@
+// decimal.cpp
+#include "decimal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace h5util {
+
+const char* const DECIMAL_SCALE_ATTRIBUTE = "decimalScale";
+
+namespace {
+
+const uint64_t POW10[] = {1ULL,
+                          10ULL,
+                          100ULL,
+                          1000ULL,
+                          10000ULL,
+                          100000ULL,
+                          1000000ULL,
+                          10000000ULL,
+                          100000000ULL,
+                          1000000000ULL,
+                          10000000000ULL,
+                          100000000000ULL,
+                          1000000000000ULL,
+                          10000000000000ULL,
+                          100000000000000ULL,
+                          1000000000000000ULL,
+                          10000000000000000ULL,
+                          100000000000000000ULL,
+                          1000000000000000000ULL};
+
+const char DIGIT_PAIRS[] = "00010203040506070809"
+                           "10111213141516171819"
+                           "20212223242526272829"
+                           "30313233343536373839"
+                           "40414243444546474849"
+                           "50515253545556575859"
+                           "60616263646566676869"
+                           "70717273747576777879"
+                           "80818283848586878889"
+                           "90919293949596979899";
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Eight ASCII digits loaded little-endian, first digit in the low byte: every
+// byte must be 0x30..0x39, which adding 6 keeps below 0x40.
+bool isEightDigits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+// Combines adjacent digits into pairs, then pairs into fours, then the two
+// fours, each step one multiply over all lanes.
+uint64_t parseEightDigits(uint64_t v) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    v -= 0x3030303030303030ULL;
+    v = v * 10 + (v >> 8);
+    return (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+}
+#endif
+
+// Appends the digits at p to mantissa; count receives how many there were.
+const char* parseDigits(const char* p, const char* last, uint64_t& mantissa, int& count) {
+    count = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (last - p >= 8 && count <= MAX_DECIMAL_SCALE) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (!isEightDigits(word)) break;
+        mantissa = mantissa * 100000000ULL + parseEightDigits(word);
+        count += 8;
+        p += 8;
+    }
+#endif
+    for (; p != last && isDigit(*p) && count <= MAX_DECIMAL_SCALE; ++p, ++count) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    return p;
+}
+
+void checkScale(const char* function, int scale) {
+    if (scale < 0 || scale > MAX_DECIMAL_SCALE) {
+        throw std::invalid_argument(std::string(function) + ": scale " + std::to_string(scale) + " out of range");
+    }
+}
+
+} // namespace
+
+bool parseDecimal(const char* first, const char* last, Decimal& result) {
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    if (p != last && (*p == '-' || *p == '+')) ++p;
+    uint64_t mantissa = 0;
+    int integerDigits = 0, fractionDigits = 0;
+    p = parseDigits(p, last, mantissa, integerDigits);
+    if (p != last && *p == '.') {
+        p = parseDigits(p + 1, last, mantissa, fractionDigits);
+    }
+    if (p != last || integerDigits + fractionDigits == 0 || integerDigits + fractionDigits > MAX_DECIMAL_SCALE) {
+        return false;
+    }
+    result.mantissa = negative ? -static_cast<int64_t>(mantissa) : static_cast<int64_t>(mantissa);
+    result.scale = fractionDigits;
+    return true;
+}
+
+bool rescaleDecimal(const Decimal& value, int scale, int64_t& mantissa) {
+    checkScale("rescaleDecimal", scale);
+    checkScale("rescaleDecimal", value.scale);
+    if (scale < value.scale) {
+        const int64_t divisor = static_cast<int64_t>(POW10[value.scale - scale]);
+        if (value.mantissa % divisor != 0) return false;
+        mantissa = value.mantissa / divisor;
+        return true;
+    }
+    const int64_t factor = static_cast<int64_t>(POW10[scale - value.scale]);
+    if (value.mantissa > std::numeric_limits<int64_t>::max() / factor ||
+        value.mantissa < std::numeric_limits<int64_t>::min() / factor) {
+        return false;
+    }
+    mantissa = value.mantissa * factor;
+    return true;
+}
+
+char* formatDecimal(char* out, int64_t mantissa, int scale, bool trim) {
+    checkScale("formatDecimal", scale);
+    uint64_t magnitude = mantissa < 0 ? 0 - static_cast<uint64_t>(mantissa) : static_cast<uint64_t>(mantissa);
+    if (mantissa < 0) *out++ = '-';
+
+    char digits[20];
+    char* const end = digits + sizeof(digits);
+    char* p = end;
+    while (magnitude >= 100) {
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + 2 * (magnitude % 100), 2);
+        magnitude /= 100;
+    }
+    if (magnitude >= 10) {
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + 2 * magnitude, 2);
+    } else {
+        *--p = static_cast<char>('0' + magnitude);
+    }
+
+    const int count = static_cast<int>(end - p);
+    if (count > scale) {
+        std::memcpy(out, p, count - scale);
+        out += count - scale;
+    } else {
+        *out++ = '0';
+    }
+    if (scale > 0) {
+        *out++ = '.';
+        for (int i = count; i < scale; ++i) *out++ = '0';
+        const int fraction = std::min(count, scale);
+        std::memcpy(out, end - fraction, fraction);
+        out += fraction;
+        if (trim) {
+            while (out[-1] == '0') --out;
+            if (out[-1] == '.') --out;
+        }
+    }
+    return out;
+}
+
+double powerOfTen(int scale) {
+    static const double values[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (scale < 0 || scale > 22) {
+        throw std::invalid_argument("powerOfTen: " + std::to_string(scale) + " out of range");
+    }
+    return values[scale];
+}
+
+void decodeDecimalRows(const int32_t* matrix, size_t rows, size_t columns, const std::vector<int>& scales,
+                       double* out) {
+    if (scales.size() != columns) {
+        throw std::invalid_argument("decodeDecimalRows: expected one scale per column");
+    }
+    std::vector<double> divisors(columns);
+    for (size_t c = 0; c < columns; ++c) divisors[c] = powerOfTen(scales[c]);
+    const double* divisor = divisors.data();
+    for (size_t r = 0; r < rows; ++r) {
+        const int32_t* row = matrix + r * columns;
+        double* decoded = out + r * columns;
+        for (size_t c = 0; c < columns; ++c) decoded[c] = row[c] / divisor[c];
+    }
+}
+
+std::vector<int> readDecimalScales(const H5::DataSet& dataset) {
+    std::vector<int> scales;
+    if (!dataset.attrExists(DECIMAL_SCALE_ATTRIBUTE)) return scales;
+    H5::Attribute attribute = dataset.openAttribute(DECIMAL_SCALE_ATTRIBUTE);
+    scales.resize(attribute.getSpace().getSimpleExtentNpoints());
+    attribute.read(H5::PredType::NATIVE_INT, scales.data());
+    return scales;
+}
+
+void writeDecimalScales(H5::DataSet& dataset, const std::vector<int>& scales) {
+    hsize_t dims[1] = {scales.size()};
+    dataset.createAttribute(DECIMAL_SCALE_ATTRIBUTE, H5::PredType::STD_I32LE, H5::DataSpace(1, dims))
+        .write(H5::PredType::NATIVE_INT, scales.data());
+}
+
+} // namespace h5util
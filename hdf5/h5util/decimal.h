@@ -0,0 +1,60 @@
+// decimal.h
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace h5util {
+
+// Exact base-10 scaled integers: value = mantissa / 10^scale, so text such as
+// 29.8 or 0.05 is stored without the rounding a binary scale introduces. A
+// matrix stored this way is a plain integer dataset with one scale per column
+// in DECIMAL_SCALE_ATTRIBUTE.
+
+// Int array attribute with one power-of-ten scale per column.
+extern const char* const DECIMAL_SCALE_ATTRIBUTE;
+
+constexpr int MAX_DECIMAL_SCALE = 18;
+
+struct Decimal {
+    int64_t mantissa = 0;
+    int scale = 0; // digits after the decimal point
+};
+
+// Parses [+-]digits[.digits] from [first, last), the whole range and nothing
+// else: no exponent, no spaces. Returns false on malformed text or more than 18
+// significant digits. Runs of eight digits are converted with one 64-bit
+// multiply-and-shift sequence instead of eight multiply-adds.
+bool parseDecimal(const char* first, const char* last, Decimal& result);
+
+// Mantissa of value at the given scale; false if that would drop non-zero
+// digits or overflow int64.
+bool rescaleDecimal(const Decimal& value, int scale, int64_t& mantissa);
+
+// Writes mantissa / 10^scale with exactly scale fraction digits, or with
+// trailing fraction zeros (and a bare point) removed if trim is set, and
+// returns the end of the text. Needs at most 22 bytes. Digits are emitted two
+// at a time from a table.
+char* formatDecimal(char* out, int64_t mantissa, int scale, bool trim = false);
+
+// 10^scale as a double, exact for scale <= 22.
+double powerOfTen(int scale);
+
+// out[r * columns + c] = matrix[r * columns + c] / 10^scales[c] for a
+// row-major int32 matrix. The division is correctly rounded, so the result is
+// the double nearest the decimal, exactly what parsing its text gives.
+void decodeDecimalRows(const int32_t* matrix, size_t rows, size_t columns, const std::vector<int>& scales,
+                       double* out);
+
+// Reads DECIMAL_SCALE_ATTRIBUTE; empty when the dataset has none.
+std::vector<int> readDecimalScales(const H5::DataSet& dataset);
+
+// Writes scales as DECIMAL_SCALE_ATTRIBUTE.
+void writeDecimalScales(H5::DataSet& dataset, const std::vector<int>& scales);
+
+} // namespace h5util
+
+#endif // DECIMAL_H
@@ -0,0 +1,93 @@
+// dimension_scales.cpp
+#include "dimension_scales.h"
+#include "dataset_factory.h"
+
+#include <H5DSpublic.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+// H5DSiterate_scales closes dsid after the callback returns; the extra
+// reference keeps the scale open for the caller, who must close it.
+herr_t firstScale(hid_t /*did*/, unsigned /*dim*/, hid_t dsid, void* visitorData) {
+    *static_cast<hid_t*>(visitorData) = H5Iinc_ref(dsid) >= 0 ? dsid : H5I_INVALID_HID;
+    return 1; // stop after the first scale
+}
+
+} // namespace
+
+H5::DataSet attachScale(H5::Group& parent, H5::DataSet& data, unsigned dim, const std::string& name,
+                        const std::vector<int64_t>& labels) {
+    if (!std::is_sorted(labels.begin(), labels.end())) {
+        throw std::invalid_argument("attachScale: labels for " + name + " must be sorted");
+    }
+    H5::DataSpace space = data.getSpace();
+    const int rank = space.getSimpleExtentNdims();
+    if (static_cast<int>(dim) >= rank) {
+        throw std::out_of_range("attachScale: dimension out of range");
+    }
+    std::vector<hsize_t> dims(rank);
+    space.getSimpleExtentDims(dims.data());
+    if (dims[dim] != labels.size()) {
+        throw std::invalid_argument("attachScale: " + name + " has " + std::to_string(labels.size()) +
+                                    " labels for a dimension of " + std::to_string(dims[dim]));
+    }
+
+    hsize_t scaleDims[1] = {labels.size()};
+    H5::DataSpace scaleSpace(1, scaleDims);
+    // Room for the CLASS, NAME and REFERENCE_LIST attributes H5DS adds.
+    H5::CompType reference(sizeof(hobj_ref_t) + sizeof(int));
+    reference.insertMember("dataset", 0, H5::PredType::STD_REF_OBJ);
+    reference.insertMember("dimension", sizeof(hobj_ref_t), H5::PredType::NATIVE_INT);
+    DatasetOptions options;
+    options.headerReserve = attributeHeaderBytes("CLASS", H5::StrType(H5::PredType::C_S1, 16)) +
+                            attributeHeaderBytes("NAME", H5::StrType(H5::PredType::C_S1, name.size() + 1)) +
+                            attributeHeaderBytes("REFERENCE_LIST", reference, 1);
+    H5::DataSet scale = createDataSet(parent, name, H5::PredType::NATIVE_INT64, scaleSpace, options);
+    scale.write(labels.data(), H5::PredType::NATIVE_INT64);
+    if (H5DSset_scale(scale.getId(), name.c_str()) < 0 || H5DSattach_scale(data.getId(), scale.getId(), dim) < 0) {
+        throw std::runtime_error("attachScale: could not attach " + name);
+    }
+    return scale;
+}
+
+hsize_t scaleAttachmentHeaderBytes(int rank) {
+    H5::VarLenType list(H5::PredType::STD_REF_OBJ);
+    return attributeHeaderBytes("DIMENSION_LIST", list, 1, rank);
+}
+
+ScaleIndex::ScaleIndex(const H5::DataSet& data, unsigned dim) {
+    hid_t scaleId = H5I_INVALID_HID;
+    if (H5DSget_num_scales(data.getId(), dim) <= 0 ||
+        H5DSiterate_scales(data.getId(), dim, nullptr, firstScale, &scaleId) < 0 || scaleId < 0) {
+        throw std::runtime_error("ScaleIndex: no dimension scale attached to dimension " + std::to_string(dim));
+    }
+    H5::DataSet scale(scaleId); // holds its own reference
+    H5Dclose(scaleId);          // drops the one added in firstScale
+
+    char name[256] = {0};
+    if (H5DSget_scale_name(scale.getId(), name, sizeof(name)) > 0) {
+        scaleName = name;
+    }
+    values.resize(scale.getSpace().getSimpleExtentNpoints());
+    scale.read(values.data(), H5::PredType::NATIVE_INT64);
+    if (!std::is_sorted(values.begin(), values.end())) {
+        throw std::runtime_error("ScaleIndex: scale " + scaleName + " is not sorted");
+    }
+}
+
+std::pair<hsize_t, hsize_t> ScaleIndex::range(int64_t lo, int64_t hi) const {
+    auto first = std::lower_bound(values.begin(), values.end(), lo);
+    auto last = std::upper_bound(first, values.end(), hi);
+    return {static_cast<hsize_t>(first - values.begin()), static_cast<hsize_t>(last - values.begin())};
+}
+
+long long ScaleIndex::find(int64_t label) const {
+    auto it = std::lower_bound(values.begin(), values.end(), label);
+    return (it != values.end() && *it == label) ? static_cast<long long>(it - values.begin()) : -1;
+}
+
+} // namespace h5util
@@ -0,0 +1,48 @@
+// dimension_scales.h
+#ifndef DIMENSION_SCALES_H
+#define DIMENSION_SCALES_H
+
+#include <H5Cpp.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5util {
+
+// Writes labels as a 1-D int64 dataset called name under parent, marks it as a
+// dimension scale (H5DSset_scale) and attaches it to dimension dim of data. The
+// labels must be sorted (non-decreasing) so readers can binary-search them.
+H5::DataSet attachScale(H5::Group& parent, H5::DataSet& data, unsigned dim, const std::string& name,
+                        const std::vector<int64_t>& labels);
+
+// Approximate header bytes the dimension-scale bookkeeping (DIMENSION_LIST)
+// adds to a dataset of the given rank once scales are attached; pass it as
+// DatasetOptions::headerReserve when creating the dataset.
+hsize_t scaleAttachmentHeaderBytes(int rank);
+
+// Sorted labels of the first dimension scale attached to one dimension of a
+// dataset, loaded once and searched in O(log n).
+class ScaleIndex {
+public:
+    ScaleIndex() = default;
+    ScaleIndex(const H5::DataSet& data, unsigned dim);
+
+    const std::string& name() const { return scaleName; }
+    const std::vector<int64_t>& labels() const { return values; }
+    hsize_t size() const { return values.size(); }
+
+    // Index range [first, last) of the labels within [lo, hi]; empty if none.
+    std::pair<hsize_t, hsize_t> range(int64_t lo, int64_t hi) const;
+
+    // Index of label, or -1 if it is not on the axis.
+    long long find(int64_t label) const;
+
+private:
+    std::string scaleName;
+    std::vector<int64_t> values;
+};
+
+} // namespace h5util
+
+#endif // DIMENSION_SCALES_H
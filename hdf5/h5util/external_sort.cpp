@@ -0,0 +1,486 @@
+// external_sort.cpp
+#include "external_sort.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+namespace h5util {
+
+const char* const SORT_KEY_ATTRIBUTE = "sortKey";
+
+namespace {
+
+template <typename T>
+int compareValues(T a, T b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+template <typename T>
+int compareFloats(T a, T b) {
+    const bool nanA = std::isnan(a), nanB = std::isnan(b);
+    if (nanA || nanB) return static_cast<int>(nanA) - static_cast<int>(nanB); // NaN sorts last
+    return compareValues(a, b);
+}
+
+void reclaim(const H5::DataType& memType, void* records, hsize_t count) {
+    if (count == 0) return;
+    reclaimVariable(memType, H5::DataSpace(1, &count), records);
+}
+
+void readRecords(const H5::DataSet& dataset, const H5::DataType& memType, hsize_t start, hsize_t count,
+                 void* records) {
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+    H5::DataSpace memSpace(1, &count);
+    dataset.read(records, memType, memSpace, fileSpace);
+}
+
+void writeRecords(H5::DataSet& dataset, const H5::DataType& memType, hsize_t start, hsize_t count,
+                  const void* records) {
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+    H5::DataSpace memSpace(1, &count);
+    dataset.write(records, memType, memSpace, fileSpace);
+}
+
+enum class KeyKind { Signed, Unsigned, Float, FixedString, VariableString };
+
+struct KeyField {
+    size_t offset;
+    size_t size;
+    KeyKind kind;
+};
+
+// Orders records of a native compound type by its key members.
+class RecordOrder {
+public:
+    RecordOrder(const H5::CompType& memType, const std::vector<std::string>& keys) {
+        for (const std::string& key : keys) {
+            const int index = memType.getMemberIndex(key);
+            KeyField field;
+            field.offset = memType.getMemberOffset(static_cast<unsigned>(index));
+            hid_t memberId = H5Tget_member_type(memType.getId(), static_cast<unsigned>(index));
+            H5::DataType member(memberId);
+            H5Tclose(memberId);
+            field.size = member.getSize();
+            switch (member.getClass()) {
+            case H5T_INTEGER:
+                field.kind = H5Tget_sign(member.getId()) == H5T_SGN_2 ? KeyKind::Signed : KeyKind::Unsigned;
+                break;
+            case H5T_ENUM: {
+                hid_t baseId = H5Tget_super(member.getId());
+                H5::DataType base(baseId);
+                H5Tclose(baseId);
+                field.kind = H5Tget_sign(base.getId()) == H5T_SGN_2 ? KeyKind::Signed : KeyKind::Unsigned;
+                break;
+            }
+            case H5T_FLOAT:
+                if (field.size != sizeof(float) && field.size != sizeof(double)) {
+                    throw std::invalid_argument("sortDataSet: unsupported float size for key " + key);
+                }
+                field.kind = KeyKind::Float;
+                break;
+            case H5T_STRING:
+                field.kind = H5Tis_variable_str(member.getId()) > 0 ? KeyKind::VariableString : KeyKind::FixedString;
+                break;
+            default:
+                throw std::invalid_argument("sortDataSet: member " + key + " cannot be a sort key");
+            }
+            if ((field.kind == KeyKind::Signed || field.kind == KeyKind::Unsigned) &&
+                field.size != 1 && field.size != 2 && field.size != 4 && field.size != 8) {
+                throw std::invalid_argument("sortDataSet: unsupported integer size for key " + key);
+            }
+            fields.push_back(field);
+        }
+    }
+
+    int compare(const unsigned char* a, const unsigned char* b) const {
+        for (const KeyField& field : fields) {
+            const int result = compareField(field, a + field.offset, b + field.offset);
+            if (result != 0) return result;
+        }
+        return 0;
+    }
+
+private:
+    static int compareField(const KeyField& field, const unsigned char* a, const unsigned char* b) {
+        switch (field.kind) {
+        case KeyKind::Signed:
+            switch (field.size) {
+            case 1: return compareValues(load<int8_t>(a), load<int8_t>(b));
+            case 2: return compareValues(load<int16_t>(a), load<int16_t>(b));
+            case 4: return compareValues(load<int32_t>(a), load<int32_t>(b));
+            default: return compareValues(load<int64_t>(a), load<int64_t>(b));
+            }
+        case KeyKind::Unsigned:
+            switch (field.size) {
+            case 1: return compareValues(load<uint8_t>(a), load<uint8_t>(b));
+            case 2: return compareValues(load<uint16_t>(a), load<uint16_t>(b));
+            case 4: return compareValues(load<uint32_t>(a), load<uint32_t>(b));
+            default: return compareValues(load<uint64_t>(a), load<uint64_t>(b));
+            }
+        case KeyKind::Float:
+            return field.size == sizeof(float) ? compareFloats(load<float>(a), load<float>(b))
+                                               : compareFloats(load<double>(a), load<double>(b));
+        case KeyKind::FixedString:
+            return std::strncmp(reinterpret_cast<const char*>(a), reinterpret_cast<const char*>(b), field.size);
+        case KeyKind::VariableString: {
+            const char* sa = load<const char*>(a);
+            const char* sb = load<const char*>(b);
+            return std::strcmp(sa ? sa : "", sb ? sb : "");
+        }
+        }
+        return 0;
+    }
+
+    std::vector<KeyField> fields;
+};
+
+// Stable sort of index over the records: pieces on the pool, then pairwise merges.
+void sortIndices(const RecordOrder& order, const unsigned char* records, size_t recordSize,
+                 std::vector<size_t>& index, unsigned threads) {
+    auto less = [&](size_t a, size_t b) {
+        return order.compare(records + a * recordSize, records + b * recordSize) < 0;
+    };
+    const size_t count = index.size();
+    const size_t pieces = std::max<size_t>(1, std::min<size_t>(threads ? threads : defaultThreads(), count / 4096));
+    std::vector<size_t> bounds(pieces + 1);
+    for (size_t p = 0; p <= pieces; ++p) bounds[p] = count * p / pieces;
+
+    parallelFor(pieces, threads, [&](size_t p) {
+        std::stable_sort(index.begin() + bounds[p], index.begin() + bounds[p + 1], less);
+    });
+    for (size_t width = 1; width < pieces; width *= 2) {
+        parallelFor((pieces + 2 * width - 1) / (2 * width), threads, [&](size_t j) {
+            const size_t lo = bounds[2 * width * j];
+            const size_t mid = bounds[std::min(2 * width * j + width, pieces)];
+            const size_t hi = bounds[std::min(2 * width * j + 2 * width, pieces)];
+            if (mid < hi) {
+                std::inplace_merge(index.begin() + lo, index.begin() + mid, index.begin() + hi, less);
+            }
+        });
+    }
+}
+
+// One sorted run being merged: the next block of its records in memory.
+struct RunCursor {
+    H5::DataSet dataset;
+    hsize_t size = 0;
+    hsize_t nextRead = 0;
+    std::vector<unsigned char> block;
+    size_t count = 0;
+    size_t pos = 0;
+};
+
+// Merges sorted runs into out with a heap over the runs' current records; ties
+// go to the earlier run, which keeps the sort stable.
+void mergeRuns(const std::vector<H5::DataSet>& runs, H5::DataSet& out, const H5::CompType& memType,
+               bool variable, const RecordOrder& order, size_t budget) {
+    const size_t recordSize = memType.getSize();
+    const size_t blockRecords = std::max<size_t>(1, budget / (runs.size() + 1) / recordSize);
+
+    std::vector<RunCursor> cursors(runs.size());
+    std::vector<unsigned char> output(blockRecords * recordSize);
+    size_t outputCount = 0;
+    hsize_t written = 0;
+
+    auto flush = [&]() {
+        if (outputCount == 0) return;
+        writeRecords(out, memType, written, outputCount, output.data());
+        written += outputCount;
+        outputCount = 0;
+    };
+    auto fill = [&](RunCursor& cursor) {
+        cursor.count = static_cast<size_t>(std::min<hsize_t>(blockRecords, cursor.size - cursor.nextRead));
+        cursor.block.resize(cursor.count * recordSize);
+        readRecords(cursor.dataset, memType, cursor.nextRead, cursor.count, cursor.block.data());
+        cursor.nextRead += cursor.count;
+        cursor.pos = 0;
+    };
+    auto after = [&](size_t a, size_t b) {
+        const int result = order.compare(&cursors[a].block[cursors[a].pos * recordSize],
+                                         &cursors[b].block[cursors[b].pos * recordSize]);
+        return result > 0 || (result == 0 && a > b);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+
+    for (size_t r = 0; r < runs.size(); ++r) {
+        cursors[r].dataset = runs[r];
+        cursors[r].size = runs[r].getSpace().getSimpleExtentNpoints();
+        if (cursors[r].size == 0) continue;
+        fill(cursors[r]);
+        heap.push(r);
+    }
+    while (!heap.empty()) {
+        const size_t r = heap.top();
+        heap.pop();
+        RunCursor& cursor = cursors[r];
+        std::memcpy(&output[outputCount * recordSize], &cursor.block[cursor.pos * recordSize], recordSize);
+        if (++outputCount == blockRecords) flush();
+        if (++cursor.pos < cursor.count) {
+            heap.push(r);
+            continue;
+        }
+        // The output may still point at this block's strings: write it out first.
+        if (variable) {
+            flush();
+            reclaim(memType, cursor.block.data(), cursor.count);
+        }
+        if (cursor.nextRead < cursor.size) {
+            fill(cursor);
+            heap.push(r);
+        }
+    }
+    flush();
+}
+
+void writeSortKey(H5::DataSet& dataset, const std::vector<std::string>& keys) {
+    std::string joined;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i > 0) joined += ',';
+        joined += keys[i];
+    }
+    H5::StrType type(H5::PredType::C_S1, H5T_VARIABLE);
+    H5::Attribute attribute = dataset.createAttribute(SORT_KEY_ATTRIBUTE, type, H5::DataSpace(H5S_SCALAR));
+    const char* value = joined.c_str();
+    attribute.write(type, &value);
+}
+
+} // namespace
+
+SortStats sortDataSet(const H5::DataSet& source, H5::Group& destParent, const std::string& name,
+                      const SortOptions& options) {
+    if (options.keys.empty()) {
+        throw std::invalid_argument("sortDataSet: no sort key");
+    }
+    H5::DataType fileType = source.getDataType();
+    if (fileType.getClass() != H5T_COMPOUND) {
+        throw std::invalid_argument("sortDataSet: dataset is not compound");
+    }
+    H5::DataSpace space = source.getSpace();
+    if (space.getSimpleExtentNdims() != 1) {
+        throw std::invalid_argument("sortDataSet: dataset is not one-dimensional");
+    }
+    hid_t nativeType = H5Tget_native_type(fileType.getId(), H5T_DIR_ASCEND);
+    H5::CompType memType(nativeType);
+    H5Tclose(nativeType);
+    const RecordOrder order(memType, options.keys);
+    const bool variable = hasVariableParts(memType.getId());
+    const size_t recordSize = memType.getSize();
+
+    SortStats stats;
+    stats.records = space.getSimpleExtentNpoints();
+
+    // Keep the source's storage choices, but never share its external raw file.
+    H5::DSetCreatPropList sourcePlist = source.getCreatePlist();
+    H5::DataSet dest = destParent.createDataSet(
+        name, fileType, space, sourcePlist.getExternalCount() > 0 ? H5::DSetCreatPropList() : sourcePlist);
+
+    // Buffers per run: the records as read, the same records in sorted order and the index.
+    const hsize_t runRecords = std::max<size_t>(1, options.memoryBudget / (2 * recordSize + sizeof(size_t)));
+    const std::string scratchName =
+        options.scratchFile.empty() ? destParent.getFileName() + ".sort.tmp" : options.scratchFile;
+    std::unique_ptr<H5::H5File> scratch;
+    std::vector<H5::DataSet> runs;
+
+    try {
+        std::vector<unsigned char> records, sorted;
+        std::vector<size_t> index;
+        for (hsize_t start = 0; start < stats.records || start == 0; start += runRecords) {
+            const hsize_t count = std::min(runRecords, stats.records - start);
+            records.resize(count * recordSize);
+            sorted.resize(count * recordSize);
+
+            auto begin = Clock::now();
+            if (count > 0) readRecords(source, memType, start, count, records.data());
+            stats.readSeconds += secondsSince(begin);
+
+            begin = Clock::now();
+            index.resize(count);
+            std::iota(index.begin(), index.end(), size_t(0));
+            sortIndices(order, records.data(), recordSize, index, options.threads);
+            parallelFor(count, options.threads, [&](size_t i) {
+                std::memcpy(&sorted[i * recordSize], &records[index[i] * recordSize], recordSize);
+            });
+            stats.sortSeconds += secondsSince(begin);
+
+            begin = Clock::now();
+            if (count == stats.records) {
+                if (count > 0) writeRecords(dest, memType, 0, count, sorted.data());
+            } else {
+                if (!scratch) scratch.reset(new H5::H5File(scratchName, H5F_ACC_TRUNC));
+                hsize_t dims[1] = {count};
+                H5::DataSet run = scratch->createDataSet("run" + std::to_string(runs.size()), fileType,
+                                                         H5::DataSpace(1, dims));
+                writeRecords(run, memType, 0, count, sorted.data());
+                runs.push_back(run);
+            }
+            stats.writeSeconds += secondsSince(begin);
+            if (variable) reclaim(memType, records.data(), count); // sorted shares the strings
+            ++stats.runs;
+            if (count == stats.records) break;
+        }
+
+        if (!runs.empty()) {
+            auto begin = Clock::now();
+            // k runs plus the output, each a block of at least MIN_MERGE_BLOCK; never below 2.
+            const size_t blocks = options.memoryBudget / SortOptions::MIN_MERGE_BLOCK;
+            const size_t fanIn = blocks > 3 ? blocks - 1 : 2;
+            while (runs.size() > fanIn) {
+                std::vector<H5::DataSet> merged;
+                for (size_t first = 0; first < runs.size(); first += fanIn) {
+                    std::vector<H5::DataSet> group(runs.begin() + first,
+                                                   runs.begin() + std::min(first + fanIn, runs.size()));
+                    hsize_t total = 0;
+                    for (const H5::DataSet& run : group) total += run.getSpace().getSimpleExtentNpoints();
+                    H5::DataSet out = scratch->createDataSet(
+                        "merge" + std::to_string(stats.mergePasses) + "_" + std::to_string(merged.size()), fileType,
+                        H5::DataSpace(1, &total));
+                    mergeRuns(group, out, memType, variable, order, options.memoryBudget);
+                    merged.push_back(out);
+                }
+                runs.swap(merged);
+                ++stats.mergePasses;
+            }
+            mergeRuns(runs, dest, memType, variable, order, options.memoryBudget);
+            ++stats.mergePasses;
+            stats.mergeSeconds += secondsSince(begin);
+        }
+    } catch (...) {
+        runs.clear();
+        if (scratch) {
+            scratch.reset();
+            std::remove(scratchName.c_str());
+        }
+        throw;
+    }
+    runs.clear();
+    if (scratch) {
+        scratch.reset();
+        std::remove(scratchName.c_str());
+    }
+    writeSortKey(dest, options.keys);
+    return stats;
+}
+
+std::vector<std::string> sortKey(const H5::DataSet& dataset) {
+    std::vector<std::string> keys;
+    if (!dataset.attrExists(SORT_KEY_ATTRIBUTE)) return keys;
+    H5::Attribute attribute = dataset.openAttribute(SORT_KEY_ATTRIBUTE);
+    std::string joined;
+    attribute.read(attribute.getStrType(), joined);
+    std::stringstream in(joined);
+    std::string key;
+    while (std::getline(in, key, ',')) keys.push_back(key);
+    return keys;
+}
+
+namespace {
+
+// Reads the leading key member of single rows of a sorted dataset.
+class KeyProbe {
+public:
+    KeyProbe(const H5::DataSet& sorted, bool wantString)
+        : dataset(sorted), memType(probeType(sorted, wantString, variable)), buffer(memType.getSize()),
+          count(sorted.getSpace().getSimpleExtentNpoints()) {}
+
+    hsize_t rows() const { return count; }
+
+    double number(hsize_t row) {
+        read(row);
+        return load<double>(buffer.data());
+    }
+
+    std::string text(hsize_t row) {
+        read(row);
+        if (!variable) {
+            return std::string(reinterpret_cast<const char*>(buffer.data()),
+                               strnlen(reinterpret_cast<const char*>(buffer.data()), buffer.size()));
+        }
+        const char* value = load<const char*>(buffer.data());
+        std::string result = value ? value : "";
+        reclaim(memType, buffer.data(), 1);
+        return result;
+    }
+
+private:
+    // Memory type holding just the leading key member.
+    static H5::CompType probeType(const H5::DataSet& sorted, bool wantString, bool& variable) {
+        const std::vector<std::string> keys = sortKey(sorted);
+        if (keys.empty()) {
+            throw std::invalid_argument("equalRange: dataset has no " + std::string(SORT_KEY_ATTRIBUTE) + " attribute");
+        }
+        H5::CompType fileType = sorted.getCompType();
+        const unsigned index = static_cast<unsigned>(fileType.getMemberIndex(keys[0]));
+        if ((fileType.getMemberClass(index) == H5T_STRING) != wantString) {
+            throw std::invalid_argument("equalRange: value type does not match key member " + keys[0]);
+        }
+        variable = false;
+        if (!wantString) {
+            H5::CompType type(sizeof(double));
+            type.insertMember(keys[0], 0, H5::PredType::NATIVE_DOUBLE);
+            return type;
+        }
+        H5::StrType member = fileType.getMemberStrType(index);
+        variable = member.isVariableStr();
+        H5::StrType memberType(H5::PredType::C_S1, variable ? H5T_VARIABLE : member.getSize());
+        memberType.setCset(member.getCset());
+        H5::CompType type(variable ? sizeof(char*) : member.getSize());
+        type.insertMember(keys[0], 0, memberType);
+        return type;
+    }
+
+    void read(hsize_t row) {
+        readRecords(dataset, memType, row, 1, buffer.data());
+    }
+
+    H5::DataSet dataset;
+    bool variable = false;
+    H5::CompType memType;
+    std::vector<unsigned char> buffer;
+    hsize_t count;
+};
+
+// First row not before value (upper: first row after value), given less(a, b).
+template <typename T, typename Get, typename Less>
+hsize_t bound(hsize_t size, const T& value, Get get, Less less, bool upper) {
+    hsize_t lo = 0, hi = size;
+    while (lo < hi) {
+        const hsize_t mid = lo + (hi - lo) / 2;
+        const T key = get(mid);
+        if (upper ? !less(value, key) : less(key, value)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+} // namespace
+
+std::pair<hsize_t, hsize_t> equalRange(const H5::DataSet& sorted, double value) {
+    KeyProbe probe(sorted, false);
+    auto get = [&](hsize_t row) { return probe.number(row); };
+    auto less = [](double a, double b) { return compareFloats(a, b) < 0; };
+    return {bound(probe.rows(), value, get, less, false), bound(probe.rows(), value, get, less, true)};
+}
+
+std::pair<hsize_t, hsize_t> equalRange(const H5::DataSet& sorted, const std::string& value) {
+    KeyProbe probe(sorted, true);
+    auto get = [&](hsize_t row) { return probe.text(row); };
+    auto less = [](const std::string& a, const std::string& b) { return a < b; };
+    return {bound(probe.rows(), value, get, less, false), bound(probe.rows(), value, get, less, true)};
+}
+
+} // namespace h5util
@@ -0,0 +1,66 @@
+// external_sort.h
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h5util {
+
+// Attribute naming the members a dataset is sorted by, comma separated.
+extern const char* const SORT_KEY_ATTRIBUTE;
+
+struct SortOptions {
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+    static constexpr size_t MIN_MERGE_BLOCK = 64 * 1024; // per run while merging; bounds the fan-in
+
+    std::vector<std::string> keys;  // member names, most significant first (required)
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET; // record buffers, not counting variable-length payloads
+    unsigned threads = 0;           // run sorting workers, 0: hardware concurrency
+    std::string scratchFile;        // sorted runs; empty: "<dest file>.sort.tmp"
+};
+
+struct SortStats {
+    hsize_t records = 0;
+    size_t runs = 0;                // sorted runs written by the first phase
+    unsigned mergePasses = 0;       // 0: everything fit in one run
+    double readSeconds = 0;
+    double sortSeconds = 0;
+    double writeSeconds = 0;        // runs, and the output of an in-memory sort
+    double mergeSeconds = 0;        // k-way merges, including their reads and writes
+};
+
+// Writes the records of the one-dimensional compound dataset source to a new
+// dataset name under destParent, ascending by the key members, and tags it with
+// SORT_KEY_ATTRIBUTE. The sort is stable. Keys may be integer, enum, float
+// (NaN last) or string members.
+//
+// Records are read in runs sized so the records as read, their sorted copy and
+// the sort index together fit the memory budget. Each run is sorted by index
+// on the thread pool (pieces sorted in parallel, then merged pairwise) and
+// written to the scratch file. Runs are then merged k at a time through a
+// heap, each reading blocks of the budget divided by k + 1, with further merge
+// passes when there are more runs than the budget allows blocks of
+// MIN_MERGE_BLOCK (k is at least 2). A dataset that fits in one run is written
+// directly.
+// The destination keeps the source's creation properties; attributes are not
+// copied.
+SortStats sortDataSet(const H5::DataSet& source, H5::Group& destParent, const std::string& name,
+                      const SortOptions& options);
+
+// The key members recorded on a sorted dataset; empty if it has none.
+std::vector<std::string> sortKey(const H5::DataSet& dataset);
+
+// Rows [first, last) of a sorted dataset whose leading key member equals value,
+// found by binary search with one single-record read per step. The numeric form
+// compares as double, the string form byte-wise. Throws std::invalid_argument if
+// the dataset carries no sort key.
+std::pair<hsize_t, hsize_t> equalRange(const H5::DataSet& sorted, double value);
+std::pair<hsize_t, hsize_t> equalRange(const H5::DataSet& sorted, const std::string& value);
+
+} // namespace h5util
+
+#endif // EXTERNAL_SORT_H
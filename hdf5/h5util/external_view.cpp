@@ -0,0 +1,100 @@
+// external_view.cpp
+#include "external_view.h"
+
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace h5util {
+
+ExternalView::ExternalView(const H5::DataSet& dataset)
+    : type(dataset.getDataType()), count(dataset.getSpace().getSimpleExtentNpoints()), length(0),
+      base(nullptr), mapping(nullptr), mappingLength(0) {
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE;
+    mapHandle = nullptr;
+#else
+    fd = -1;
+#endif
+    H5::DSetCreatPropList dcpl = dataset.getCreatePlist();
+    if (dcpl.getExternalCount() != 1) {
+        throw std::invalid_argument("ExternalView: dataset does not use single-segment external storage");
+    }
+    std::vector<char> name(4096, '\0');
+    off_t offset = 0;
+    hsize_t segmentSize = 0;
+    dcpl.getExternal(0, name.size(), name.data(), offset, segmentSize);
+    file = name.data();
+    length = static_cast<size_t>(count * type.getSize());
+    if (segmentSize != H5F_UNLIMITED && segmentSize < length) {
+        throw std::runtime_error("ExternalView: external segment is smaller than the dataset");
+    }
+    if (length == 0) return;
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t granularity = info.dwAllocationGranularity;
+#else
+    const size_t granularity = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    // Map from an aligned offset and point base at the first data byte.
+    const size_t alignedOffset = static_cast<size_t>(offset) / granularity * granularity;
+    const size_t lead = static_cast<size_t>(offset) - alignedOffset;
+    mappingLength = lead + length;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("ExternalView: cannot open " + file);
+    }
+    mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapHandle == nullptr) {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("ExternalView: cannot map " + file);
+    }
+    mapping = MapViewOfFile(mapHandle, FILE_MAP_READ, static_cast<DWORD>(uint64_t(alignedOffset) >> 32),
+                            static_cast<DWORD>(alignedOffset & 0xFFFFFFFFu), mappingLength);
+    if (mapping == nullptr) {
+        CloseHandle(mapHandle);
+        CloseHandle(fileHandle);
+        throw std::runtime_error("ExternalView: cannot map " + file);
+    }
+#else
+    fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("ExternalView: cannot open " + file);
+    }
+    mapping = ::mmap(nullptr, mappingLength, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(alignedOffset));
+    if (mapping == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("ExternalView: cannot map " + file);
+    }
+#endif
+    base = static_cast<const unsigned char*>(mapping) + lead;
+}
+
+ExternalView::~ExternalView() {
+#ifdef _WIN32
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mapHandle) CloseHandle(mapHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+    if (mapping) ::munmap(mapping, mappingLength);
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+bool ExternalView::matches(const H5::DataType& memType) const {
+    return H5Tequal(type.getId(), memType.getId()) > 0;
+}
+
+} // namespace h5util
@@ -0,0 +1,53 @@
+// external_view.h
+#ifndef EXTERNAL_VIEW_H
+#define EXTERNAL_VIEW_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <string>
+
+namespace h5util {
+
+// Read-only memory mapping of the raw bytes of a dataset stored with external
+// storage (DatasetOptions::external). The bytes are in the dataset's file type;
+// check fileType() against the native type before reinterpreting them.
+// Only single-segment external storage is supported.
+class ExternalView {
+public:
+    explicit ExternalView(const H5::DataSet& dataset);
+    ~ExternalView();
+
+    ExternalView(const ExternalView&) = delete;
+    ExternalView& operator=(const ExternalView&) = delete;
+
+    const void* data() const { return base; }
+    size_t size() const { return length; }
+    hsize_t elements() const { return count; }
+    const H5::DataType& fileType() const { return type; }
+    const std::string& path() const { return file; }
+
+    // True if the raw bytes can be used directly as an array of memType.
+    bool matches(const H5::DataType& memType) const;
+
+    template <typename T>
+    const T* as() const { return static_cast<const T*>(base); }
+
+private:
+    std::string file;
+    H5::DataType type;
+    hsize_t count;
+    size_t length;
+    const void* base;
+    void* mapping;
+    size_t mappingLength;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mapHandle;
+#else
+    int fd;
+#endif
+};
+
+} // namespace h5util
+
+#endif // EXTERNAL_VIEW_H
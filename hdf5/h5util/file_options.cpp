@@ -0,0 +1,123 @@
+// file_options.cpp
+#include "file_options.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace h5util {
+
+FileOptions FileOptions::paged(hsize_t pageSize, size_t pageBufferSize) {
+    FileOptions options;
+    options.pageSize = pageSize;
+    options.pageBufferSize = pageBufferSupported() ? pageBufferSize : 0;
+    return options;
+}
+
+bool pageBufferSupported() {
+#if H5_VERSION_GE(1, 14, 0)
+    return true;
+#else
+    return false;
+#endif
+}
+
+H5::FileCreatPropList makeFileCreatePlist(const FileOptions& options) {
+    H5::FileCreatPropList fcpl;
+    if (options.pageSize > 0) {
+        if (H5Pset_file_space_strategy(fcpl.getId(), H5F_FSPACE_STRATEGY_PAGE, options.persistFreeSpace, 1) < 0 ||
+            H5Pset_file_space_page_size(fcpl.getId(), options.pageSize) < 0) {
+            throw H5::PropListIException("makeFileCreatePlist", "could not select paged aggregation");
+        }
+    } else if (options.persistFreeSpace) {
+        throw std::invalid_argument("makeFileCreatePlist: persistFreeSpace requires a page size");
+    }
+    return fcpl;
+}
+
+H5::FileAccPropList makeFileAccessPlist(const FileOptions& options) {
+    H5::FileAccPropList fapl;
+    if (options.metadataCacheImage) {
+        fapl.setLibverBounds(H5F_LIBVER_V110, H5F_LIBVER_LATEST);
+        H5AC_cache_image_config_t config;
+        config.version = H5AC__CURR_CACHE_IMAGE_CONFIG_VERSION;
+        config.generate_image = true;
+        config.save_resize_status = false;
+        config.entry_ageout = H5AC__CACHE_IMAGE__ENTRY_AGEOUT__NONE;
+        if (H5Pset_mdc_image_config(fapl.getId(), &config) < 0) {
+            throw H5::PropListIException("makeFileAccessPlist", "H5Pset_mdc_image_config failed");
+        }
+    }
+    if (options.metadataCacheBytes > 0) {
+        H5AC_cache_config_t config;
+        config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+        if (H5Pget_mdc_config(fapl.getId(), &config) < 0) {
+            throw H5::PropListIException("makeFileAccessPlist", "H5Pget_mdc_config failed");
+        }
+        config.set_initial_size = true;
+        config.initial_size = options.metadataCacheBytes;
+        config.max_size = std::max(config.max_size, options.metadataCacheBytes);
+        config.min_size = std::min(config.min_size, options.metadataCacheBytes);
+        if (H5Pset_mdc_config(fapl.getId(), &config) < 0) {
+            throw H5::PropListIException("makeFileAccessPlist", "H5Pset_mdc_config failed");
+        }
+    }
+    if (options.pageBufferSize > 0) {
+        if (!pageBufferSupported()) {
+            throw std::runtime_error("makeFileAccessPlist: the page buffer needs HDF5 1.14 or later");
+        }
+        if (options.minMetadataPercent + options.minRawPercent > 100) {
+            throw std::invalid_argument("makeFileAccessPlist: page buffer shares exceed 100%");
+        }
+        if (H5Pset_page_buffer_size(fapl.getId(), options.pageBufferSize, options.minMetadataPercent,
+                                    options.minRawPercent) < 0) {
+            throw H5::PropListIException("makeFileAccessPlist", "H5Pset_page_buffer_size failed");
+        }
+    }
+    return fapl;
+}
+
+H5::H5File createFile(const std::string& name, const FileOptions& options) {
+    return H5::H5File(name, H5F_ACC_TRUNC, makeFileCreatePlist(options), makeFileAccessPlist(options));
+}
+
+H5::H5File openFile(const std::string& name, unsigned flags, const FileOptions& options) {
+    return H5::H5File(name, flags, H5::FileCreatPropList::DEFAULT, makeFileAccessPlist(options));
+}
+
+hsize_t filePageSize(const H5::H5File& file) {
+    H5::FileCreatPropList fcpl = file.getCreatePlist();
+    H5F_fspace_strategy_t strategy;
+    hbool_t persist = false;
+    hsize_t threshold = 0;
+    hsize_t pageSize = 0;
+    if (H5Pget_file_space_strategy(fcpl.getId(), &strategy, &persist, &threshold) < 0 ||
+        H5Pget_file_space_page_size(fcpl.getId(), &pageSize) < 0) {
+        throw H5::PropListIException("filePageSize", "could not read the file space strategy");
+    }
+    return strategy == H5F_FSPACE_STRATEGY_PAGE ? pageSize : 0;
+}
+
+hsize_t cacheImageSize(const H5::H5File& file) {
+    haddr_t address = HADDR_UNDEF;
+    hsize_t size = 0;
+    if (H5Fget_mdc_image_info(file.getId(), &address, &size) < 0) {
+        throw H5::FileIException("cacheImageSize", "H5Fget_mdc_image_info failed");
+    }
+    return address == HADDR_UNDEF ? 0 : size;
+}
+
+void printPageBufferStats(std::ostream& out, const H5::H5File& file) {
+    unsigned accesses[2], hits[2], misses[2], evictions[2], bypasses[2];
+    H5E_auto2_t func;
+    void* clientData;
+    H5Eget_auto2(H5E_DEFAULT, &func, &clientData);
+    H5Eset_auto2(H5E_DEFAULT, nullptr, nullptr); // fails quietly without a page buffer
+    herr_t status = H5Fget_page_buffering_stats(file.getId(), accesses, hits, misses, evictions, bypasses);
+    H5Eset_auto2(H5E_DEFAULT, func, clientData);
+    if (status < 0) return;
+    out << "page buffer: metadata " << hits[0] << "/" << accesses[0] << " hits, raw " << hits[1] << "/"
+        << accesses[1] << " hits, " << misses[0] + misses[1] << " misses, " << evictions[0] + evictions[1]
+        << " evictions, " << bypasses[0] + bypasses[1] << " bypasses\n";
+}
+
+} // namespace h5util
@@ -0,0 +1,76 @@
+// file_options.h
+#ifndef FILE_OPTIONS_H
+#define FILE_OPTIONS_H
+
+#include <H5Cpp.h>
+#include <ostream>
+#include <string>
+
+namespace h5util {
+
+// File-level choices shared by the example writers and readers. A
+// default-constructed value reproduces H5File(name, flags) with default
+// property lists.
+struct FileOptions {
+    static constexpr hsize_t DEFAULT_PAGE_SIZE = 64 * 1024;
+    static constexpr size_t DEFAULT_PAGE_BUFFER = 16 * 1024 * 1024;
+
+    // Creation: 0 keeps the default free-space strategy (metadata and small raw
+    // data aggregated into separate blocks). Otherwise H5F_FSPACE_STRATEGY_PAGE:
+    // every allocation lands in a page of this size holding only metadata or
+    // only raw data, so a page read fetches many neighbouring objects at once.
+    hsize_t pageSize = 0;
+    bool persistFreeSpace = false; // keep free-space managers across close (paged only)
+
+    // Access: 0 disables the page buffer. It only applies to files created with
+    // a page size; opening a non-paged file with it set fails. Needs HDF5 1.14
+    // or later (see pageBufferSupported()).
+    size_t pageBufferSize = 0;
+    unsigned minMetadataPercent = 0; // page buffer share reserved for metadata pages
+    unsigned minRawPercent = 0;      // page buffer share reserved for raw data pages
+
+    // Creation/write access: save the metadata cache as one contiguous image on
+    // close (H5Pset_mdc_image_config), so the next open loads it with a single
+    // read instead of walking object headers and B-trees. Requires the 1.10
+    // file format, which this option selects; older readers cannot open such
+    // files. Opening the file read-write consumes the image.
+    bool metadataCacheImage = false;
+
+    // Access: 0 keeps the default metadata cache sizing (2 MiB, adaptive).
+    // Otherwise the cache starts at and may grow to this many bytes; a loaded
+    // cache image should fit, or its entries are evicted as soon as they arrive.
+    size_t metadataCacheBytes = 0;
+
+    // Paged aggregation on create and, where pageBufferSupported(), a page buffer
+    // on open.
+    static FileOptions paged(hsize_t pageSize = DEFAULT_PAGE_SIZE, size_t pageBufferSize = DEFAULT_PAGE_BUFFER);
+};
+
+// False before HDF5 1.14: the page buffer of 1.10 and 1.12 can copy past the
+// end of a page on metadata reads (seen as a heap overflow in H5PB_read on
+// 1.10.8), so a non-zero pageBufferSize is rejected there.
+bool pageBufferSupported();
+
+H5::FileCreatPropList makeFileCreatePlist(const FileOptions& options);
+H5::FileAccPropList makeFileAccessPlist(const FileOptions& options);
+
+// H5File(name, H5F_ACC_TRUNC) with the creation and access options applied.
+H5::H5File createFile(const std::string& name, const FileOptions& options = FileOptions());
+
+// H5File(name, flags) with the access options applied.
+H5::H5File openFile(const std::string& name, unsigned flags, const FileOptions& options = FileOptions());
+
+// Page size of a file created with paged aggregation, or 0.
+hsize_t filePageSize(const H5::H5File& file);
+
+// Size of the metadata cache image of a freshly opened file, or 0 when it has
+// none. Call it before any other operation on a file opened read-write.
+hsize_t cacheImageSize(const H5::H5File& file);
+
+// Page buffer accesses, hits and misses of an open file (metadata + raw data);
+// nothing is printed when the file has no page buffer.
+void printPageBufferStats(std::ostream& out, const H5::H5File& file);
+
+} // namespace h5util
+
+#endif // FILE_OPTIONS_H
@@ -0,0 +1,127 @@
+// fixed_point.cpp
+#include "fixed_point.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace h5util {
+
+namespace {
+
+// The column loop works on runs of this many rows with local accumulators, so
+// the compiler keeps them in registers and the caller's stats stay untouched
+// until the run ends.
+constexpr size_t RUN_ROWS = 256;
+
+template <typename Op>
+size_t compareWith(const uint32_t* values, size_t count, size_t stride, uint32_t threshold, uint8_t* mask, Op op) {
+    size_t matches = 0;
+    if (stride == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t bit = op(values[i], threshold);
+            mask[i] = bit;
+            matches += bit;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t bit = op(values[i * stride], threshold);
+            mask[i] = bit;
+            matches += bit;
+        }
+    }
+    return matches;
+}
+
+} // namespace
+
+uint32_t toFixed(double value, unsigned fractionBits) {
+    const double raw = std::nearbyint(std::ldexp(value, static_cast<int>(fractionBits)));
+    if (!(raw > 0)) return 0;
+    if (raw >= static_cast<double>(UINT32_MAX)) return UINT32_MAX;
+    return static_cast<uint32_t>(raw);
+}
+
+void FixedStats::merge(const FixedStats& other) {
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+uint32_t FixedStats::meanRaw() const {
+    return count == 0 ? 0 : static_cast<uint32_t>((sum + count / 2) / count);
+}
+
+double FixedStats::mean(unsigned fractionBits) const {
+    return count == 0 ? 0 : fromFixed(sum, fractionBits) / static_cast<double>(count);
+}
+
+FixedStats fixedStats(const uint32_t* values, size_t count) {
+    FixedStats stats;
+    uint64_t sum = 0;
+    uint32_t low = UINT32_MAX, high = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += values[i];
+        low = std::min(low, values[i]);
+        high = std::max(high, values[i]);
+    }
+    stats.count = count;
+    stats.sum = sum;
+    stats.min = low;
+    stats.max = high;
+    return stats;
+}
+
+void accumulateFixedColumns(const uint32_t* matrix, size_t rows, size_t columns, std::vector<FixedStats>& stats) {
+    if (stats.empty()) stats.resize(columns);
+    std::vector<uint64_t> sums(columns);
+    std::vector<uint32_t> lows(columns), highs(columns);
+    for (size_t first = 0; first < rows; first += RUN_ROWS) {
+        const size_t count = std::min(RUN_ROWS, rows - first);
+        std::fill(sums.begin(), sums.end(), 0);
+        std::fill(lows.begin(), lows.end(), UINT32_MAX);
+        std::fill(highs.begin(), highs.end(), 0);
+        for (size_t r = 0; r < count; ++r) {
+            const uint32_t* row = matrix + (first + r) * columns;
+            for (size_t c = 0; c < columns; ++c) {
+                sums[c] += row[c];
+                lows[c] = std::min(lows[c], row[c]);
+                highs[c] = std::max(highs[c], row[c]);
+            }
+        }
+        for (size_t c = 0; c < columns; ++c) {
+            stats[c].count += count;
+            stats[c].sum += sums[c];
+            stats[c].min = std::min(stats[c].min, lows[c]);
+            stats[c].max = std::max(stats[c].max, highs[c]);
+        }
+    }
+}
+
+void fixedMultiply(const uint32_t* values, size_t count, size_t stride, uint32_t factor, uint32_t* out,
+                   unsigned fractionBits) {
+    const uint64_t half = (uint64_t(1) << fractionBits) >> 1;
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t product = (uint64_t(values[i * stride]) * factor + half) >> fractionBits;
+        out[i] = static_cast<uint32_t>(std::min<uint64_t>(product, UINT32_MAX));
+    }
+}
+
+size_t fixedCompare(const uint32_t* values, size_t count, size_t stride, Compare op, uint32_t threshold,
+                    uint8_t* mask) {
+    switch (op) {
+    case Compare::Less:
+        return compareWith(values, count, stride, threshold, mask, [](uint32_t a, uint32_t b) { return a < b; });
+    case Compare::LessEqual:
+        return compareWith(values, count, stride, threshold, mask, [](uint32_t a, uint32_t b) { return a <= b; });
+    case Compare::Equal:
+        return compareWith(values, count, stride, threshold, mask, [](uint32_t a, uint32_t b) { return a == b; });
+    case Compare::GreaterEqual:
+        return compareWith(values, count, stride, threshold, mask, [](uint32_t a, uint32_t b) { return a >= b; });
+    case Compare::Greater:
+        break;
+    }
+    return compareWith(values, count, stride, threshold, mask, [](uint32_t a, uint32_t b) { return a > b; });
+}
+
+} // namespace h5util
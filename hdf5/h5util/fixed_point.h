@@ -0,0 +1,77 @@
+// fixed_point.h
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace h5util {
+
+// Kernels over unsigned fixed-point numbers kept in their packed form: a raw
+// 32-bit word holds value * 2^fractionBits, as in the weather matrix (7
+// fractional bits, so raw = value * 128). The kernels read the words the way
+// HDF5 returns them through the file type, so aggregates need no conversion to
+// double and touch half the bytes.
+//
+// Sums are kept in 64-bit accumulators and are exact for up to 2^32 words.
+// Products are formed in 64 bits, rounded to nearest and saturate at
+// UINT32_MAX. The loops have no data-dependent branches so the compiler can
+// vectorise them: GCC does at -O3, and unsigned 32-bit min/max need SSE4.1 or
+// later (-march=native) to stay in vector registers. The build tasks use -O2,
+// so both are opt-in.
+
+constexpr unsigned WEATHER_FRACTION_BITS = 7;
+
+// Nearest raw word for value, saturating at 0 and UINT32_MAX.
+uint32_t toFixed(double value, unsigned fractionBits = WEATHER_FRACTION_BITS);
+
+inline double fromFixed(uint64_t raw, unsigned fractionBits = WEATHER_FRACTION_BITS) {
+    return static_cast<double>(raw) / static_cast<double>(uint64_t(1) << fractionBits);
+}
+
+// a * b rounded to nearest; both operands and the result use fractionBits.
+inline uint32_t fixedMultiply(uint32_t a, uint32_t b, unsigned fractionBits = WEATHER_FRACTION_BITS) {
+    const uint64_t product = (uint64_t(a) * b + ((uint64_t(1) << fractionBits) >> 1)) >> fractionBits;
+    return product > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(product);
+}
+
+struct FixedStats {
+    uint64_t count = 0;
+    uint64_t sum = 0; // raw words
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+
+    void merge(const FixedStats& other);
+
+    // Mean as a raw word, rounded to nearest; 0 when empty.
+    uint32_t meanRaw() const;
+    double mean(unsigned fractionBits = WEATHER_FRACTION_BITS) const;
+};
+
+enum class Compare { Less, LessEqual, Equal, GreaterEqual, Greater };
+
+// Statistics of count contiguous words.
+FixedStats fixedStats(const uint32_t* values, size_t count);
+
+// Adds rows of a row-major matrix with columns words per row to stats, one
+// entry per column (resized to columns if empty). The inner loop runs across a
+// row, so every column is updated from one contiguous read of the row.
+void accumulateFixedColumns(const uint32_t* matrix, size_t rows, size_t columns, std::vector<FixedStats>& stats);
+
+// The strided kernels below read values[i * stride] for i in [0, count); a
+// stride of the column count selects one column of a row-major matrix.
+
+// out[i] = values[i * stride] * factor with fractionBits rounding, for unit
+// conversions without leaving the encoding. out may equal values if stride is 1.
+void fixedMultiply(const uint32_t* values, size_t count, size_t stride, uint32_t factor, uint32_t* out,
+                   unsigned fractionBits = WEATHER_FRACTION_BITS);
+
+// mask[i] = values[i * stride] <op> threshold, as 0 or 1; returns the number of
+// ones.
+size_t fixedCompare(const uint32_t* values, size_t count, size_t stride, Compare op, uint32_t threshold,
+                    uint8_t* mask);
+
+} // namespace h5util
+
+#endif // FIXED_POINT_H
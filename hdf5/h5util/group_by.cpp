@@ -0,0 +1,329 @@
+// group_by.cpp
+#include "group_by.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+double initialValue(Aggregate op) {
+    switch (op) {
+    case Aggregate::Min: return std::numeric_limits<double>::infinity();
+    case Aggregate::Max: return -std::numeric_limits<double>::infinity();
+    default: return 0.0;
+    }
+}
+
+// acc[groups[i]] = update(acc[groups[i]], value of row i), for one member type.
+template <typename T, typename Update>
+void updateColumn(double* acc, const uint32_t* groups, const unsigned char* values, size_t stride, size_t count,
+                  Update update) {
+    for (size_t i = 0; i < count; ++i) {
+        double& target = acc[groups[i]];
+        target = update(target, static_cast<double>(load<T>(values + i * stride)));
+    }
+}
+
+} // namespace
+
+H5::CompType GroupBy::memoryType(const H5::DataSet& dataset, const std::string& keyMember,
+                                 const std::vector<AggregateSpec>& specs) {
+    if (dataset.getSpace().getSimpleExtentNdims() != 1) {
+        throw std::invalid_argument("GroupBy: dataset is not one-dimensional");
+    }
+    // The wrappers below take their own references; the raw ids are closed after wrapping.
+    hid_t nativeId = H5Tget_native_type(dataset.getCompType().getId(), H5T_DIR_ASCEND);
+    H5::CompType native(nativeId);
+    H5Tclose(nativeId);
+    std::vector<std::string> needed{keyMember};
+    for (const AggregateSpec& spec : specs) {
+        if (spec.op != Aggregate::Count && std::find(needed.begin(), needed.end(), spec.member) == needed.end()) {
+            needed.push_back(spec.member);
+        }
+    }
+    bool project = false;
+    for (int i = 0; i < native.getNmembers() && !project; ++i) {
+        hid_t member = H5Tget_member_type(native.getId(), static_cast<unsigned>(i));
+        project = hasVariableParts(member) &&
+                  std::find(needed.begin(), needed.end(), native.getMemberName(static_cast<unsigned>(i))) ==
+                      needed.end();
+        H5Tclose(member);
+    }
+    if (!project) return native;
+
+    std::vector<H5::DataType> types;
+    std::vector<size_t> offsets;
+    size_t size = 0;
+    for (const std::string& name : needed) {
+        hid_t member = H5Tget_member_type(native.getId(), static_cast<unsigned>(native.getMemberIndex(name)));
+        types.emplace_back(member);
+        H5Tclose(member);
+        offsets.push_back((size + 7) & ~static_cast<size_t>(7));
+        size = offsets.back() + types.back().getSize();
+    }
+    H5::CompType projection(size);
+    for (size_t m = 0; m < needed.size(); ++m) {
+        projection.insertMember(needed[m], offsets[m], types[m]);
+    }
+    return projection;
+}
+
+GroupBy::Column GroupBy::column(const H5::CompType& type, const std::string& member) {
+    const unsigned index = static_cast<unsigned>(type.getMemberIndex(member));
+    hid_t memberId = H5Tget_member_type(type.getId(), index);
+    H5::DataType memberType(memberId);
+    H5Tclose(memberId);
+    Column result;
+    result.offset = type.getMemberOffset(index);
+    result.size = memberType.getSize();
+    result.typeClass = memberType.getClass();
+    result.isSigned = result.typeClass == H5T_INTEGER && H5Tget_sign(memberType.getId()) == H5T_SGN_2;
+    result.variable = H5Tis_variable_str(memberType.getId()) > 0;
+    return result;
+}
+
+GroupBy::GroupBy(const H5::DataSet& dataset, const std::string& keyMember,
+                 const std::vector<AggregateSpec>& aggregates, unsigned threads)
+    : dataset(dataset), specs(aggregates), threads(threads ? threads : defaultThreads()),
+      memType(memoryType(dataset, keyMember, aggregates)), key(column(memType, keyMember)),
+      values(aggregates.size()), variable(hasVariableParts(memType.getId())), tables(this->threads) {
+    if (key.typeClass != H5T_STRING && key.typeClass != H5T_INTEGER) {
+        throw std::invalid_argument("GroupBy: key member " + keyMember + " must be a string or integer");
+    }
+    for (size_t a = 0; a < specs.size(); ++a) {
+        if (specs[a].op == Aggregate::Count) continue;
+        values[a] = column(memType, specs[a].member);
+        const Column& value = values[a];
+        const bool supported =
+            (value.typeClass == H5T_FLOAT && (value.size == sizeof(float) || value.size == sizeof(double))) ||
+            (value.typeClass == H5T_INTEGER && (value.size == 1 || value.size == 2 || value.size == 4 || value.size == 8));
+        if (!supported) {
+            throw std::invalid_argument("GroupBy: member " + specs[a].member + " is not a supported numeric type");
+        }
+    }
+    for (Table& table : tables) {
+        table.acc.resize(specs.size());
+    }
+}
+
+uint32_t GroupBy::Table::findOrInsert(const char* key, size_t length, uint64_t hash,
+                                      const std::vector<AggregateSpec>& specs) {
+    if ((keys.size() + 1) * 2 > slots.size()) {
+        std::vector<Slot> old(std::max<size_t>(64, slots.size() * 2), Slot{0, EMPTY_SLOT});
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.group == EMPTY_SLOT) continue;
+            size_t i = slot.hash & mask;
+            while (slots[i].group != EMPTY_SLOT) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Slot& slot = slots[i];
+        if (slot.group == EMPTY_SLOT) {
+            slot.hash = hash;
+            slot.group = static_cast<uint32_t>(keys.size());
+            keys.emplace_back(key, length);
+            rows.push_back(0);
+            for (size_t a = 0; a < specs.size(); ++a) {
+                acc[a].push_back(initialValue(specs[a].op));
+            }
+            return slot.group;
+        }
+        if (slot.hash == hash && keys[slot.group].size() == length &&
+            std::memcmp(keys[slot.group].data(), key, length) == 0) {
+            return slot.group;
+        }
+    }
+}
+
+const char* GroupBy::keyBytes(const unsigned char* record, size_t& length, uint64_t& scratch) const {
+    const unsigned char* field = record + key.offset;
+    if (key.typeClass == H5T_STRING) {
+        const char* text = reinterpret_cast<const char*>(field);
+        if (key.variable) {
+            text = load<const char*>(field);
+            if (!text) text = "";
+            length = std::strlen(text);
+        } else {
+            length = strnlen(text, key.size);
+        }
+        return text;
+    }
+    // Integers of any width become 8 bytes, sign- or zero-extended.
+    switch (key.size) {
+    case 1: scratch = key.isSigned ? static_cast<uint64_t>(load<int8_t>(field)) : load<uint8_t>(field); break;
+    case 2: scratch = key.isSigned ? static_cast<uint64_t>(load<int16_t>(field)) : load<uint16_t>(field); break;
+    case 4: scratch = key.isSigned ? static_cast<uint64_t>(load<int32_t>(field)) : load<uint32_t>(field); break;
+    default: scratch = load<uint64_t>(field); break;
+    }
+    length = sizeof(scratch);
+    return reinterpret_cast<const char*>(&scratch);
+}
+
+bool GroupBy::keyBefore(const std::string& a, const std::string& b) const {
+    if (key.typeClass != H5T_INTEGER) return a < b;
+    const uint64_t x = load<uint64_t>(reinterpret_cast<const unsigned char*>(a.data()));
+    const uint64_t y = load<uint64_t>(reinterpret_cast<const unsigned char*>(b.data()));
+    return key.isSigned ? static_cast<int64_t>(x) < static_cast<int64_t>(y) : x < y;
+}
+
+std::string GroupBy::keyText(const std::string& bytes) const {
+    if (key.typeClass != H5T_INTEGER) return bytes;
+    const uint64_t value = load<uint64_t>(reinterpret_cast<const unsigned char*>(bytes.data()));
+    return key.isSigned ? std::to_string(static_cast<int64_t>(value)) : std::to_string(value);
+}
+
+void GroupBy::aggregateSlice(Table& table, const unsigned char* records, size_t count) const {
+    const size_t stride = memType.getSize();
+    std::vector<uint32_t> groups(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = 0;
+        uint64_t scratch = 0;
+        const char* bytes = keyBytes(records + i * stride, length, scratch);
+        const uint32_t group = table.findOrInsert(bytes, length, hashBytes(bytes, length), specs);
+        ++table.rows[group];
+        groups[i] = group;
+    }
+    // One pass per accumulator column; the table no longer grows here.
+    for (size_t a = 0; a < specs.size(); ++a) {
+        if (specs[a].op == Aggregate::Count) continue;
+        const Column& value = values[a];
+        double* acc = table.acc[a].data();
+        const unsigned char* base = records + value.offset;
+        auto apply = [&](auto update) {
+            if (value.typeClass == H5T_FLOAT) {
+                if (value.size == sizeof(float)) {
+                    updateColumn<float>(acc, groups.data(), base, stride, count, update);
+                } else {
+                    updateColumn<double>(acc, groups.data(), base, stride, count, update);
+                }
+                return;
+            }
+            switch (value.size) {
+            case 1:
+                if (value.isSigned) updateColumn<int8_t>(acc, groups.data(), base, stride, count, update);
+                else updateColumn<uint8_t>(acc, groups.data(), base, stride, count, update);
+                break;
+            case 2:
+                if (value.isSigned) updateColumn<int16_t>(acc, groups.data(), base, stride, count, update);
+                else updateColumn<uint16_t>(acc, groups.data(), base, stride, count, update);
+                break;
+            case 4:
+                if (value.isSigned) updateColumn<int32_t>(acc, groups.data(), base, stride, count, update);
+                else updateColumn<uint32_t>(acc, groups.data(), base, stride, count, update);
+                break;
+            default:
+                if (value.isSigned) updateColumn<int64_t>(acc, groups.data(), base, stride, count, update);
+                else updateColumn<uint64_t>(acc, groups.data(), base, stride, count, update);
+                break;
+            }
+        };
+        switch (specs[a].op) {
+        case Aggregate::Sum:
+        case Aggregate::Mean:
+            apply([](double total, double v) { return total + v; });
+            break;
+        case Aggregate::Min:
+            apply([](double low, double v) { return std::min(low, v); });
+            break;
+        case Aggregate::Max:
+            apply([](double high, double v) { return std::max(high, v); });
+            break;
+        case Aggregate::Count:
+            break;
+        }
+    }
+}
+
+void GroupBy::consume(hsize_t start, hsize_t count) {
+    if (count == 0) return;
+    const size_t stride = memType.getSize();
+    batch.resize(count * stride);
+
+    auto begin = Clock::now();
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+    H5::DataSpace memSpace(1, &count);
+    dataset.read(batch.data(), memType, memSpace, fileSpace);
+    counters.readSeconds += secondsSince(begin);
+
+    begin = Clock::now();
+    const size_t slices = std::max<size_t>(1, std::min<size_t>(tables.size(), count / 1024));
+    parallelFor(slices, threads, [&](size_t s) {
+        const size_t lo = count * s / slices;
+        const size_t hi = count * (s + 1) / slices;
+        aggregateSlice(tables[s], batch.data() + lo * stride, hi - lo);
+    });
+    counters.aggregateSeconds += secondsSince(begin);
+
+    if (variable) {
+        reclaimVariable(memType, memSpace, batch.data());
+    }
+    counters.rows += count;
+    ++counters.batches;
+}
+
+void GroupBy::consumeAll(hsize_t batchRows) {
+    const hsize_t rows = dataset.getSpace().getSimpleExtentNpoints();
+    for (hsize_t start = 0; start < rows; start += batchRows) {
+        consume(start, std::min(batchRows, rows - start));
+    }
+}
+
+std::vector<GroupRow> GroupBy::result() {
+    auto begin = Clock::now();
+    Table merged = tables[0];
+    for (size_t t = 1; t < tables.size(); ++t) {
+        const Table& partial = tables[t];
+        for (size_t g = 0; g < partial.keys.size(); ++g) {
+            const std::string& bytes = partial.keys[g];
+            const uint32_t target =
+                merged.findOrInsert(bytes.data(), bytes.size(), hashBytes(bytes.data(), bytes.size()), specs);
+            merged.rows[target] += partial.rows[g];
+            for (size_t a = 0; a < specs.size(); ++a) {
+                double& acc = merged.acc[a][target];
+                const double value = partial.acc[a][g];
+                switch (specs[a].op) {
+                case Aggregate::Min: acc = std::min(acc, value); break;
+                case Aggregate::Max: acc = std::max(acc, value); break;
+                default: acc += value; break;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> order(merged.keys.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keyBefore(merged.keys[a], merged.keys[b]); });
+
+    std::vector<GroupRow> rows;
+    rows.reserve(order.size());
+    for (size_t g : order) {
+        GroupRow row;
+        row.key = keyText(merged.keys[g]);
+        row.rows = merged.rows[g];
+        for (size_t a = 0; a < specs.size(); ++a) {
+            switch (specs[a].op) {
+            case Aggregate::Count: row.values.push_back(static_cast<double>(row.rows)); break;
+            case Aggregate::Mean: row.values.push_back(merged.acc[a][g] / static_cast<double>(row.rows)); break;
+            default: row.values.push_back(merged.acc[a][g]); break;
+            }
+        }
+        rows.push_back(std::move(row));
+    }
+    counters.mergeSeconds += secondsSince(begin);
+    return rows;
+}
+
+} // namespace h5util
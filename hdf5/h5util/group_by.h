@@ -0,0 +1,120 @@
+// group_by.h
+#ifndef GROUP_BY_H
+#define GROUP_BY_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+enum class Aggregate {
+    Count, // rows per group; the member is ignored
+    Sum,
+    Min,
+    Max,
+    Mean
+};
+
+struct AggregateSpec {
+    Aggregate op;
+    std::string member; // numeric member, read as double
+};
+
+// One output row: the group key and one value per AggregateSpec, in order.
+struct GroupRow {
+    std::string key;         // integer keys are printed in decimal
+    hsize_t rows = 0;
+    std::vector<double> values;
+};
+
+struct GroupByStats {
+    hsize_t rows = 0;
+    size_t batches = 0;
+    double readSeconds = 0;
+    double aggregateSeconds = 0;
+    double mergeSeconds = 0;
+};
+
+// Streaming hash group-by over a one-dimensional compound dataset, e.g. mean
+// airQualityIndex and max temperature per siteName.
+//
+// Batches are read in the dataset's native type, which for files written on the
+// same platform needs no conversion at all; only when the compound carries
+// variable-length members that the query does not use are just the key and the
+// aggregated members read, so their strings are never allocated. Each batch is
+// split into one slice per thread; every slice feeds its own open-addressing
+// table (linear probing over {hash, group} slots, accumulators stored per
+// aggregate in group order). A slice first resolves the group of every row,
+// then updates each accumulator column in a tight loop specialised for the
+// member's type. result() merges the per-thread tables.
+class GroupBy {
+public:
+    static constexpr hsize_t DEFAULT_BATCH_ROWS = 64 * 1024;
+
+    GroupBy(const H5::DataSet& dataset, const std::string& keyMember, const std::vector<AggregateSpec>& aggregates,
+            unsigned threads = 0);
+
+    // Aggregate rows [start, start + count) of the dataset.
+    void consume(hsize_t start, hsize_t count);
+
+    // Aggregate the whole dataset, batchRows at a time.
+    void consumeAll(hsize_t batchRows = DEFAULT_BATCH_ROWS);
+
+    // Groups seen so far, ordered by key. Consuming more rows afterwards is allowed.
+    std::vector<GroupRow> result();
+
+    const GroupByStats& stats() const { return counters; }
+
+private:
+    // A key or value member within the memory type.
+    struct Column {
+        size_t offset = 0;
+        size_t size = 0;
+        H5T_class_t typeClass = H5T_NO_CLASS;
+        bool isSigned = false;
+        bool variable = false; // variable-length string
+    };
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t group; // EMPTY_SLOT: unused
+    };
+
+    struct Table {
+        std::vector<Slot> slots;       // power-of-two size, at most half full
+        std::vector<std::string> keys; // raw key bytes per group, integers as 8 bytes
+        std::vector<hsize_t> rows;
+        std::vector<std::vector<double>> acc; // per aggregate, per group
+
+        uint32_t findOrInsert(const char* key, size_t length, uint64_t hash, const std::vector<AggregateSpec>& specs);
+    };
+
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    static H5::CompType memoryType(const H5::DataSet& dataset, const std::string& keyMember,
+                                   const std::vector<AggregateSpec>& specs);
+    static Column column(const H5::CompType& type, const std::string& member);
+
+    void aggregateSlice(Table& table, const unsigned char* records, size_t count) const;
+    const char* keyBytes(const unsigned char* record, size_t& length, uint64_t& scratch) const;
+    bool keyBefore(const std::string& a, const std::string& b) const;
+    std::string keyText(const std::string& key) const;
+
+    H5::DataSet dataset;
+    std::vector<AggregateSpec> specs;
+    unsigned threads;
+    H5::CompType memType;          // native record, or key and aggregated members only
+    Column key;
+    std::vector<Column> values;    // per aggregate; unused for Count
+    bool variable;                 // memType holds variable-length data to reclaim
+    std::vector<Table> tables;     // one per slice
+    std::vector<unsigned char> batch;
+    GroupByStats counters;
+};
+
+} // namespace h5util
+
+#endif // GROUP_BY_H
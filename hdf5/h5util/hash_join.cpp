@@ -0,0 +1,375 @@
+// hash_join.cpp
+#include "hash_join.h"
+#include "append_buffer.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace h5util {
+
+namespace {
+
+constexpr uint32_t NO_ROW = UINT32_MAX;
+constexpr size_t ROW_OVERHEAD = 2 * sizeof(uint64_t) * 2 + sizeof(uint32_t); // slots at half load, chain link
+
+// The native type of a compound dataset. H5 wrappers take their own reference
+// to an id, so the ids they are built from are closed after wrapping.
+H5::CompType nativeCompType(const H5::DataSet& dataset) {
+    hid_t id = H5Tget_native_type(dataset.getCompType().getId(), H5T_DIR_ASCEND);
+    H5::CompType type(id);
+    H5Tclose(id);
+    return type;
+}
+
+H5::DataType memberType(const H5::CompType& type, unsigned index) {
+    hid_t id = H5Tget_member_type(type.getId(), index);
+    H5::DataType member(id);
+    H5Tclose(id);
+    return member;
+}
+
+// One input of the join, read in its native type.
+struct Side {
+    H5::DataSet dataset;
+    H5::CompType memType;
+    std::string keyName;
+    size_t keyOffset = 0;
+    size_t keySize = 0;
+    bool keyIsString = false;
+    bool keyIsVariable = false;
+    bool keySigned = false;
+    bool variable = false;
+    size_t recordSize = 0;
+    hsize_t rows = 0;
+
+    Side(const H5::DataSet& source, const std::string& key)
+        : dataset(source), memType(nativeCompType(source)), keyName(key) {
+        if (source.getSpace().getSimpleExtentNdims() != 1) {
+            throw std::invalid_argument("hashJoin: datasets must be one-dimensional");
+        }
+        const unsigned index = static_cast<unsigned>(memType.getMemberIndex(key));
+        const H5::DataType keyType = memberType(memType, index);
+        keyOffset = memType.getMemberOffset(index);
+        keySize = keyType.getSize();
+        if (keyType.getClass() == H5T_STRING) {
+            keyIsString = true;
+            keyIsVariable = H5Tis_variable_str(keyType.getId()) > 0;
+        } else if (keyType.getClass() == H5T_INTEGER) {
+            keySigned = H5Tget_sign(keyType.getId()) == H5T_SGN_2;
+        } else {
+            throw std::invalid_argument("hashJoin: key member " + key + " must be a string or integer");
+        }
+        variable = hasVariableParts(memType.getId());
+        recordSize = memType.getSize();
+        rows = source.getSpace().getSimpleExtentNpoints();
+    }
+
+    // The key as comparable bytes: string text, or the integer widened to 8 bytes.
+    const char* keyBytes(const unsigned char* record, size_t& length, uint64_t& scratch) const {
+        const unsigned char* field = record + keyOffset;
+        if (keyIsString) {
+            const char* text = reinterpret_cast<const char*>(field);
+            if (keyIsVariable) {
+                text = load<const char*>(field);
+                if (!text) text = "";
+                length = std::strlen(text);
+            } else {
+                length = strnlen(text, keySize);
+            }
+            return text;
+        }
+        switch (keySize) {
+        case 1: scratch = keySigned ? static_cast<uint64_t>(load<int8_t>(field)) : load<uint8_t>(field); break;
+        case 2: scratch = keySigned ? static_cast<uint64_t>(load<int16_t>(field)) : load<uint16_t>(field); break;
+        case 4: scratch = keySigned ? static_cast<uint64_t>(load<int32_t>(field)) : load<uint32_t>(field); break;
+        default: scratch = load<uint64_t>(field); break;
+        }
+        length = sizeof(scratch);
+        return reinterpret_cast<const char*>(&scratch);
+    }
+
+    void read(const H5::DataSet& from, hsize_t start, hsize_t count, void* records) const {
+        H5::DataSpace fileSpace = from.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+        H5::DataSpace memSpace(1, &count);
+        from.read(records, memType, memSpace, fileSpace);
+    }
+
+    void reclaim(void* records, hsize_t count) const {
+        if (!variable || count == 0) return;
+        reclaimVariable(memType, H5::DataSpace(1, &count), records);
+    }
+};
+
+// Output rows: the left native record, then the right one at rightOffset. The
+// memory type lists every member but the right key.
+struct OutputLayout {
+    size_t rightOffset = 0;
+    size_t size = 0;
+    H5::CompType memType;
+
+    OutputLayout(const Side& left, const Side& right, const std::string& prefix)
+        : rightOffset((left.recordSize + 7) & ~static_cast<size_t>(7)), size(rightOffset + right.recordSize),
+          memType(size) {
+        std::vector<std::string> names;
+        for (int i = 0; i < left.memType.getNmembers(); ++i) {
+            const unsigned m = static_cast<unsigned>(i);
+            const H5::DataType type = memberType(left.memType, m);
+            names.push_back(left.memType.getMemberName(m));
+            memType.insertMember(names.back(), left.memType.getMemberOffset(m), type);
+        }
+        for (int i = 0; i < right.memType.getNmembers(); ++i) {
+            const unsigned m = static_cast<unsigned>(i);
+            std::string name = right.memType.getMemberName(m);
+            if (name == right.keyName) continue;
+            while (std::find(names.begin(), names.end(), name) != names.end()) name = prefix + name;
+            const H5::DataType type = memberType(right.memType, m);
+            names.push_back(name);
+            memType.insertMember(name, rightOffset + right.memType.getMemberOffset(m), type);
+        }
+    }
+
+    // The memory type without the padding between and inside the two records.
+    H5::CompType fileType() const {
+        hid_t copy = H5Tcopy(memType.getId());
+        H5::CompType packed(copy);
+        H5Tclose(copy);
+        packed.pack();
+        return packed;
+    }
+};
+
+// Build side records with an open-addressing index; equal keys form a chain.
+class BuildTable {
+public:
+    BuildTable(const Side& side, const unsigned char* records, size_t count)
+        : side(side), records(records), next(count, NO_ROW) {
+        size_t capacity = 16;
+        while (capacity < count * 2) capacity *= 2;
+        slots.assign(capacity, Slot{0, NO_ROW});
+        // Insert back to front so each chain lists its rows in input order.
+        for (size_t r = count; r-- > 0;) {
+            size_t length = 0;
+            uint64_t scratch = 0;
+            const char* key = side.keyBytes(row(r), length, scratch);
+            const uint64_t hash = hashBytes(key, length);
+            Slot& slot = slots[findSlot(key, length, hash)];
+            slot.hash = hash;
+            next[r] = slot.head;
+            slot.head = static_cast<uint32_t>(r);
+        }
+    }
+
+    template <typename Fn>
+    void forEachMatch(const char* key, size_t length, uint64_t hash, Fn fn) const {
+        const Slot& slot = slots[findSlot(key, length, hash)];
+        for (uint32_t r = slot.head; r != NO_ROW; r = next[r]) fn(row(r));
+    }
+
+private:
+    struct Slot {
+        uint64_t hash;
+        uint32_t head;
+    };
+
+    const unsigned char* row(size_t r) const { return records + r * side.recordSize; }
+
+    // The slot holding key, or the empty slot where it belongs.
+    size_t findSlot(const char* key, size_t length, uint64_t hash) const {
+        const size_t mask = slots.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.head == NO_ROW) return i;
+            if (slot.hash != hash) continue;
+            size_t otherLength = 0;
+            uint64_t scratch = 0;
+            const char* other = side.keyBytes(row(slot.head), otherLength, scratch);
+            if (otherLength == length && std::memcmp(other, key, length) == 0) return i;
+        }
+    }
+
+    const Side& side;
+    const unsigned char* records;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> next;
+};
+
+class Joiner {
+public:
+    Joiner(const Side& build, const Side& probe, bool buildIsLeft, const OutputLayout& layout, AppendBuffer& out,
+           const JoinOptions& options, JoinStats& stats)
+        : build(build), probe(probe), buildIsLeft(buildIsLeft), layout(layout), out(out), options(options),
+          stats(stats) {}
+
+    // Joins the build rows of buildSource with the probe rows of probeSource.
+    void run(const H5::DataSet& buildSource, const H5::DataSet& probeSource) {
+        auto begin = Clock::now();
+        const hsize_t buildRows = buildSource.getSpace().getSimpleExtentNpoints();
+        if (buildRows >= NO_ROW) {
+            throw std::length_error("hashJoin: build partition exceeds 2^32 rows");
+        }
+        std::vector<unsigned char> buildRecords(buildRows * build.recordSize);
+        if (buildRows > 0) build.read(buildSource, 0, buildRows, buildRecords.data());
+        const BuildTable table(build, buildRecords.data(), static_cast<size_t>(buildRows));
+        stats.buildSeconds += secondsSince(begin);
+
+        begin = Clock::now();
+        const hsize_t probeRows = probeSource.getSpace().getSimpleExtentNpoints();
+        std::vector<unsigned char> batch;
+        const unsigned threads = options.threads ? options.threads : defaultThreads();
+        std::vector<std::vector<unsigned char>> slices(threads);
+        for (hsize_t start = 0; start < probeRows; start += options.batchRows) {
+            const hsize_t count = std::min(options.batchRows, probeRows - start);
+            batch.resize(count * probe.recordSize);
+            probe.read(probeSource, start, count, batch.data());
+
+            const size_t pieces = std::max<size_t>(1, std::min<size_t>(threads, count / 1024));
+            parallelFor(pieces, threads, [&](size_t s) {
+                std::vector<unsigned char>& output = slices[s];
+                output.clear();
+                for (size_t i = count * s / pieces; i < count * (s + 1) / pieces; ++i) {
+                    const unsigned char* probeRecord = &batch[i * probe.recordSize];
+                    size_t length = 0;
+                    uint64_t scratch = 0;
+                    const char* key = probe.keyBytes(probeRecord, length, scratch);
+                    table.forEachMatch(key, length, hashBytes(key, length), [&](const unsigned char* buildRecord) {
+                        const size_t at = output.size();
+                        output.resize(at + layout.size);
+                        const unsigned char* leftRecord = buildIsLeft ? buildRecord : probeRecord;
+                        const unsigned char* rightRecord = buildIsLeft ? probeRecord : buildRecord;
+                        std::memcpy(&output[at], leftRecord, buildIsLeft ? build.recordSize : probe.recordSize);
+                        std::memcpy(&output[at + layout.rightOffset], rightRecord,
+                                    buildIsLeft ? probe.recordSize : build.recordSize);
+                    });
+                }
+            });
+            for (size_t s = 0; s < pieces; ++s) {
+                const size_t rows = slices[s].size() / layout.size;
+                out.append(slices[s].data(), rows);
+                stats.outputRows += rows;
+            }
+            // Buffered output rows may point at this batch's strings.
+            if (probe.variable) out.flush();
+            probe.reclaim(batch.data(), count);
+        }
+        if (build.variable) out.flush();
+        build.reclaim(buildRecords.data(), buildRows);
+        stats.probeSeconds += secondsSince(begin);
+    }
+
+private:
+    const Side& build;
+    const Side& probe;
+    bool buildIsLeft;
+    const OutputLayout& layout;
+    AppendBuffer& out;
+    const JoinOptions& options;
+    JoinStats& stats;
+};
+
+// Splits side into partitions datasets of the scratch file by the high hash bits.
+std::vector<H5::DataSet> partition(const Side& side, H5::H5File& scratch, const std::string& prefix,
+                                   size_t partitions, const JoinOptions& options) {
+    std::vector<H5::DataSet> datasets;
+    std::vector<std::unique_ptr<AppendBuffer>> writers;
+    FlushPolicy policy;
+    policy.maxBytes = std::max<size_t>(64 * 1024, options.memoryBudget / (4 * partitions));
+    const hsize_t chunkRows = std::max<size_t>(1, 64 * 1024 / side.recordSize);
+    for (size_t p = 0; p < partitions; ++p) {
+        datasets.push_back(
+            createAppendableDataSet(scratch, prefix + std::to_string(p), side.memType, {}, chunkRows));
+        writers.emplace_back(new AppendBuffer(datasets.back(), side.memType, policy));
+    }
+    int shift = 64;
+    for (size_t p = partitions; p > 1; p >>= 1) --shift;
+
+    std::vector<unsigned char> batch;
+    for (hsize_t start = 0; start < side.rows; start += options.batchRows) {
+        const hsize_t count = std::min(options.batchRows, side.rows - start);
+        batch.resize(count * side.recordSize);
+        side.read(side.dataset, start, count, batch.data());
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* record = &batch[i * side.recordSize];
+            size_t length = 0;
+            uint64_t scratchKey = 0;
+            const char* key = side.keyBytes(record, length, scratchKey);
+            const size_t p = partitions > 1 ? static_cast<size_t>(hashBytes(key, length) >> shift) : 0;
+            writers[p]->append(record);
+        }
+        if (side.variable) {
+            for (auto& writer : writers) writer->flush();
+            side.reclaim(batch.data(), count);
+        }
+    }
+    for (auto& writer : writers) writer->close();
+    return datasets;
+}
+
+} // namespace
+
+JoinStats hashJoin(const H5::DataSet& left, const std::string& leftKey, const H5::DataSet& right,
+                   const std::string& rightKey, H5::Group& destParent, const std::string& name,
+                   const JoinOptions& options) {
+    const Side leftSide(left, leftKey);
+    const Side rightSide(right, rightKey);
+    if (leftSide.keyIsString != rightSide.keyIsString) {
+        throw std::invalid_argument("hashJoin: cannot join a string key with an integer key");
+    }
+    if (options.batchRows == 0) {
+        throw std::invalid_argument("hashJoin: batchRows must be positive");
+    }
+
+    JoinStats stats;
+    stats.buildIsLeft = leftSide.rows * leftSide.recordSize <= rightSide.rows * rightSide.recordSize;
+    const Side& build = stats.buildIsLeft ? leftSide : rightSide;
+    const Side& probe = stats.buildIsLeft ? rightSide : leftSide;
+    stats.buildRows = build.rows;
+    stats.probeRows = probe.rows;
+
+    const OutputLayout layout(leftSide, rightSide, options.collisionPrefix);
+    H5::DataSet dest = createAppendableDataSet(destParent, name, layout.fileType(), {},
+                                               std::max<size_t>(1, 1024 * 1024 / layout.size));
+    FlushPolicy policy;
+    policy.maxBytes = std::max<size_t>(1024 * 1024, options.memoryBudget / 16);
+    AppendBuffer out(dest, layout.memType, policy);
+    Joiner joiner(build, probe, stats.buildIsLeft, layout, out, options, stats);
+
+    const size_t half = std::max<size_t>(1, options.memoryBudget / 2);
+    const hsize_t buildBytes = build.rows * (build.recordSize + ROW_OVERHEAD);
+    if (buildBytes <= half) {
+        joiner.run(build.dataset, probe.dataset);
+        out.close();
+        return stats;
+    }
+
+    // Grace join: twice the partitions strictly needed, for slack against skew.
+    stats.partitions = 2;
+    while (stats.partitions < 2 * ((buildBytes + half - 1) / half)) stats.partitions *= 2;
+    const std::string spillName =
+        options.spillFile.empty() ? destParent.getFileName() + ".join.tmp" : options.spillFile;
+    try {
+        H5::H5File scratch(spillName, H5F_ACC_TRUNC);
+        auto begin = Clock::now();
+        const std::vector<H5::DataSet> buildParts = partition(build, scratch, "build", stats.partitions, options);
+        const std::vector<H5::DataSet> probeParts = partition(probe, scratch, "probe", stats.partitions, options);
+        stats.partitionSeconds = secondsSince(begin);
+        for (size_t p = 0; p < stats.partitions; ++p) {
+            joiner.run(buildParts[p], probeParts[p]);
+        }
+        out.close();
+    } catch (...) {
+        std::remove(spillName.c_str());
+        throw;
+    }
+    std::remove(spillName.c_str());
+    return stats;
+}
+
+} // namespace h5util
@@ -0,0 +1,53 @@
+// hash_join.h
+#ifndef HASH_JOIN_H
+#define HASH_JOIN_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <string>
+
+namespace h5util {
+
+struct JoinOptions {
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+    static constexpr hsize_t DEFAULT_BATCH_ROWS = 64 * 1024;
+
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET; // build table and buffers, not counting vlen payloads
+    hsize_t batchRows = DEFAULT_BATCH_ROWS;      // probe rows per read
+    unsigned threads = 0;                        // probe workers, 0: hardware concurrency
+    std::string spillFile;                       // partitions; empty: "<dest file>.join.tmp"
+    std::string collisionPrefix = "right_";      // for right members named like a left member
+};
+
+struct JoinStats {
+    bool buildIsLeft = false;
+    hsize_t buildRows = 0;
+    hsize_t probeRows = 0;
+    hsize_t outputRows = 0;
+    size_t partitions = 0;       // 0: the build side fit in memory
+    double partitionSeconds = 0;
+    double buildSeconds = 0;
+    double probeSeconds = 0;     // including output writes
+};
+
+// Inner equi-join of two one-dimensional compound datasets, which may live in
+// different files, on leftKey = rightKey (both string members, fixed or
+// variable, or both integer members of any width). The result is written to a
+// new dataset name under destParent with every left member followed by every
+// right member except the right key; right members whose names are taken get
+// collisionPrefix.
+//
+// The smaller side (by stored bytes) is read into an open-addressing table with
+// rows of equal key chained in input order; the other side is probed in
+// batches, split across the thread pool and appended in input order. When the
+// build side does not fit half the memory budget both sides are first hash
+// partitioned into a scratch file (Grace join) and joined partition by
+// partition. A partition that is still too large, because of one very frequent
+// key, is joined anyway.
+JoinStats hashJoin(const H5::DataSet& left, const std::string& leftKey, const H5::DataSet& right,
+                   const std::string& rightKey, H5::Group& destParent, const std::string& name,
+                   const JoinOptions& options = JoinOptions());
+
+} // namespace h5util
+
+#endif // HASH_JOIN_H
@@ -0,0 +1,102 @@
+// header_report.cpp
+#include "header_report.h"
+
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+#if H5_VERSION_GE(1, 12, 0)
+using ObjectInfo = H5O_info2_t;
+#else
+using ObjectInfo = H5O_info_t;
+#endif
+
+struct VisitState {
+    hid_t root;
+    std::vector<HeaderInfo>* report;
+};
+
+herr_t visitObject(hid_t root, const char* name, const ObjectInfo* info, void* data) {
+    VisitState* state = static_cast<VisitState*>(data);
+    hid_t object = H5Oopen(root, name, H5P_DEFAULT);
+    if (object < 0) return -1;
+    try {
+        HeaderInfo header = headerInfo(object, name);
+        header.type = info->type;
+        state->report->push_back(header);
+    } catch (...) {
+        H5Oclose(object);
+        return -1;
+    }
+    H5Oclose(object);
+    return 0;
+}
+
+const char* typeName(H5O_type_t type) {
+    switch (type) {
+    case H5O_TYPE_GROUP:
+        return "group";
+    case H5O_TYPE_DATASET:
+        return "dataset";
+    case H5O_TYPE_NAMED_DATATYPE:
+        return "datatype";
+    default:
+        return "object";
+    }
+}
+
+} // namespace
+
+HeaderInfo headerInfo(hid_t object, const std::string& path) {
+    HeaderInfo header;
+    header.path = path;
+#if H5_VERSION_GE(1, 12, 0)
+    H5O_native_info_t info;
+    if (H5Oget_native_info(object, &info, H5O_NATIVE_INFO_HDR) < 0) {
+        throw H5::ObjHeaderIException("headerInfo", "H5Oget_native_info failed for " + path);
+    }
+#else
+    H5O_info_t info;
+    if (H5Oget_info2(object, &info, H5O_INFO_HDR) < 0) {
+        throw H5::ObjHeaderIException("headerInfo", "H5Oget_info2 failed for " + path);
+    }
+#endif
+    header.chunks = info.hdr.nchunks;
+    header.messages = info.hdr.nmesgs;
+    header.totalBytes = info.hdr.space.total;
+    header.freeBytes = info.hdr.space.free;
+    return header;
+}
+
+std::vector<HeaderInfo> headerReport(const H5::Group& root) {
+    std::vector<HeaderInfo> report;
+    VisitState state{root.getId(), &report};
+#if H5_VERSION_GE(1, 12, 0)
+    herr_t status = H5Ovisit3(root.getId(), H5_INDEX_NAME, H5_ITER_INC, visitObject, &state, H5O_INFO_BASIC);
+#else
+    herr_t status = H5Ovisit2(root.getId(), H5_INDEX_NAME, H5_ITER_INC, visitObject, &state, H5O_INFO_BASIC);
+#endif
+    if (status < 0) {
+        throw H5::ObjHeaderIException("headerReport", "H5Ovisit failed");
+    }
+    return report;
+}
+
+void printHeaderReport(std::ostream& out, const std::vector<HeaderInfo>& report, bool onlySplit) {
+    size_t split = 0;
+    size_t continuations = 0;
+    for (const HeaderInfo& header : report) {
+        continuations += header.continuations();
+        if (header.continuations() > 0) ++split;
+        if (onlySplit && header.continuations() == 0) continue;
+        out << typeName(header.type) << " " << header.path << ": " << header.chunks << " chunk(s), "
+            << header.continuations() << " continuation(s), " << header.messages << " messages, "
+            << header.totalBytes << " bytes (" << header.freeBytes << " free)\n";
+    }
+    out << report.size() << " objects, " << split << " with continuation blocks, " << continuations
+        << " continuation blocks in total\n";
+}
+
+} // namespace h5util
@@ -0,0 +1,38 @@
+// header_report.h
+#ifndef HEADER_REPORT_H
+#define HEADER_REPORT_H
+
+#include <H5Cpp.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+// Object header layout of one object. Every chunk after the first is reached
+// through a continuation message, i.e. one more seek for a reader.
+struct HeaderInfo {
+    std::string path;
+    H5O_type_t type = H5O_TYPE_UNKNOWN;
+    unsigned chunks = 0;
+    unsigned messages = 0;
+    hsize_t totalBytes = 0; // header size including all chunks
+    hsize_t freeBytes = 0;  // unused (null message) space
+
+    unsigned continuations() const { return chunks > 0 ? chunks - 1 : 0; }
+};
+
+// Header layout of the object at loc_id, reported under path.
+HeaderInfo headerInfo(hid_t object, const std::string& path);
+
+// Header layout of every object reachable from root (root included), visited
+// once each even when hard-linked several times.
+std::vector<HeaderInfo> headerReport(const H5::Group& root);
+
+// One line per object plus a summary of continuation blocks. With onlySplit,
+// objects whose header is a single chunk are left out of the listing.
+void printHeaderReport(std::ostream& out, const std::vector<HeaderInfo>& report, bool onlySplit = false);
+
+} // namespace h5util
+
+#endif // HEADER_REPORT_H
@@ -0,0 +1,194 @@
+// ingest_writer.cpp
+#include "ingest_writer.h"
+#include "append_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace h5util {
+
+H5::DataSet createIngestDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& fileType,
+                                const std::vector<hsize_t>& rowDims, const IngestOptions& options) {
+    H5::DSetCreatPropList dcpl;
+    dcpl.setAllocTime(H5D_ALLOC_TIME_EARLY);
+    dcpl.setFillTime(H5D_FILL_TIME_NEVER);
+    return createAppendableDataSet(parent, name, fileType, rowDims, options.chunkRows, dcpl);
+}
+
+IngestWriter::IngestWriter(const H5::DataSet& dataset, const H5::DataType& memType, const IngestOptions& options)
+    : dataset(dataset), memType(memType), options(options), rank(0), rowBytes(0), allocatedRows(0),
+      stopping(false), closed(false) {
+    if (options.blockRows == 0) {
+        throw std::invalid_argument("IngestWriter: blockRows must be positive");
+    }
+    H5::DataSpace space = dataset.getSpace();
+    rank = space.getSimpleExtentNdims();
+    std::vector<hsize_t> dims(rank), maxDims(rank);
+    space.getSimpleExtentDims(dims.data(), maxDims.data());
+    if (rank < 1 || maxDims[0] != H5S_UNLIMITED) {
+        throw std::invalid_argument("IngestWriter: dataset must be unlimited along dimension 0");
+    }
+    if (dims[0] != 0) {
+        throw std::invalid_argument("IngestWriter: dataset must start empty");
+    }
+    rowDims.assign(dims.begin() + 1, dims.end());
+    rowBytes = memType.getSize();
+    for (hsize_t d : rowDims) rowBytes *= d;
+
+    // Reserve the first extend step before any record arrives, on the caller's thread.
+    allocatedRows = options.extendAheadRows;
+    dims[0] = allocatedRows;
+    this->dataset.extend(dims.data());
+    ++counters.extendCalls;
+
+    const size_t blockBytes = static_cast<size_t>(options.blockRows) * rowBytes;
+    for (size_t i = 0; i < std::max<size_t>(options.poolBlocks, 2); ++i) {
+        auto block = std::make_unique<Block>();
+        block->data.resize(blockBytes);
+        pool.push_back(std::move(block));
+        ++counters.blocksAllocated;
+    }
+    active = std::move(pool.back());
+    pool.pop_back();
+
+    worker = std::thread(&IngestWriter::run, this);
+}
+
+IngestWriter::~IngestWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void IngestWriter::append(const void* record) {
+    if (closed) {
+        throw std::logic_error("IngestWriter: append after close");
+    }
+    if (!active) {
+        throw std::runtime_error("IngestWriter: background writer failed");
+    }
+    if (active->rows == 0 && options.maxAge.count() > 0) {
+        activeSince = std::chrono::steady_clock::now();
+    }
+    std::memcpy(active->data.data() + active->rows * rowBytes, record, rowBytes);
+    ++active->rows;
+    if (active->rows == options.blockRows) {
+        handOff(true);
+    } else if (options.maxAge.count() > 0 && std::chrono::steady_clock::now() - activeSince >= options.maxAge) {
+        handOff(true);
+    }
+}
+
+void IngestWriter::handOff(bool acquireNext) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (error) {
+        // Drop the staged rows so the writer stays failed: append() then throws
+        // instead of copying past the end of the full block.
+        active.reset();
+        std::rethrow_exception(error);
+    }
+    queue.push_back(std::move(active));
+    workReady.notify_one();
+    if (!acquireNext) return;
+
+    if (pool.empty() && counters.blocksAllocated < options.maxBlocks) {
+        auto block = std::make_unique<Block>();
+        block->data.resize(static_cast<size_t>(options.blockRows) * rowBytes);
+        ++counters.blocksAllocated;
+        active = std::move(block);
+        return;
+    }
+    if (pool.empty()) {
+        ++counters.producerWaits;
+        blockFree.wait(lock, [this] { return !pool.empty() || error; });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    active = std::move(pool.back());
+    pool.pop_back();
+}
+
+void IngestWriter::run() {
+    while (true) {
+        std::unique_ptr<Block> block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this] { return !queue.empty() || stopping; });
+            if (queue.empty()) return;
+            block = std::move(queue.front());
+            queue.pop_front();
+        }
+        try {
+            writeBlock(*block);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            blockFree.notify_all();
+            return;
+        }
+        block->rows = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        pool.push_back(std::move(block));
+        blockFree.notify_one();
+    }
+}
+
+void IngestWriter::writeBlock(const Block& block) {
+    if (block.rows == 0) return;
+    std::vector<hsize_t> dims(rank), start(rank, 0), count(rank);
+    for (int d = 1; d < rank; ++d) {
+        dims[d] = count[d] = rowDims[d - 1];
+    }
+    const hsize_t needed = counters.rowsWritten + block.rows;
+    if (needed > allocatedRows) {
+        allocatedRows = std::max(needed, allocatedRows + options.extendAheadRows);
+        dims[0] = allocatedRows;
+        dataset.extend(dims.data());
+        ++counters.extendCalls;
+    }
+    start[0] = counters.rowsWritten;
+    count[0] = block.rows;
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, count.data(), start.data());
+    H5::DataSpace memSpace(rank, count.data());
+    dataset.write(block.data.data(), memType, memSpace, fileSpace);
+    ++counters.writeCalls;
+    counters.rowsWritten = needed;
+}
+
+void IngestWriter::close() {
+    if (closed) return;
+    closed = true;
+    std::exception_ptr handOffError;
+    if (active && active->rows > 0) {
+        try {
+            handOff(false);
+        } catch (...) {
+            handOffError = std::current_exception();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_one();
+    worker.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if (handOffError) {
+        std::rethrow_exception(handOffError);
+    }
+
+    // Trim the extend-ahead tail so readers see only the written rows.
+    std::vector<hsize_t> dims(rank);
+    dims[0] = counters.rowsWritten;
+    for (int d = 1; d < rank; ++d) dims[d] = rowDims[d - 1];
+    dataset.extend(dims.data());
+}
+
+} // namespace h5util
@@ -0,0 +1,100 @@
+// ingest_writer.h
+#ifndef INGEST_WRITER_H
+#define INGEST_WRITER_H
+
+#include <H5Cpp.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace h5util {
+
+struct IngestOptions {
+    hsize_t chunkRows = 4096;
+    hsize_t blockRows = 4096;             // records handed to the background thread at once
+    hsize_t extendAheadRows = 1 << 20;    // dataset growth step, allocated early
+    size_t poolBlocks = 8;                // staging blocks allocated up front
+    size_t maxBlocks = 64;                // beyond this the producer waits for the writer
+    std::chrono::milliseconds maxAge{0};  // hand off a partial block once it is this old
+};
+
+struct IngestStats {
+    hsize_t rowsWritten = 0;
+    size_t extendCalls = 0;
+    size_t writeCalls = 0;
+    size_t blocksAllocated = 0;
+    size_t producerWaits = 0; // times append() had to wait for a free block
+};
+
+// Creates a chunked dataset, unlimited along dimension 0, with H5D_ALLOC_TIME_EARLY
+// and H5D_FILL_TIME_NEVER so that extending it allocates space up front and never
+// writes fill values.
+H5::DataSet createIngestDataSet(H5::Group& parent, const H5std_string& name, const H5::DataType& fileType,
+                                const std::vector<hsize_t>& rowDims, const IngestOptions& options = IngestOptions());
+
+// Low tail-latency appender. append() only copies the record into a preallocated
+// staging block; full blocks are queued to a background thread that does every
+// HDF5 call (extending in extendAheadRows steps, hyperslab writes). close() drains
+// the queue and trims the dataset to the rows actually written.
+//
+// The serial HDF5 library is not thread safe: while an IngestWriter is open the
+// owning thread must not make other HDF5 calls.
+class IngestWriter {
+public:
+    IngestWriter(const H5::DataSet& dataset, const H5::DataType& memType, const IngestOptions& options = IngestOptions());
+    ~IngestWriter();
+
+    IngestWriter(const IngestWriter&) = delete;
+    IngestWriter& operator=(const IngestWriter&) = delete;
+
+    void append(const void* record);
+
+    // Drain, trim the extent and join the writer thread. Rethrows any error the
+    // background thread hit. Called by the destructor.
+    void close();
+
+    // Valid after close().
+    const IngestStats& stats() const { return counters; }
+
+private:
+    struct Block {
+        std::vector<unsigned char> data;
+        size_t rows = 0;
+    };
+
+    void handOff(bool acquireNext);
+    void run();
+    void writeBlock(const Block& block);
+
+    H5::DataSet dataset;
+    H5::DataType memType;
+    IngestOptions options;
+    int rank;
+    std::vector<hsize_t> rowDims;
+    size_t rowBytes;
+    hsize_t allocatedRows;
+
+    std::unique_ptr<Block> active;
+    std::chrono::steady_clock::time_point activeSince;
+
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable blockFree;
+    std::deque<std::unique_ptr<Block>> queue;
+    std::vector<std::unique_ptr<Block>> pool;
+    bool stopping;
+    bool closed;
+    std::exception_ptr error;
+    IngestStats counters;
+    std::thread worker;
+};
+
+} // namespace h5util
+
+#endif // INGEST_WRITER_H
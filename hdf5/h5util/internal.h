@@ -0,0 +1,151 @@
+// internal.h
+#ifndef INTERNAL_H
+#define INTERNAL_H
+
+// Helpers shared by the h5util sources; not meant for the example programs.
+// Header-only so that no build task has to link another file for them.
+
+#include <H5Cpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Unaligned read of a T out of a record buffer.
+template <typename T>
+T load(const unsigned char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// 64-bit FNV-1a over the bytes.
+inline uint64_t fnv1a(const char* bytes, size_t length) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// FNV-1a with a final avalanche, so the low bits used for probing and the high
+// bits used for partitioning are both well mixed.
+inline uint64_t hashBytes(const char* bytes, size_t length) {
+    uint64_t hash = fnv1a(bytes, length);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// True if values of the type own memory HDF5 allocates on read: variable-length
+// strings or sequences, also inside compounds and arrays.
+inline bool hasVariableParts(hid_t type) {
+    if (H5Tis_variable_str(type) > 0) return true;
+    const H5T_class_t typeClass = H5Tget_class(type);
+    if (typeClass == H5T_VLEN) return true;
+    if (typeClass == H5T_COMPOUND) {
+        const int members = H5Tget_nmembers(type);
+        for (int i = 0; i < members; ++i) {
+            hid_t member = H5Tget_member_type(type, static_cast<unsigned>(i));
+            const bool variable = hasVariableParts(member);
+            H5Tclose(member);
+            if (variable) return true;
+        }
+    } else if (typeClass == H5T_ARRAY) {
+        hid_t super = H5Tget_super(type);
+        const bool variable = hasVariableParts(super);
+        H5Tclose(super);
+        return variable;
+    }
+    return false;
+}
+
+// Frees the variable-length parts of the elements of space read into buffer.
+inline void reclaimVariable(const H5::DataType& type, const H5::DataSpace& space, void* buffer) {
+#if H5_VERSION_GE(1, 12, 0)
+    H5Treclaim(type.getId(), space.getId(), H5P_DEFAULT, buffer);
+#else
+    H5Dvlen_reclaim(type.getId(), space.getId(), H5P_DEFAULT, buffer);
+#endif
+}
+
+inline std::string memberName(hid_t type, unsigned index) {
+    char* name = H5Tget_member_name(type, index);
+    std::string result(name);
+    H5free_memory(name);
+    return result;
+}
+
+// The native type for reading fileType, except that fixed-point integers keep
+// their file type (in native byte order) so the fraction bits are not shifted
+// away. Compounds, arrays and sequences are rebuilt element by element for that
+// reason. The caller closes the returned id.
+inline hid_t memoryType(hid_t fileType) {
+    switch (H5Tget_class(fileType)) {
+    case H5T_INTEGER:
+        if (H5Tget_offset(fileType) > 0) {
+            hid_t type = H5Tcopy(fileType);
+            H5Tset_order(type, H5Tget_order(H5T_NATIVE_INT));
+            return type;
+        }
+        break;
+    case H5T_COMPOUND: {
+        const unsigned members = static_cast<unsigned>(H5Tget_nmembers(fileType));
+        std::vector<hid_t> types;
+        std::vector<size_t> offsets;
+        size_t size = 0;
+        for (unsigned i = 0; i < members; ++i) {
+            hid_t member = H5Tget_member_type(fileType, i);
+            types.push_back(memoryType(member));
+            H5Tclose(member);
+            size_t align = 1;
+            while (align < 8 && align * 2 <= H5Tget_size(types.back())) align *= 2;
+            offsets.push_back((size + align - 1) / align * align);
+            size = offsets.back() + H5Tget_size(types.back());
+        }
+        hid_t type = H5Tcreate(H5T_COMPOUND, std::max<size_t>(size, 1));
+        for (unsigned i = 0; i < members; ++i) {
+            H5Tinsert(type, memberName(fileType, i).c_str(), offsets[i], types[i]);
+            H5Tclose(types[i]);
+        }
+        return type;
+    }
+    case H5T_ARRAY: {
+        hid_t super = H5Tget_super(fileType);
+        hid_t element = memoryType(super);
+        H5Tclose(super);
+        hsize_t dims[H5S_MAX_RANK];
+        const int rank = H5Tget_array_dims2(fileType, dims);
+        hid_t type = H5Tarray_create2(element, static_cast<unsigned>(rank), dims);
+        H5Tclose(element);
+        return type;
+    }
+    case H5T_VLEN: {
+        hid_t super = H5Tget_super(fileType);
+        hid_t element = memoryType(super);
+        H5Tclose(super);
+        hid_t type = H5Tvlen_create(element);
+        H5Tclose(element);
+        return type;
+    }
+    default:
+        break;
+    }
+    return H5Tget_native_type(fileType, H5T_DIR_ASCEND);
+}
+
+} // namespace h5util
+
+#endif // INTERNAL_H
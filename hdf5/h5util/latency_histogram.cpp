@@ -0,0 +1,104 @@
+// latency_histogram.cpp
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+int log2Floor(uint64_t value) {
+    return 63 - __builtin_clzll(value);
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram(int precisionBits)
+    : precisionBits(precisionBits), subBucketCount(uint64_t(1) << precisionBits),
+      total(0), minValue(std::numeric_limits<uint64_t>::max()), maxValue(0), sum(0) {
+    if (precisionBits < 2 || precisionBits > 16) {
+        throw std::invalid_argument("LatencyHistogram: precisionBits must be in [2, 16]");
+    }
+    // Values below subBucketCount are exact; every higher power of two gets
+    // subBucketCount / 2 buckets.
+    counts.assign(subBucketCount + static_cast<size_t>(64 - precisionBits) * (subBucketCount / 2), 0);
+}
+
+size_t LatencyHistogram::indexOf(uint64_t value) const {
+    if (value < subBucketCount) return static_cast<size_t>(value);
+    const int shift = log2Floor(value) - precisionBits + 1;
+    const uint64_t sub = value >> shift; // in [subBucketCount / 2, subBucketCount)
+    return static_cast<size_t>(subBucketCount + (shift - 1) * (subBucketCount / 2) + (sub - subBucketCount / 2));
+}
+
+uint64_t LatencyHistogram::highestEquivalent(size_t index) const {
+    if (index < subBucketCount) return index;
+    const uint64_t rel = index - subBucketCount;
+    const int shift = static_cast<int>(rel / (subBucketCount / 2)) + 1;
+    const uint64_t sub = rel % (subBucketCount / 2) + subBucketCount / 2;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    ++counts[indexOf(value)];
+    ++total;
+    sum += value;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.precisionBits != precisionBits) {
+        throw std::invalid_argument("LatencyHistogram: cannot merge histograms of different precision");
+    }
+    for (size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+    total += other.total;
+    sum += other.sum;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    minValue = std::numeric_limits<uint64_t>::max();
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+    target = std::max<uint64_t>(1, std::min(target, total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) return std::min(highestEquivalent(i), maxValue);
+    }
+    return maxValue;
+}
+
+void LatencyHistogram::print(std::ostream& out, const std::string& label, double unitDivisor,
+                             const std::string& unit) const {
+    static const double levels[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << label << " (" << total << " samples, " << unit << ")\n";
+    out << "  min " << min() / unitDivisor << "  mean " << mean() / unitDivisor << "\n";
+    for (double level : levels) {
+        std::string name = "p" + std::to_string(level);
+        name.erase(name.find_last_not_of('0') + 1);
+        if (name.back() == '.') name.pop_back();
+        out << "  " << std::setw(7) << std::left << name << std::right << " " << percentile(level) / unitDivisor
+            << "\n";
+    }
+    out << "  " << std::setw(7) << std::left << "max" << std::right << " " << max() / unitDivisor << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace h5util
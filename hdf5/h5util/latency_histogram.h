@@ -0,0 +1,51 @@
+// latency_histogram.h
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+// Log-linear histogram in the style of HdrHistogram. Values are bucketed by their
+// power of two and then by 2^(precisionBits-1) linear sub-buckets, so recorded
+// values keep a relative error below 2^-(precisionBits-1) over the full 64-bit
+// range with a fixed, small footprint. Recording is O(1) and allocation free.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(int precisionBits = 8);
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minValue : 0; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+
+    // Highest value equivalent to the bucket holding the given percentile (0..100).
+    uint64_t percentile(double p) const;
+
+    // One line per percentile, values divided by unitDivisor (e.g. 1000 for ns -> us).
+    void print(std::ostream& out, const std::string& label, double unitDivisor = 1000.0,
+               const std::string& unit = "us") const;
+
+private:
+    size_t indexOf(uint64_t value) const;
+    uint64_t highestEquivalent(size_t index) const;
+
+    int precisionBits;
+    uint64_t subBucketCount;
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t minValue;
+    uint64_t maxValue;
+    long double sum;
+};
+
+} // namespace h5util
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,116 @@
+// multi_io.cpp
+#include "multi_io.h"
+
+#include <stdexcept>
+
+namespace h5util {
+
+bool hasNativeMultiIO() {
+#if H5_VERSION_GE(1, 14, 0)
+    return true;
+#else
+    return false;
+#endif
+}
+
+namespace {
+
+// Takes a reference so the id outlives the caller's handle; H5S_ALL is not an id.
+hid_t retain(hid_t id) {
+    if (id != H5S_ALL && H5Iinc_ref(id) < 0) {
+        throw H5::IdComponentException("MultiTransfer::add", "H5Iinc_ref failed");
+    }
+    return id;
+}
+
+void release(hid_t id) {
+    if (id != H5S_ALL) {
+        H5Idec_ref(id);
+    }
+}
+
+} // namespace
+
+template <typename Buffer>
+void MultiTransfer<Buffer>::add(const H5::DataSet& dataset, const H5::DataType& memType, Buffer buf) {
+    push(dataset.getId(), memType.getId(), H5S_ALL, H5S_ALL, buf);
+}
+
+template <typename Buffer>
+void MultiTransfer<Buffer>::add(const H5::DataSet& dataset, const H5::DataType& memType,
+                                const H5::DataSpace& memSpace, const H5::DataSpace& fileSpace, Buffer buf) {
+    push(dataset.getId(), memType.getId(), memSpace.getId(), fileSpace.getId(), buf);
+}
+
+template <typename Buffer>
+void MultiTransfer<Buffer>::push(hid_t dataset, hid_t memType, hid_t memSpace, hid_t fileSpace, Buffer buf) {
+    datasets.push_back(retain(dataset));
+    memTypes.push_back(retain(memType));
+    memSpaces.push_back(retain(memSpace));
+    fileSpaces.push_back(retain(fileSpace));
+    buffers.push_back(buf);
+}
+
+template <typename Buffer>
+void MultiTransfer<Buffer>::clear() {
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        release(datasets[i]);
+        release(memTypes[i]);
+        release(memSpaces[i]);
+        release(fileSpaces[i]);
+    }
+    datasets.clear();
+    memTypes.clear();
+    memSpaces.clear();
+    fileSpaces.clear();
+    buffers.clear();
+}
+
+template class MultiTransfer<void*>;
+template class MultiTransfer<const void*>;
+
+MultiStats MultiReader::execute() {
+    MultiStats stats;
+    stats.transfers = buffers.size();
+    if (buffers.empty()) return stats;
+    herr_t status = 0;
+#if H5_VERSION_GE(1, 14, 0)
+    status = H5Dread_multi(buffers.size(), datasets.data(), memTypes.data(), memSpaces.data(), fileSpaces.data(),
+                           H5P_DEFAULT, buffers.data());
+    stats.calls = 1;
+#else
+    for (size_t i = 0; i < buffers.size() && status >= 0; ++i) {
+        status = H5Dread(datasets[i], memTypes[i], memSpaces[i], fileSpaces[i], H5P_DEFAULT, buffers[i]);
+        ++stats.calls;
+    }
+#endif
+    clear();
+    if (status < 0) {
+        throw H5::DataSetIException("MultiReader::execute", "read failed");
+    }
+    return stats;
+}
+
+MultiStats MultiWriter::execute() {
+    MultiStats stats;
+    stats.transfers = buffers.size();
+    if (buffers.empty()) return stats;
+    herr_t status = 0;
+#if H5_VERSION_GE(1, 14, 0)
+    status = H5Dwrite_multi(buffers.size(), datasets.data(), memTypes.data(), memSpaces.data(), fileSpaces.data(),
+                            H5P_DEFAULT, buffers.data());
+    stats.calls = 1;
+#else
+    for (size_t i = 0; i < buffers.size() && status >= 0; ++i) {
+        status = H5Dwrite(datasets[i], memTypes[i], memSpaces[i], fileSpaces[i], H5P_DEFAULT, buffers[i]);
+        ++stats.calls;
+    }
+#endif
+    clear();
+    if (status < 0) {
+        throw H5::DataSetIException("MultiWriter::execute", "write failed");
+    }
+    return stats;
+}
+
+} // namespace h5util
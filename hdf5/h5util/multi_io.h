@@ -0,0 +1,68 @@
+// multi_io.h
+#ifndef MULTI_IO_H
+#define MULTI_IO_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <vector>
+
+namespace h5util {
+
+// True when the library provides H5Dread_multi/H5Dwrite_multi (HDF5 1.14+).
+bool hasNativeMultiIO();
+
+// Counters describing what a MultiReader/MultiWriter::execute() call did.
+struct MultiStats {
+    size_t transfers = 0; // queued dataset transfers
+    size_t calls = 0;     // H5Dread/H5Dwrite or *_multi calls issued
+};
+
+// Queues transfers against many datasets and issues them together: a single
+// H5Dread_multi/H5Dwrite_multi call when the library has one, otherwise one
+// H5Dread/H5Dwrite per dataset. The queue keeps a reference to each dataset,
+// memory type and selection until execute(), so the caller may close its own
+// handles; no HDF5 objects are created per transfer. A dataset should appear at
+// most once per batch for writes.
+template <typename Buffer>
+class MultiTransfer {
+public:
+    MultiTransfer() = default;
+    MultiTransfer(const MultiTransfer&) = delete;
+    MultiTransfer& operator=(const MultiTransfer&) = delete;
+    ~MultiTransfer() { clear(); }
+
+    // Transfer the whole dataset.
+    void add(const H5::DataSet& dataset, const H5::DataType& memType, Buffer buf);
+
+    // Transfer a selection: memSpace describes buf, fileSpace the dataset.
+    void add(const H5::DataSet& dataset, const H5::DataType& memType, const H5::DataSpace& memSpace,
+             const H5::DataSpace& fileSpace, Buffer buf);
+
+    size_t pending() const { return buffers.size(); }
+
+    // Drop every queued transfer.
+    void clear();
+
+protected:
+    void push(hid_t dataset, hid_t memType, hid_t memSpace, hid_t fileSpace, Buffer buf);
+
+    // Parallel arrays in the form the *_multi calls take.
+    std::vector<hid_t> datasets, memTypes, memSpaces, fileSpaces;
+    std::vector<Buffer> buffers;
+};
+
+class MultiReader : public MultiTransfer<void*> {
+public:
+    // Read every queued transfer and clear the queue.
+    MultiStats execute();
+};
+
+class MultiWriter : public MultiTransfer<const void*> {
+public:
+    // Write every queued transfer and clear the queue.
+    MultiStats execute();
+};
+
+} // namespace h5util
+
+#endif // MULTI_IO_H
@@ -0,0 +1,53 @@
+// parallel.cpp
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace h5util {
+
+unsigned defaultThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (threads == 0) threads = defaultThreads();
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+        while (!failed) {
+            const size_t i = next++;
+            if (i >= count) return;
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace h5util
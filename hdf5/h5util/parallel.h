@@ -0,0 +1,22 @@
+// parallel.h
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace h5util {
+
+// Worker count to use when the caller asks for 0: hardware concurrency, at least 1.
+unsigned defaultThreads();
+
+// Calls fn(i) for every i in [0, count) on up to threads worker threads (0:
+// defaultThreads()), handing out indices dynamically. The calling thread is one
+// of the workers. The first exception thrown by fn stops the remaining work and
+// is rethrown once all workers have finished. fn must not call HDF5 unless the
+// library is built thread-safe.
+void parallelFor(size_t count, unsigned threads, const std::function<void(size_t)>& fn);
+
+} // namespace h5util
+
+#endif // PARALLEL_H
@@ -0,0 +1,380 @@
+// pyramid.cpp
+#include "pyramid.h"
+#include "attribute_bulk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+const char* TAIL_DATASET = "tail";
+const hsize_t LEVEL_CHUNK_ROWS = 1024;
+
+std::string levelName(unsigned level) {
+    return "level" + std::to_string(level);
+}
+
+void clear(PyramidBucket& bucket) {
+    bucket.start = 0;
+    bucket.end = 0;
+    bucket.count = 0;
+    bucket.min = std::numeric_limits<double>::infinity();
+    bucket.max = -std::numeric_limits<double>::infinity();
+    bucket.mean = 0;
+}
+
+PyramidBucket readBucket(const H5::DataSet& dataset, const H5::CompType& type, hsize_t index) {
+    PyramidBucket bucket;
+    const hsize_t one = 1;
+    H5::DataSpace fileSpace = dataset.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, &one, &index);
+    dataset.read(&bucket, type, H5::DataSpace(1, &one), fileSpace);
+    return bucket;
+}
+
+// The existing pyramid group, or a new one once the options are known to be valid.
+H5::Group openOrCreateGroup(H5::Group& parent, const std::string& name, const PyramidOptions& options) {
+    if (H5Lexists(parent.getId(), name.c_str(), H5P_DEFAULT) > 0) return parent.openGroup(name);
+    if (options.firstLevel == 0 || options.levels == 0 || options.firstLevel + options.levels > 48) {
+        throw std::invalid_argument("PyramidWriter: levels must lie within 1..47");
+    }
+    return parent.createGroup(name);
+}
+
+template <typename T>
+T readAttribute(const H5::H5Object& object, const char* name, const H5::PredType& type) {
+    T value{};
+    object.openAttribute(name).read(type, &value);
+    return value;
+}
+
+} // namespace
+
+H5::CompType pyramidBucketType() {
+    H5::CompType type(sizeof(PyramidBucket));
+    type.insertMember("start", HOFFSET(PyramidBucket, start), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("end", HOFFSET(PyramidBucket, end), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("count", HOFFSET(PyramidBucket, count), H5::PredType::NATIVE_UINT64);
+    type.insertMember("min", HOFFSET(PyramidBucket, min), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("max", HOFFSET(PyramidBucket, max), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("mean", HOFFSET(PyramidBucket, mean), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+PyramidWriter::PyramidWriter(H5::Group& parent, const std::string& name, const PyramidOptions& options)
+    : group(openOrCreateGroup(parent, name, options)) {
+    const H5::CompType type = pyramidBucketType();
+    unsigned levelCount = options.levels;
+    std::vector<PyramidBucket> tails;
+    if (group.attrExists("firstLevel")) {
+        firstLevel = readAttribute<unsigned>(group, "firstLevel", H5::PredType::NATIVE_UINT);
+        levelCount = readAttribute<unsigned>(group, "levels", H5::PredType::NATIVE_UINT);
+        total = readAttribute<hsize_t>(group, "rows", H5::PredType::NATIVE_HSIZE);
+        tail = group.openDataSet(TAIL_DATASET);
+        tails.resize(levelCount);
+        tail.read(tails.data(), type);
+    } else {
+        firstLevel = options.firstLevel;
+        AttributeSet attributes;
+        attributes.add("firstLevel", H5::PredType::NATIVE_UINT, &options.firstLevel);
+        attributes.add("levels", H5::PredType::NATIVE_UINT, &options.levels);
+        attributes.add("rows", H5::PredType::NATIVE_HSIZE, &total);
+        attributes.writeTo(group);
+        for (unsigned k = firstLevel; k < firstLevel + levelCount; ++k) {
+            H5::DataSet dataset = createAppendableDataSet(group, levelName(k), type, {}, LEVEL_CHUNK_ROWS);
+            const hsize_t bucketRows = hsize_t(1) << k;
+            AttributeSet levelAttributes;
+            levelAttributes.add("bucketRows", H5::PredType::NATIVE_HSIZE, &bucketRows);
+            levelAttributes.writeTo(dataset);
+        }
+        hsize_t dims[1] = {levelCount};
+        tail = group.createDataSet(TAIL_DATASET, type, H5::DataSpace(1, dims));
+        tails.resize(levelCount);
+        for (PyramidBucket& bucket : tails) clear(bucket);
+    }
+
+    levels.resize(levelCount);
+    for (unsigned l = 0; l < levelCount; ++l) {
+        Level& level = levels[l];
+        level.bucketRows = hsize_t(1) << (firstLevel + l);
+        level.pending = tails[l];
+        if (level.pending.count == 0) clear(level.pending);
+        level.pending.mean *= level.pending.count; // back to the running sum
+        level.out.reset(new AppendBuffer(group.openDataSet(levelName(firstLevel + l)), type));
+    }
+    // Resuming: later rows must not go back before the newest row already summarised.
+    lastTime = -std::numeric_limits<double>::infinity();
+    for (const Level& level : levels) {
+        if (level.pending.count > 0) lastTime = std::max(lastTime, level.pending.end);
+    }
+    const hsize_t completeBuckets = levels[0].out->rowsInFile();
+    if (completeBuckets > 0) {
+        H5::DataSet finest = group.openDataSet(levelName(firstLevel));
+        lastTime = std::max(lastTime, readBucket(finest, type, completeBuckets - 1).end);
+    }
+}
+
+PyramidWriter::~PyramidWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void PyramidWriter::append(const double* times, const double* values, size_t count) {
+    if (closed) {
+        throw std::logic_error("PyramidWriter: append after close");
+    }
+    double previous = lastTime;
+    for (size_t i = 0; i < count; ++i) {
+        if (times[i] < previous) {
+            throw std::invalid_argument("PyramidWriter: times must not decrease");
+        }
+        previous = times[i];
+    }
+
+    Level& base = levels[0];
+    size_t i = 0;
+    while (i < count) {
+        PyramidBucket& pending = base.pending;
+        const size_t take = static_cast<size_t>(std::min<hsize_t>(count - i, base.bucketRows - pending.count));
+        if (pending.count == 0) pending.start = times[i];
+        double sum = 0;
+        double low = pending.min;
+        double high = pending.max;
+        for (size_t j = i; j < i + take; ++j) {
+            sum += values[j];
+            low = values[j] < low ? values[j] : low;
+            high = values[j] > high ? values[j] : high;
+        }
+        pending.mean += sum;
+        pending.min = low;
+        pending.max = high;
+        pending.end = times[i + take - 1];
+        pending.count += take;
+        i += take;
+        if (pending.count == base.bucketRows) complete(0);
+    }
+    total += count;
+    if (count > 0) lastTime = times[count - 1];
+}
+
+// Writes the full pending bucket of level and merges it into the next level.
+void PyramidWriter::complete(size_t level) {
+    Level& current = levels[level];
+    PyramidBucket done = current.pending;
+    const double sum = done.mean;
+    done.mean = sum / done.count;
+    current.out->append(&done);
+    clear(current.pending);
+
+    if (level + 1 == levels.size()) return;
+    Level& next = levels[level + 1];
+    PyramidBucket& pending = next.pending;
+    if (pending.count == 0) pending.start = done.start;
+    pending.end = done.end;
+    pending.count += done.count;
+    pending.min = std::min(pending.min, done.min);
+    pending.max = std::max(pending.max, done.max);
+    pending.mean += sum;
+    if (pending.count == next.bucketRows) complete(level + 1);
+}
+
+void PyramidWriter::flush() {
+    std::vector<PyramidBucket> tails(levels.size());
+    for (size_t l = 0; l < levels.size(); ++l) {
+        levels[l].out->flush();
+        tails[l] = levels[l].pending;
+        if (tails[l].count > 0) tails[l].mean /= tails[l].count;
+    }
+    tail.write(tails.data(), pyramidBucketType());
+    group.openAttribute("rows").write(H5::PredType::NATIVE_HSIZE, &total);
+}
+
+void PyramidWriter::close() {
+    if (closed) return;
+    closed = true;
+    flush();
+    for (Level& level : levels) level.out->close();
+}
+
+PyramidReader::PyramidReader(const H5::Group& parent, const std::string& name)
+    : group(parent.openGroup(name)), first(readAttribute<unsigned>(group, "firstLevel", H5::PredType::NATIVE_UINT)),
+      bucketType(pyramidBucketType()), total(readAttribute<hsize_t>(group, "rows", H5::PredType::NATIVE_HSIZE)) {
+    const unsigned levelCount = readAttribute<unsigned>(group, "levels", H5::PredType::NATIVE_UINT);
+    for (unsigned k = first; k < first + levelCount; ++k) {
+        levels.push_back(group.openDataSet(levelName(k)));
+        stored.push_back(levels.back().getSpace().getSimpleExtentNpoints());
+    }
+    tails.resize(levelCount);
+    group.openDataSet(TAIL_DATASET).read(tails.data(), bucketType);
+    // A level's pending bucket holds only complete buckets of the level below;
+    // fold in the finer pending rows so every level reaches the newest row.
+    for (size_t l = 1; l < tails.size(); ++l) {
+        PyramidBucket& tail = tails[l];
+        const PyramidBucket& finer = tails[l - 1];
+        if (finer.count == 0) continue;
+        if (tail.count == 0) {
+            tail = finer;
+            continue;
+        }
+        const uint64_t count = tail.count + finer.count;
+        tail.mean = (tail.mean * tail.count + finer.mean * finer.count) / count;
+        tail.end = finer.end;
+        tail.count = count;
+        tail.min = std::min(tail.min, finer.min);
+        tail.max = std::max(tail.max, finer.max);
+    }
+}
+
+PyramidBucket PyramidReader::bucket(size_t level, hsize_t index) const {
+    if (index >= stored[level]) return tails[level];
+    return readBucket(levels[level], bucketType, index);
+}
+
+PyramidSelection PyramidReader::overlapping(size_t level, double t0, double t1) const {
+    const hsize_t buckets = stored[level] + (tails[level].count > 0 ? 1 : 0);
+    // First bucket ending at or after t0, then the first starting after t1.
+    hsize_t lo = 0, hi = buckets;
+    while (lo < hi) {
+        const hsize_t mid = lo + (hi - lo) / 2;
+        if (bucket(level, mid).end < t0) lo = mid + 1;
+        else hi = mid;
+    }
+    const hsize_t begin = lo;
+    hi = buckets;
+    while (lo < hi) {
+        const hsize_t mid = lo + (hi - lo) / 2;
+        if (bucket(level, mid).start <= t1) lo = mid + 1;
+        else hi = mid;
+    }
+    PyramidSelection selection;
+    selection.level = first + static_cast<unsigned>(level);
+    selection.first = begin;
+    selection.count = lo - begin;
+    return selection;
+}
+
+PyramidSelection PyramidReader::select(double t0, double t1, size_t pixels) const {
+    if (pixels == 0) {
+        throw std::invalid_argument("PyramidReader: pixels must be positive");
+    }
+    const size_t top = levels.size() - 1;
+    PyramidSelection selection = overlapping(top, t0, t1);
+    if (selection.count == 0) return selection;
+
+    // Each finer level has about twice the buckets: start from the estimate and
+    // correct it with exact counts.
+    size_t level = top;
+    while (level > 0 && std::ldexp(static_cast<double>(selection.count), static_cast<int>(top - level + 1)) <= pixels) {
+        --level;
+    }
+    selection = overlapping(level, t0, t1);
+    while (selection.count > pixels && level < top) selection = overlapping(++level, t0, t1);
+    while (level > 0) {
+        PyramidSelection finer = overlapping(level - 1, t0, t1);
+        if (finer.count > pixels) break;
+        selection = finer;
+        --level;
+    }
+
+    if (level == 0) {
+        const hsize_t bucketRows = hsize_t(1) << first;
+        const hsize_t rawFirst = selection.first * bucketRows;
+        const hsize_t rawEnd = std::min(total, (selection.first + selection.count) * bucketRows);
+        if (rawEnd - rawFirst <= pixels) {
+            selection.level = 0;
+            selection.first = rawFirst;
+            selection.count = rawEnd - rawFirst;
+        }
+    }
+    return selection;
+}
+
+std::vector<PyramidBucket> PyramidReader::read(const PyramidSelection& selection) const {
+    if (selection.level < first || selection.level > lastLevel()) {
+        throw std::invalid_argument("PyramidReader: level " + std::to_string(selection.level) + " is not stored");
+    }
+    const size_t level = selection.level - first;
+    std::vector<PyramidBucket> buckets(selection.count);
+    const hsize_t fromFile =
+        selection.first < stored[level] ? std::min(selection.count, stored[level] - selection.first) : 0;
+    if (fromFile > 0) {
+        H5::DataSpace fileSpace = levels[level].getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, &fromFile, &selection.first);
+        levels[level].read(buckets.data(), bucketType, H5::DataSpace(1, &fromFile), fileSpace);
+    }
+    if (fromFile < selection.count) {
+        if (selection.first + selection.count > stored[level] + 1 || tails[level].count == 0) {
+            throw std::invalid_argument("PyramidReader: selection past the end of level " +
+                                        std::to_string(selection.level));
+        }
+        buckets.back() = tails[level];
+    }
+    return buckets;
+}
+
+std::vector<PyramidBucket> PyramidReader::read(double t0, double t1, size_t pixels) const {
+    PyramidSelection selection = select(t0, t1, pixels);
+    if (selection.level == 0) selection = overlapping(0, t0, t1);
+    return read(selection);
+}
+
+std::vector<size_t> largestTriangleThreeBuckets(const double* times, const double* values, size_t count,
+                                                size_t points) {
+    std::vector<size_t> selected;
+    if (points >= count) {
+        for (size_t i = 0; i < count; ++i) selected.push_back(i);
+        return selected;
+    }
+    if (points < 3) {
+        // No room for a bucket: the first row, then the last when two fit.
+        if (points > 0) selected.push_back(0);
+        if (points > 1) selected.push_back(count - 1);
+        return selected;
+    }
+    // The first and last rows stay; the others are split into points - 2 buckets.
+    const double every = static_cast<double>(count - 2) / (points - 2);
+    size_t a = 0;
+    selected.push_back(a);
+    for (size_t b = 0; b + 2 < points; ++b) {
+        const size_t nextBegin = static_cast<size_t>((b + 1) * every) + 1;
+        const size_t nextEnd = std::min(count, static_cast<size_t>((b + 2) * every) + 1);
+        double avgTime = 0, avgValue = 0;
+        for (size_t i = nextBegin; i < nextEnd; ++i) {
+            avgTime += times[i];
+            avgValue += values[i];
+        }
+        const size_t nextRows = nextEnd > nextBegin ? nextEnd - nextBegin : 1;
+        if (nextEnd <= nextBegin) {
+            avgTime = times[count - 1];
+            avgValue = values[count - 1];
+        }
+        avgTime /= nextRows;
+        avgValue /= nextRows;
+
+        const size_t begin = static_cast<size_t>(b * every) + 1;
+        const size_t end = static_cast<size_t>((b + 1) * every) + 1;
+        double bestArea = -1;
+        size_t best = begin;
+        for (size_t i = begin; i < end; ++i) {
+            const double area = std::fabs((times[a] - avgTime) * (values[i] - values[a]) -
+                                          (times[a] - times[i]) * (avgValue - values[a]));
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+        selected.push_back(best);
+        a = best;
+    }
+    selected.push_back(count - 1);
+    return selected;
+}
+
+} // namespace h5util
@@ -0,0 +1,135 @@
+// pyramid.h
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "append_buffer.h"
+
+namespace h5util {
+
+// Summary of 2^k consecutive rows of a series: the time span they cover and
+// their count, min, max and mean.
+struct PyramidBucket {
+    double start;
+    double end;
+    uint64_t count;
+    double min;
+    double max;
+    double mean;
+};
+
+H5::CompType pyramidBucketType();
+
+struct PyramidOptions {
+    unsigned firstLevel = 4; // finest stored level: 16 rows per bucket
+    unsigned levels = 16;    // levels firstLevel .. firstLevel + levels - 1
+};
+
+// Maintains a downsampling pyramid for a series that is only ever appended to,
+// in a group of its own: one appendable dataset "level<k>" of PyramidBuckets per
+// level k, each bucket summarising raw rows [i * 2^k, (i + 1) * 2^k), plus a
+// "tail" dataset with the incomplete bucket of every level. Writers feed it the
+// (time, value) pairs they append to the raw series; complete buckets of level k
+// are merged into level k + 1, so each row costs O(1) amortized. Reopening an
+// existing group resumes from its tail, so the pyramid can follow the raw series
+// across writer sessions. Times must not decrease.
+class PyramidWriter {
+public:
+    // Creates group name under parent, or reopens it (options are then read
+    // from the group).
+    PyramidWriter(H5::Group& parent, const std::string& name, const PyramidOptions& options = PyramidOptions());
+    ~PyramidWriter();
+
+    PyramidWriter(const PyramidWriter&) = delete;
+    PyramidWriter& operator=(const PyramidWriter&) = delete;
+
+    void append(const double* times, const double* values, size_t count);
+
+    // Writes the buffered buckets, the tail and the row count.
+    void flush();
+
+    // Flush and stop accepting rows. Called by the destructor.
+    void close();
+
+    hsize_t rows() const { return total; }
+
+private:
+    struct Level {
+        hsize_t bucketRows;
+        PyramidBucket pending; // mean holds the running sum until the bucket completes
+        std::unique_ptr<AppendBuffer> out;
+    };
+
+    void complete(size_t level);
+
+    H5::Group group;
+    H5::DataSet tail;
+    unsigned firstLevel;
+    std::vector<Level> levels;
+    hsize_t total = 0;
+    double lastTime = 0;
+    bool closed = false;
+};
+
+// Which rows answer a query: buckets [first, first + count) of level, or for
+// level 0 the raw rows [first, first + count).
+struct PyramidSelection {
+    unsigned level = 0;
+    hsize_t first = 0;
+    hsize_t count = 0;
+};
+
+// Reads a pyramid written by PyramidWriter for a chart: select() picks the
+// finest level that still draws the time range in at most `pixels` buckets,
+// using a few binary searches of single-row reads, so the cost does not grow
+// with the series.
+class PyramidReader {
+public:
+    PyramidReader(const H5::Group& parent, const std::string& name);
+
+    hsize_t rows() const { return total; }
+    unsigned firstLevel() const { return first; }
+    unsigned lastLevel() const { return first + static_cast<unsigned>(levels.size()) - 1; }
+
+    // Level 0 when the raw rows overlapping [t0, t1] are no more than pixels;
+    // its range is widened to whole buckets of the first level.
+    PyramidSelection select(double t0, double t1, size_t pixels) const;
+
+    // Buckets of a selection with a level of at least firstLevel(), including the
+    // level's incomplete tail bucket.
+    std::vector<PyramidBucket> read(const PyramidSelection& selection) const;
+
+    // Buckets overlapping [t0, t1] from the finest stored level that fits pixels
+    // (the first level if even that fits, the last level if none does).
+    std::vector<PyramidBucket> read(double t0, double t1, size_t pixels) const;
+
+private:
+    // Buckets of one level overlapping [t0, t1], as a range over the stored
+    // buckets followed by the tail.
+    PyramidSelection overlapping(size_t level, double t0, double t1) const;
+    PyramidBucket bucket(size_t level, hsize_t index) const;
+
+    H5::Group group;
+    unsigned first;
+    std::vector<H5::DataSet> levels;
+    std::vector<hsize_t> stored; // complete buckets per level
+    std::vector<PyramidBucket> tails;
+    H5::CompType bucketType;
+    hsize_t total;
+};
+
+// Largest-Triangle-Three-Buckets point selection: indices of at most points
+// rows that keep the visual shape of the series, including the first and the
+// last row when points >= 2 (points == 1 gives the first row only). Use on raw
+// rows of a level-0 selection or on bucket means.
+std::vector<size_t> largestTriangleThreeBuckets(const double* times, const double* values, size_t count,
+                                                size_t points);
+
+} // namespace h5util
+
+#endif // PYRAMID_H
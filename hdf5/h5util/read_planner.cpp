@@ -0,0 +1,389 @@
+// read_planner.cpp
+#include "read_planner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+// True if the type (or any member of it) is variable length. Scattering copies raw
+// element bytes, which would alias the HDF5-allocated VLEN buffers.
+bool hasVariableLength(hid_t type) {
+    H5T_class_t cls = H5Tget_class(type);
+    if (cls == H5T_VLEN) return true;
+    if (cls == H5T_STRING) return H5Tis_variable_str(type) > 0;
+    if (cls == H5T_COMPOUND) {
+        int members = H5Tget_nmembers(type);
+        for (int i = 0; i < members; ++i) {
+            hid_t member = H5Tget_member_type(type, static_cast<unsigned>(i));
+            bool vlen = hasVariableLength(member);
+            H5Tclose(member);
+            if (vlen) return true;
+        }
+    }
+    if (cls == H5T_ARRAY) {
+        hid_t base = H5Tget_super(type);
+        bool vlen = hasVariableLength(base);
+        H5Tclose(base);
+        return vlen;
+    }
+    return false;
+}
+
+// Calls fn(outer, destRow) for every row (run along the last dimension) of a box
+// with the given extent. outer holds the box-relative coordinates of the row start.
+template <typename Fn>
+void forEachRow(const std::vector<hsize_t>& count, Fn fn) {
+    const size_t rank = count.size();
+    for (hsize_t c : count) {
+        if (c == 0) return;
+    }
+    std::vector<hsize_t> pos(rank, 0);
+    if (rank == 0) {
+        fn(pos);
+        return;
+    }
+    while (true) {
+        fn(pos);
+        // Advance the odometer over every dimension except the last.
+        size_t d = rank - 1;
+        while (d > 0) {
+            --d;
+            if (++pos[d] < count[d]) break;
+            pos[d] = 0;
+            if (d == 0) return;
+        }
+        if (rank == 1) return;
+    }
+}
+
+} // namespace
+
+ReadPlanner::ReadPlanner(const H5::DataSet& dataset, const H5::DataType& memType, hsize_t gapTolerance)
+    : dataset(dataset), memType(memType), elemSize(memType.getSize()), gapTolerance(gapTolerance),
+      rank(0), chunked(false) {
+    if (hasVariableLength(memType.getId())) {
+        throw std::invalid_argument("ReadPlanner: variable-length memory types are not supported");
+    }
+    H5::DataSpace space = dataset.getSpace();
+    rank = space.getSimpleExtentNdims();
+    dims.resize(rank);
+    if (rank > 0) space.getSimpleExtentDims(dims.data());
+
+    H5::DSetCreatPropList dcpl = dataset.getCreatePlist();
+    if (dcpl.getLayout() == H5D_CHUNKED) {
+        chunked = true;
+        chunkDims.resize(rank);
+        dcpl.getChunk(rank, chunkDims.data());
+    }
+
+    fillElement.assign(elemSize, 0);
+    if (dcpl.isFillValueDefined() != H5D_FILL_VALUE_UNDEFINED) {
+        dcpl.getFillValue(memType, fillElement.data());
+    }
+}
+
+void ReadPlanner::fillBox(unsigned char* dest, hsize_t elements) const {
+    for (hsize_t i = 0; i < elements; ++i) {
+        std::memcpy(dest + i * elemSize, fillElement.data(), elemSize);
+    }
+}
+
+size_t ReadPlanner::add(const hsize_t* offset, const hsize_t* count, void* dest) {
+    Request request;
+    request.offset.assign(offset, offset + rank);
+    request.count.assign(count, count + rank);
+    request.dest = static_cast<unsigned char*>(dest);
+    for (int d = 0; d < rank; ++d) {
+        if (request.offset[d] + request.count[d] > dims[d]) {
+            throw std::out_of_range("ReadPlanner: slab exceeds dataset extent");
+        }
+    }
+    requests.push_back(std::move(request));
+    return requests.size() - 1;
+}
+
+size_t ReadPlanner::addPoint(const hsize_t* coord, void* dest) {
+    std::vector<hsize_t> ones(rank, 1);
+    return add(coord, ones.data(), dest);
+}
+
+ReadStats ReadPlanner::execute() {
+    ReadStats stats;
+    stats.requests = requests.size();
+    for (const Request& request : requests) {
+        hsize_t elements = 1;
+        for (hsize_t c : request.count) elements *= c;
+        stats.bytesRequested += elements * elemSize;
+    }
+    H5D_space_status_t spaceStatus = H5D_SPACE_STATUS_ERROR;
+    if (!requests.empty()) {
+        dataset.getSpaceStatus(spaceStatus);
+    }
+    if (spaceStatus == H5D_SPACE_STATUS_NOT_ALLOCATED) {
+        // Nothing was ever written: every element is the fill value.
+        for (const Request& request : requests) {
+            hsize_t elements = 1;
+            for (hsize_t c : request.count) elements *= c;
+            fillBox(request.dest, elements);
+        }
+    } else if (!requests.empty()) {
+        if (chunked) {
+            executeChunked(stats);
+        } else {
+            executeContiguous(stats);
+        }
+    }
+    requests.clear();
+    return stats;
+}
+
+// Contiguous and compact layouts store elements in row-major order at increasing
+// file offsets, so sorting runs by linear index sorts them by file offset without
+// asking the library where the data starts.
+void ReadPlanner::executeContiguous(ReadStats& stats) {
+    std::vector<hsize_t> stride(rank, 1);
+    for (int d = rank - 2; d >= 0; --d) stride[d] = stride[d + 1] * dims[d + 1];
+
+    std::vector<Run> runs;
+    for (const Request& request : requests) {
+        if (rank == 0) {
+            runs.push_back({0, 1, request.dest});
+            continue;
+        }
+        const hsize_t rowLength = request.count[rank - 1];
+        unsigned char* dest = request.dest;
+        forEachRow(request.count, [&](const std::vector<hsize_t>& pos) {
+            hsize_t linear = 0;
+            for (int d = 0; d < rank; ++d) linear += (request.offset[d] + pos[d]) * stride[d];
+            runs.push_back({linear, rowLength, dest});
+            dest += rowLength * elemSize;
+        });
+    }
+    stats.extents = runs.size();
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.linear < b.linear; });
+
+    const hsize_t gapElements = gapTolerance / elemSize;
+    std::vector<unsigned char> staging;
+    size_t groupBegin = 0;
+    while (groupBegin < runs.size()) {
+        hsize_t first = runs[groupBegin].linear;
+        hsize_t last = first + runs[groupBegin].length;
+        size_t groupEnd = groupBegin + 1;
+        while (groupEnd < runs.size() && runs[groupEnd].linear <= last + gapElements) {
+            last = std::max(last, runs[groupEnd].linear + runs[groupEnd].length);
+            ++groupEnd;
+        }
+
+        H5::DataSpace fileSpace = dataset.getSpace();
+        selectLinearRange(fileSpace, first, last);
+        hsize_t elements = last - first;
+        H5::DataSpace memSpace(1, &elements);
+        staging.resize(elements * elemSize);
+        dataset.read(staging.data(), memType, memSpace, fileSpace);
+        ++stats.readsIssued;
+        stats.bytesRead += elements * elemSize;
+
+        for (size_t i = groupBegin; i < groupEnd; ++i) {
+            std::memcpy(runs[i].dest, staging.data() + (runs[i].linear - first) * elemSize,
+                        runs[i].length * elemSize);
+        }
+        groupBegin = groupEnd;
+    }
+}
+
+// Selects the row-major element range [first, last) as a union of at most
+// 2 * rank hyperslab blocks.
+void ReadPlanner::selectLinearRange(H5::DataSpace& space, hsize_t first, hsize_t last) const {
+    if (rank == 0) {
+        space.selectAll();
+        return;
+    }
+    std::vector<hsize_t> stride(rank, 1);
+    for (int d = rank - 2; d >= 0; --d) stride[d] = stride[d + 1] * dims[d + 1];
+
+    space.selectNone();
+    std::vector<hsize_t> start(rank), count(rank);
+    while (first < last) {
+        int level = rank - 1;
+        for (int d = 0; d < rank; ++d) {
+            if (first % stride[d] == 0 && stride[d] <= last - first) {
+                level = d;
+                break;
+            }
+        }
+        hsize_t coord = (first / stride[level]) % dims[level];
+        hsize_t n = std::min((last - first) / stride[level], dims[level] - coord);
+        for (int d = 0; d < rank; ++d) {
+            if (d < level) {
+                start[d] = (first / stride[d]) % dims[d];
+                count[d] = 1;
+            } else if (d == level) {
+                start[d] = coord;
+                count[d] = n;
+            } else {
+                start[d] = 0;
+                count[d] = dims[d];
+            }
+        }
+        space.selectHyperslab(H5S_SELECT_OR, count.data(), start.data());
+        first += n * stride[level];
+    }
+}
+
+// Returns false if the chunk is known to have no storage allocated. When the
+// library cannot report chunk addresses the chunk is assumed allocated.
+bool ReadPlanner::chunkAddress(const std::vector<hsize_t>& chunkOrigin, haddr_t& address) const {
+    address = HADDR_UNDEF;
+#if H5_VERSION_GE(1, 10, 5)
+    unsigned filterMask = 0;
+    hsize_t storedSize = 0;
+    herr_t status = 0;
+    H5E_BEGIN_TRY {
+        status = H5Dget_chunk_info_by_coord(dataset.getId(), chunkOrigin.data(), &filterMask, &address, &storedSize);
+    } H5E_END_TRY;
+    if (status < 0) {
+        address = HADDR_UNDEF;
+        return true;
+    }
+    return address != HADDR_UNDEF;
+#else
+    (void)chunkOrigin;
+    return true;
+#endif
+}
+
+// Chunked layouts are read one chunk at a time (HDF5 always reads and filters a whole
+// chunk), visiting chunks in file address order. Every chunk is read once, covering the
+// bounding box of all request pieces that fall into it.
+void ReadPlanner::executeChunked(ReadStats& stats) {
+    struct Piece {
+        size_t request;
+        std::vector<hsize_t> start; // absolute dataset coordinates
+        std::vector<hsize_t> count;
+    };
+    struct Chunk {
+        std::vector<hsize_t> origin;
+        haddr_t address = HADDR_UNDEF;
+        bool allocated = true;
+        hsize_t gridIndex = 0;
+        std::vector<Piece> pieces;
+    };
+
+    std::vector<hsize_t> grid(rank);
+    for (int d = 0; d < rank; ++d) grid[d] = (dims[d] + chunkDims[d] - 1) / chunkDims[d];
+
+    std::map<hsize_t, Chunk> chunks;
+    for (size_t r = 0; r < requests.size(); ++r) {
+        const Request& request = requests[r];
+        bool empty = false;
+        std::vector<hsize_t> lo(rank), span(rank);
+        for (int d = 0; d < rank; ++d) {
+            if (request.count[d] == 0) empty = true;
+            lo[d] = request.offset[d] / chunkDims[d];
+            span[d] = empty ? 0 : (request.offset[d] + request.count[d] - 1) / chunkDims[d] - lo[d] + 1;
+        }
+        if (empty) continue;
+
+        // Visit every chunk of the grid the request touches.
+        std::vector<hsize_t> idx(rank, 0);
+        while (true) {
+            Piece piece{r, std::vector<hsize_t>(rank), std::vector<hsize_t>(rank)};
+            std::vector<hsize_t> origin(rank);
+            hsize_t gridIndex = 0;
+            for (int d = 0; d < rank; ++d) {
+                hsize_t c = lo[d] + idx[d];
+                origin[d] = c * chunkDims[d];
+                gridIndex = gridIndex * grid[d] + c;
+                hsize_t begin = std::max(request.offset[d], origin[d]);
+                hsize_t end = std::min(request.offset[d] + request.count[d], origin[d] + chunkDims[d]);
+                piece.start[d] = begin;
+                piece.count[d] = end - begin;
+            }
+            Chunk& chunk = chunks[gridIndex];
+            if (chunk.pieces.empty()) {
+                chunk.origin = origin;
+                chunk.gridIndex = gridIndex;
+            }
+            chunk.pieces.push_back(std::move(piece));
+
+            int d = rank - 1;
+            while (d >= 0 && ++idx[d] == span[d]) {
+                idx[d] = 0;
+                --d;
+            }
+            if (d < 0) break;
+        }
+    }
+
+    std::vector<Chunk*> order;
+    order.reserve(chunks.size());
+    for (auto& entry : chunks) {
+        entry.second.allocated = chunkAddress(entry.second.origin, entry.second.address);
+        order.push_back(&entry.second);
+    }
+    // Unallocated chunks (HADDR_UNDEF) sort last; ties fall back to grid order.
+    std::sort(order.begin(), order.end(), [](const Chunk* a, const Chunk* b) {
+        if (a->address != b->address) return a->address < b->address;
+        return a->gridIndex < b->gridIndex;
+    });
+
+    std::vector<unsigned char> staging;
+    std::vector<hsize_t> boxStart(rank), boxCount(rank), rowPos(rank);
+    for (const Chunk* chunk : order) {
+        stats.extents += chunk->pieces.size();
+        if (!chunk->allocated) {
+            for (const Piece& piece : chunk->pieces) {
+                const Request& request = requests[piece.request];
+                forEachRow(piece.count, [&](const std::vector<hsize_t>& pos) {
+                    hsize_t dst = 0;
+                    for (int d = 0; d < rank; ++d) {
+                        dst = dst * request.count[d] + (piece.start[d] + pos[d] - request.offset[d]);
+                    }
+                    fillBox(request.dest + dst * elemSize, piece.count[rank - 1]);
+                });
+            }
+            ++stats.chunksSkipped;
+            continue;
+        }
+        for (int d = 0; d < rank; ++d) {
+            hsize_t begin = dims[d], end = 0;
+            for (const Piece& piece : chunk->pieces) {
+                begin = std::min(begin, piece.start[d]);
+                end = std::max(end, piece.start[d] + piece.count[d]);
+            }
+            boxStart[d] = begin;
+            boxCount[d] = end - begin;
+        }
+        hsize_t boxElements = 1;
+        for (hsize_t c : boxCount) boxElements *= c;
+
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, boxCount.data(), boxStart.data());
+        H5::DataSpace memSpace(rank, boxCount.data());
+        staging.resize(boxElements * elemSize);
+        dataset.read(staging.data(), memType, memSpace, fileSpace);
+        ++stats.readsIssued;
+        stats.bytesRead += boxElements * elemSize;
+
+        for (const Piece& piece : chunk->pieces) {
+            const Request& request = requests[piece.request];
+            const hsize_t rowBytes = piece.count[rank - 1] * elemSize;
+            forEachRow(piece.count, [&](const std::vector<hsize_t>& pos) {
+                hsize_t src = 0, dst = 0;
+                for (int d = 0; d < rank; ++d) {
+                    hsize_t abs = piece.start[d] + pos[d];
+                    src = src * boxCount[d] + (abs - boxStart[d]);
+                    dst = dst * request.count[d] + (abs - request.offset[d]);
+                }
+                std::memcpy(request.dest + dst * elemSize, staging.data() + src * elemSize, rowBytes);
+            });
+        }
+    }
+}
+
+} // namespace h5util
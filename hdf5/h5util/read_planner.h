@@ -0,0 +1,84 @@
+// read_planner.h
+#ifndef READ_PLANNER_H
+#define READ_PLANNER_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <vector>
+
+namespace h5util {
+
+// Counters describing what a ReadPlanner::execute() call actually did.
+struct ReadStats {
+    size_t requests = 0;        // slabs queued by the caller
+    size_t extents = 0;         // contiguous runs / chunk pieces the slabs resolved to
+    size_t readsIssued = 0;     // H5Dread calls made after coalescing
+    hsize_t bytesRequested = 0; // bytes the caller asked for (memory type)
+    hsize_t bytesRead = 0;      // bytes read including coalesced gaps (memory type)
+    size_t chunksSkipped = 0;   // unallocated chunks answered with the fill value, no I/O
+};
+
+// Batches many hyperslab reads against one dataset.
+//
+// Each queued slab is resolved to file order: row runs by linear element index
+// for contiguous layout, chunk addresses for chunked layout. The runs are sorted,
+// merged when the hole between two runs is at most gapTolerance bytes, read with as
+// few H5Dread calls as possible and finally scattered back into the caller buffers.
+// Overlapping requests are read once. Storage that was never allocated (sparse
+// datasets, see DatasetOptions::sparse) is answered with the fill value without
+// calling H5Dread.
+class ReadPlanner {
+public:
+    static constexpr hsize_t DEFAULT_GAP_TOLERANCE = 64 * 1024;
+
+    ReadPlanner(const H5::DataSet& dataset, const H5::DataType& memType,
+                hsize_t gapTolerance = DEFAULT_GAP_TOLERANCE);
+
+    // Queue a slab of the dataset. dest must hold product(count) elements of the
+    // memory type, laid out row-major. Returns the request index.
+    size_t add(const hsize_t* offset, const hsize_t* count, void* dest);
+
+    // Queue a single element.
+    size_t addPoint(const hsize_t* coord, void* dest);
+
+    // Read every queued request and clear the queue.
+    ReadStats execute();
+
+    size_t pending() const { return requests.size(); }
+    bool isChunked() const { return chunked; }
+
+private:
+    struct Request {
+        std::vector<hsize_t> offset;
+        std::vector<hsize_t> count;
+        unsigned char* dest;
+    };
+
+    // One contiguous run of elements along the fastest dimension.
+    struct Run {
+        hsize_t linear;     // row-major element index of the first element in the file
+        hsize_t length;     // elements
+        unsigned char* dest;
+    };
+
+    void executeContiguous(ReadStats& stats);
+    void executeChunked(ReadStats& stats);
+    void selectLinearRange(H5::DataSpace& space, hsize_t first, hsize_t last) const;
+    bool chunkAddress(const std::vector<hsize_t>& chunkOrigin, haddr_t& address) const;
+    void fillBox(unsigned char* dest, hsize_t elements) const;
+
+    H5::DataSet dataset;
+    H5::DataType memType;
+    size_t elemSize;
+    hsize_t gapTolerance;
+    int rank;
+    std::vector<hsize_t> dims;
+    bool chunked;
+    std::vector<hsize_t> chunkDims;
+    std::vector<unsigned char> fillElement; // fill value converted to the memory type
+    std::vector<Request> requests;
+};
+
+} // namespace h5util
+
+#endif // READ_PLANNER_H
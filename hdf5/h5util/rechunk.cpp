@@ -0,0 +1,464 @@
+// rechunk.cpp
+#include "rechunk.h"
+#include "dataset_factory.h"
+#include "internal.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+#if !H5_VERSION_GE(1, 10, 3)
+#error "rechunk needs H5Dread_chunk/H5Dwrite_chunk (HDF5 1.10.3 or later)"
+#endif
+
+namespace h5util {
+
+namespace {
+
+hsize_t product(const std::vector<hsize_t>& v) {
+    hsize_t p = 1;
+    for (hsize_t x : v) p *= x;
+    return p;
+}
+
+hsize_t ceilDiv(hsize_t a, hsize_t b) {
+    return (a + b - 1) / b;
+}
+
+// What the passes need to know about a dataset being read.
+struct Source {
+    H5::DataSet dataset;
+    H5::DataType fileType;
+    size_t elemSize = 0;
+    std::vector<hsize_t> dims;
+    std::vector<hsize_t> maxDims;
+    std::vector<hsize_t> chunk;           // empty: not chunked
+    std::vector<H5Z_filter_t> filters;    // pipeline order
+    bool direct = false;                  // chunks can be read raw and decoded here
+    std::vector<unsigned char> fill;      // one element in the file type
+    bool hasFill = false;
+};
+
+Source describe(const H5::DataSet& dataset) {
+    Source src;
+    src.dataset = dataset;
+    src.fileType = dataset.getDataType();
+    if (src.fileType.detectClass(H5T_VLEN) ||
+        (src.fileType.getClass() == H5T_STRING && H5Tis_variable_str(src.fileType.getId()) > 0)) {
+        throw std::invalid_argument("rechunk: variable-length datasets are not supported");
+    }
+    src.elemSize = src.fileType.getSize();
+    H5::DataSpace space = dataset.getSpace();
+    src.dims.resize(space.getSimpleExtentNdims());
+    if (src.dims.empty()) {
+        throw std::invalid_argument("rechunk: scalar datasets have no chunks");
+    }
+    src.maxDims.resize(src.dims.size());
+    space.getSimpleExtentDims(src.dims.data(), src.maxDims.data());
+
+    H5::DSetCreatPropList dcpl = dataset.getCreatePlist();
+    src.fill.assign(src.elemSize, 0);
+    if (dcpl.isFillValueDefined() == H5D_FILL_VALUE_USER_DEFINED) {
+        dcpl.getFillValue(src.fileType, src.fill.data());
+        src.hasFill = true;
+    }
+    if (dcpl.getLayout() == H5D_CHUNKED) {
+        src.chunk.resize(src.dims.size());
+        dcpl.getChunk(static_cast<int>(src.chunk.size()), src.chunk.data());
+        src.direct = true;
+        const int nfilters = dcpl.getNfilters();
+        for (int i = 0; i < nfilters; ++i) {
+            unsigned flags = 0;
+            size_t nelmts = 0;
+            unsigned filterConfig = 0;
+            char name[64];
+            H5Z_filter_t id = dcpl.getFilter(i, flags, nelmts, nullptr, sizeof(name), name, filterConfig);
+            src.filters.push_back(id);
+            if (id != H5Z_FILTER_DEFLATE && id != H5Z_FILTER_SHUFFLE) {
+                src.direct = false; // let the library decode it
+            }
+        }
+    }
+    return src;
+}
+
+// Copies a count-shaped box between two row-major buffers of the given shapes.
+void copyBox(const unsigned char* src, const std::vector<hsize_t>& srcShape, const std::vector<hsize_t>& srcStart,
+             unsigned char* dst, const std::vector<hsize_t>& dstShape, const std::vector<hsize_t>& dstStart,
+             const std::vector<hsize_t>& count, size_t elemSize) {
+    const size_t rank = count.size();
+    for (hsize_t c : count) {
+        if (c == 0) return;
+    }
+    const size_t rowBytes = count[rank - 1] * elemSize;
+    std::vector<hsize_t> pos(rank, 0);
+    while (true) {
+        hsize_t srcIndex = 0;
+        hsize_t dstIndex = 0;
+        for (size_t d = 0; d < rank; ++d) {
+            srcIndex = srcIndex * srcShape[d] + srcStart[d] + pos[d];
+            dstIndex = dstIndex * dstShape[d] + dstStart[d] + pos[d];
+        }
+        std::memcpy(dst + dstIndex * elemSize, src + srcIndex * elemSize, rowBytes);
+        // Advance the odometer over every dimension except the last.
+        size_t d = rank - 1;
+        while (true) {
+            if (d == 0) return;
+            --d;
+            if (++pos[d] < count[d]) break;
+            pos[d] = 0;
+        }
+    }
+}
+
+// HDF5's shuffle filter: byte k of every element goes to plane k.
+void shuffleBytes(const unsigned char* in, unsigned char* out, size_t elements, size_t elemSize) {
+    for (size_t e = 0; e < elements; ++e) {
+        for (size_t k = 0; k < elemSize; ++k) {
+            out[k * elements + e] = in[e * elemSize + k];
+        }
+    }
+}
+
+void unshuffleBytes(const unsigned char* in, unsigned char* out, size_t elements, size_t elemSize) {
+    for (size_t k = 0; k < elemSize; ++k) {
+        const unsigned char* plane = in + k * elements;
+        for (size_t e = 0; e < elements; ++e) {
+            out[e * elemSize + k] = plane[e];
+        }
+    }
+}
+
+// Undoes the filters of a raw chunk (in reverse pipeline order, skipping the
+// ones the filter mask says were not applied) into out, one full chunk.
+void decodeChunk(const Source& src, const std::vector<unsigned char>& raw, uint32_t mask,
+                 std::vector<unsigned char>& out, std::vector<unsigned char>& scratch) {
+    const size_t chunkBytes = product(src.chunk) * src.elemSize;
+    out = raw;
+    for (size_t i = src.filters.size(); i-- > 0;) {
+        if (mask & (1u << i)) continue;
+        if (src.filters[i] == H5Z_FILTER_DEFLATE) {
+            scratch.resize(chunkBytes);
+            uLongf length = static_cast<uLongf>(chunkBytes);
+            if (uncompress(scratch.data(), &length, out.data(), static_cast<uLong>(out.size())) != Z_OK) {
+                throw std::runtime_error("rechunk: corrupt deflate chunk");
+            }
+            scratch.resize(length);
+            out.swap(scratch);
+        } else if (src.filters[i] == H5Z_FILTER_SHUFFLE && src.elemSize > 1) {
+            scratch.resize(out.size());
+            unshuffleBytes(out.data(), scratch.data(), out.size() / src.elemSize, src.elemSize);
+            out.swap(scratch);
+        }
+    }
+    if (out.size() != chunkBytes) {
+        throw std::runtime_error("rechunk: decoded chunk has the wrong size");
+    }
+}
+
+struct Encoded {
+    std::vector<unsigned char> bytes;
+    uint32_t mask = 0;
+    bool skip = false; // only the fill value: left unallocated
+};
+
+// Applies the target pipeline (shuffle, then deflate) the way H5Pset_deflate's
+// optional filter does: output that does not shrink is stored as is, with the
+// filter's mask bit set.
+void encodeChunk(std::vector<unsigned char>& chunk, const RechunkOptions& options, size_t elemSize,
+                 Encoded& out, std::vector<unsigned char>& scratch) {
+    unsigned index = 0;
+    if (options.shuffle) {
+        if (elemSize > 1) {
+            scratch.resize(chunk.size());
+            shuffleBytes(chunk.data(), scratch.data(), chunk.size() / elemSize, elemSize);
+            chunk.swap(scratch);
+        }
+        ++index;
+    }
+    if (options.deflateLevel >= 0) {
+        uLongf length = compressBound(static_cast<uLong>(chunk.size()));
+        out.bytes.resize(length);
+        if (compress2(out.bytes.data(), &length, chunk.data(), static_cast<uLong>(chunk.size()),
+                      options.deflateLevel) == Z_OK &&
+            length < chunk.size()) {
+            out.bytes.resize(length);
+            return;
+        }
+        out.mask |= 1u << index;
+    }
+    out.bytes.swap(chunk);
+}
+
+// Slab shape: whole target chunks, first grown to cover one source chunk (so a
+// source chunk is read about once), then as far as the budget allows, innermost
+// dimension first.
+std::vector<hsize_t> chooseSlab(const Source& src, const std::vector<hsize_t>& target, size_t budget) {
+    const size_t rank = target.size();
+    std::vector<hsize_t> factor(rank, 1), maxFactor(rank);
+    for (size_t d = 0; d < rank; ++d) {
+        maxFactor[d] = ceilDiv(src.dims[d], target[d]);
+    }
+    auto bytes = [&](const std::vector<hsize_t>& f) {
+        hsize_t elements = 1;
+        for (size_t d = 0; d < rank; ++d) elements *= f[d] * target[d];
+        return elements * src.elemSize;
+    };
+    if (bytes(factor) > budget) {
+        throw std::invalid_argument("rechunk: memory budget is smaller than one target chunk");
+    }
+    auto grow = [&](size_t d, hsize_t want) {
+        want = std::min(want, maxFactor[d]);
+        while (factor[d] < want) {
+            ++factor[d];
+            if (bytes(factor) > budget) {
+                --factor[d];
+                return;
+            }
+        }
+    };
+    if (!src.chunk.empty()) {
+        for (size_t d = rank; d-- > 0;) grow(d, ceilDiv(src.chunk[d], target[d]));
+    }
+    for (size_t d = rank; d-- > 0;) grow(d, maxFactor[d]);
+
+    std::vector<hsize_t> slab(rank);
+    for (size_t d = 0; d < rank; ++d) slab[d] = factor[d] * target[d];
+    return slab;
+}
+
+// Lower bound on how many slabs each source chunk is read for.
+double rereadFactor(const Source& src, const std::vector<hsize_t>& slab) {
+    if (src.chunk.empty()) return 1.0;
+    double factor = 1.0;
+    for (size_t d = 0; d < slab.size(); ++d) {
+        factor *= static_cast<double>(ceilDiv(std::min(src.chunk[d], src.dims[d]), slab[d]));
+    }
+    return factor;
+}
+
+// Calls fn(index) for every index of an N-d grid with the given extent.
+template <typename Fn>
+void forEachIndex(const std::vector<hsize_t>& extent, Fn fn) {
+    const size_t rank = extent.size();
+    for (hsize_t e : extent) {
+        if (e == 0) return;
+    }
+    std::vector<hsize_t> index(rank, 0);
+    while (true) {
+        fn(index);
+        size_t d = rank;
+        while (true) {
+            if (d == 0) return;
+            --d;
+            if (++index[d] < extent[d]) break;
+            index[d] = 0;
+        }
+    }
+}
+
+H5::DataSet createTarget(const Source& src, H5::Group& parent, const std::string& name,
+                         const std::vector<hsize_t>& chunk, int deflateLevel, bool shuffle) {
+    if (chunk.size() != src.dims.size()) {
+        throw std::invalid_argument("rechunk: chunk rank does not match the dataset");
+    }
+    DatasetOptions options;
+    options.chunkDims = chunk;
+    options.deflateLevel = deflateLevel;
+    options.shuffle = shuffle;
+    if (src.hasFill) {
+        options.hasFillValue = true;
+        options.fillValue = src.fill;
+    }
+    return createDataSet(parent, name, src.fileType, src.dataset.getSpace(), options);
+}
+
+void singlePass(const Source& src, H5::DataSet& dest, const std::vector<hsize_t>& target,
+                const RechunkOptions& options, RechunkStats& stats) {
+    const size_t rank = target.size();
+    const size_t elem = src.elemSize;
+    const std::vector<hsize_t> slab = chooseSlab(src, target, options.memoryBudget / 3);
+    const size_t slabElements = product(slab);
+    const size_t chunkElements = product(target);
+
+    std::vector<unsigned char> slabBuf(slabElements * elem);
+    std::vector<unsigned char> fillChunk(chunkElements * elem);
+    for (size_t i = 0; i < chunkElements; ++i) {
+        std::memcpy(&fillChunk[i * elem], src.fill.data(), elem);
+    }
+
+    std::vector<hsize_t> slabGrid(rank);
+    for (size_t d = 0; d < rank; ++d) slabGrid[d] = ceilDiv(src.dims[d], slab[d]);
+    ++stats.passes;
+
+    forEachIndex(slabGrid, [&](const std::vector<hsize_t>& slabIndex) {
+        ++stats.slabs;
+        std::vector<hsize_t> origin(rank), extent(rank);
+        for (size_t d = 0; d < rank; ++d) {
+            origin[d] = slabIndex[d] * slab[d];
+            extent[d] = std::min(slab[d], src.dims[d] - origin[d]);
+        }
+        for (size_t i = 0; i < slabElements; ++i) {
+            std::memcpy(&slabBuf[i * elem], src.fill.data(), elem);
+        }
+
+        if (src.direct) {
+            // Raw reads stay on this thread; HDF5 may not be thread-safe.
+            struct RawChunk {
+                std::vector<hsize_t> origin;
+                std::vector<unsigned char> bytes;
+                uint32_t mask;
+            };
+            std::vector<RawChunk> raw;
+            std::vector<hsize_t> first(rank), span(rank);
+            for (size_t d = 0; d < rank; ++d) {
+                first[d] = origin[d] / src.chunk[d];
+                span[d] = (origin[d] + extent[d] - 1) / src.chunk[d] - first[d] + 1;
+            }
+            auto start = Clock::now();
+            forEachIndex(span, [&](const std::vector<hsize_t>& rel) {
+                RawChunk chunk;
+                chunk.origin.resize(rank);
+                for (size_t d = 0; d < rank; ++d) chunk.origin[d] = (first[d] + rel[d]) * src.chunk[d];
+                hsize_t size = 0;
+                herr_t status = 0;
+                H5E_BEGIN_TRY {
+                    status = H5Dget_chunk_storage_size(src.dataset.getId(), chunk.origin.data(), &size);
+                } H5E_END_TRY;
+                if (status < 0 || size == 0) {
+                    return; // never written: the slab already holds the fill value
+                }
+                chunk.bytes.resize(size);
+                if (H5Dread_chunk(src.dataset.getId(), H5P_DEFAULT, chunk.origin.data(), &chunk.mask,
+                                  chunk.bytes.data()) < 0) {
+                    throw H5::DataSetIException("rechunk", "H5Dread_chunk failed");
+                }
+                stats.bytesRead += size;
+                ++stats.sourceChunksRead;
+                raw.push_back(std::move(chunk));
+            });
+            stats.readSeconds += secondsSince(start);
+
+            start = Clock::now();
+            parallelFor(raw.size(), options.threads, [&](size_t i) {
+                std::vector<unsigned char> decoded, scratch;
+                decodeChunk(src, raw[i].bytes, raw[i].mask, decoded, scratch);
+                std::vector<hsize_t> from(rank), to(rank), count(rank);
+                for (size_t d = 0; d < rank; ++d) {
+                    const hsize_t lo = std::max(origin[d], raw[i].origin[d]);
+                    const hsize_t hi = std::min({origin[d] + extent[d], raw[i].origin[d] + src.chunk[d], src.dims[d]});
+                    from[d] = lo - raw[i].origin[d];
+                    to[d] = lo - origin[d];
+                    count[d] = hi - lo;
+                }
+                // Chunks overlap disjoint parts of the slab, so workers never collide.
+                copyBox(decoded.data(), src.chunk, from, slabBuf.data(), slab, to, count, elem);
+            });
+            stats.decodeSeconds += secondsSince(start);
+        } else {
+            auto start = Clock::now();
+            H5::DataSpace fileSpace = src.dataset.getSpace();
+            fileSpace.selectHyperslab(H5S_SELECT_SET, extent.data(), origin.data());
+            H5::DataSpace memSpace(static_cast<int>(rank), slab.data());
+            std::vector<hsize_t> zero(rank, 0);
+            memSpace.selectHyperslab(H5S_SELECT_SET, extent.data(), zero.data());
+            src.dataset.read(slabBuf.data(), src.fileType, memSpace, fileSpace);
+            stats.readSeconds += secondsSince(start);
+        }
+
+        std::vector<hsize_t> chunkGrid(rank);
+        for (size_t d = 0; d < rank; ++d) chunkGrid[d] = ceilDiv(extent[d], target[d]);
+        std::vector<std::vector<hsize_t>> chunkOrigins;
+        forEachIndex(chunkGrid, [&](const std::vector<hsize_t>& index) {
+            std::vector<hsize_t> at(rank);
+            for (size_t d = 0; d < rank; ++d) at[d] = index[d] * target[d];
+            chunkOrigins.push_back(at);
+        });
+
+        auto start = Clock::now();
+        std::vector<Encoded> encoded(chunkOrigins.size());
+        const std::vector<hsize_t> zero(rank, 0);
+        parallelFor(chunkOrigins.size(), options.threads, [&](size_t i) {
+            std::vector<unsigned char> chunk(chunkElements * elem), scratch;
+            copyBox(slabBuf.data(), slab, chunkOrigins[i], chunk.data(), target, zero, target, elem);
+            if (std::memcmp(chunk.data(), fillChunk.data(), chunk.size()) == 0) {
+                encoded[i].skip = true;
+                return;
+            }
+            encodeChunk(chunk, options, elem, encoded[i], scratch);
+        });
+        stats.encodeSeconds += secondsSince(start);
+
+        start = Clock::now();
+        for (size_t i = 0; i < chunkOrigins.size(); ++i) {
+            if (encoded[i].skip) continue;
+            std::vector<hsize_t> offset(rank);
+            for (size_t d = 0; d < rank; ++d) offset[d] = origin[d] + chunkOrigins[i][d];
+            if (H5Dwrite_chunk(dest.getId(), H5P_DEFAULT, encoded[i].mask, offset.data(), encoded[i].bytes.size(),
+                               encoded[i].bytes.data()) < 0) {
+                throw H5::DataSetIException("rechunk", "H5Dwrite_chunk failed");
+            }
+            stats.bytesWritten += encoded[i].bytes.size();
+            ++stats.chunksWritten;
+        }
+        stats.writeSeconds += secondsSince(start);
+    });
+}
+
+} // namespace
+
+RechunkStats rechunk(const H5::DataSet& source, H5::Group& destParent, const std::string& name,
+                     const RechunkOptions& options) {
+    RechunkStats stats;
+    Source src = describe(source);
+    if (options.chunkDims.size() != src.dims.size()) {
+        throw std::invalid_argument("rechunk: chunk rank does not match the dataset");
+    }
+    // HDF5 rejects chunks longer than a fixed dimension.
+    std::vector<hsize_t> target = options.chunkDims;
+    for (size_t d = 0; d < target.size(); ++d) {
+        if (target[d] == 0) {
+            throw std::invalid_argument("rechunk: chunk sizes must be positive");
+        }
+        if (src.maxDims[d] != H5S_UNLIMITED && src.dims[d] > 0) {
+            target[d] = std::min(target[d], src.dims[d]);
+        }
+    }
+    const std::vector<hsize_t> slab = chooseSlab(src, target, options.memoryBudget / 3);
+    if (rereadFactor(src, slab) <= RechunkOptions::MAX_REREAD) {
+        H5::DataSet dest = createTarget(src, destParent, name, target, options.deflateLevel, options.shuffle);
+        singlePass(src, dest, target, options, stats);
+        return stats;
+    }
+
+    // Two passes through an uncompressed scratch copy chunked at min(source, target).
+    std::vector<hsize_t> middle(src.dims.size());
+    for (size_t d = 0; d < middle.size(); ++d) {
+        middle[d] = std::min(src.chunk[d], target[d]);
+    }
+    const std::string scratchName =
+        options.scratchFile.empty() ? destParent.getFileName() + ".rechunk.tmp" : options.scratchFile;
+    try {
+        H5::H5File scratchFile(scratchName, H5F_ACC_TRUNC);
+        H5::DataSet scratch = createTarget(src, scratchFile, "scratch", middle, -1, false);
+        RechunkOptions unfiltered = options;
+        unfiltered.deflateLevel = -1;
+        unfiltered.shuffle = false;
+        singlePass(src, scratch, middle, unfiltered, stats);
+
+        Source intermediate = describe(scratch);
+        H5::DataSet dest = createTarget(src, destParent, name, target, options.deflateLevel, options.shuffle);
+        singlePass(intermediate, dest, target, options, stats);
+    } catch (...) {
+        std::remove(scratchName.c_str());
+        throw;
+    }
+    std::remove(scratchName.c_str());
+    return stats;
+}
+
+} // namespace h5util
@@ -0,0 +1,59 @@
+// rechunk.h
+#ifndef RECHUNK_H
+#define RECHUNK_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace h5util {
+
+struct RechunkOptions {
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+    static constexpr double MAX_REREAD = 2.0; // above this, go through a scratch copy
+
+    std::vector<hsize_t> chunkDims; // target chunk shape (required), clipped to fixed dimensions
+    int deflateLevel = -1;          // 0..9: gzip the target chunks
+    bool shuffle = false;           // byte shuffle ahead of gzip
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET; // slab + raw chunk + output buffers
+    unsigned threads = 0;           // decode/encode workers, 0: hardware concurrency
+    std::string scratchFile;        // two-pass scratch file; empty: "<dest file>.rechunk.tmp"
+};
+
+struct RechunkStats {
+    unsigned passes = 0;
+    size_t slabs = 0;
+    size_t sourceChunksRead = 0; // raw chunk reads, counting re-reads across slabs
+    size_t chunksWritten = 0;
+    hsize_t bytesRead = 0;       // stored (compressed) bytes read
+    hsize_t bytesWritten = 0;    // stored bytes written
+    double readSeconds = 0;
+    double decodeSeconds = 0;
+    double encodeSeconds = 0;
+    double writeSeconds = 0;
+};
+
+// Copies source into a new dataset name under destParent with the target chunk
+// shape and filters, working in the file type so no conversion takes place.
+//
+// Each pass walks the destination in slabs: boxes of whole target chunks that
+// fit a third of the memory budget. Source chunks overlapping a slab are read
+// raw (H5Dread_chunk) on the calling thread, decoded (gzip, shuffle) on the
+// thread pool and scattered into the slab; the slab is cut into target chunks,
+// encoded on the pool and stored with H5Dwrite_chunk. Sources with other filters
+// or without chunking are read through H5Dread instead. When a single pass would
+// read each source chunk more than MAX_REREAD times (e.g. time-major to
+// station-major chunks under a small budget), the data first goes to an
+// uncompressed scratch dataset chunked at the element-wise minimum of the two
+// shapes, which both passes can tile cheaply.
+//
+// The fill value is carried over; attributes are not. Target chunks holding only
+// the fill value are left unallocated and read back as it. Variable-length types
+// are rejected: their raw chunks point into the source file's heap.
+RechunkStats rechunk(const H5::DataSet& source, H5::Group& destParent, const std::string& name,
+                     const RechunkOptions& options);
+
+} // namespace h5util
+
+#endif // RECHUNK_H
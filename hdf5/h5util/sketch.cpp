@@ -0,0 +1,534 @@
+// sketch.cpp
+#include "sketch.h"
+#include "attribute_bulk.h"
+#include "internal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace h5util {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr hsize_t SKETCH_CHUNK_ROWS = 16;
+
+// MurmurHash3 finalizer: spreads every input bit over the whole word, which
+// HyperLogLog needs for both the register index and the leading-zero count.
+uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// k1 scale function and its inverse: centroids near q = 0 and q = 1 stay small.
+double scale(double q, double delta) {
+    return delta / (2 * PI) * std::asin(2 * q - 1);
+}
+
+double inverseScale(double k, double delta) {
+    if (k >= delta / 4) return 1; // past the top of the scale, where sin would turn back
+    return (std::sin(k * 2 * PI / delta) + 1) / 2;
+}
+
+template <typename T>
+void writeArrayAttribute(H5::Group& group, const std::string& name, const H5::DataType& type,
+                         const std::vector<T>& values) {
+    hsize_t dims[1] = {values.size()};
+    group.createAttribute(name, type, H5::DataSpace(1, dims)).write(type, values.data());
+}
+
+template <typename T>
+std::vector<T> readArrayAttribute(const H5::Group& group, const std::string& name, const H5::DataType& type) {
+    H5::Attribute attribute = group.openAttribute(name);
+    std::vector<T> values(attribute.getSpace().getSimpleExtentNpoints());
+    attribute.read(type, values.data());
+    return values;
+}
+
+template <typename T>
+T readAttribute(const H5::Group& group, const char* name, const H5::PredType& type) {
+    T value{};
+    group.openAttribute(name).read(type, &value);
+    return value;
+}
+
+unsigned precisionOf(size_t registers) {
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < registers) ++bits;
+    return bits;
+}
+
+} // namespace
+
+TDigest::TDigest(double compression)
+    : delta(compression), low(std::numeric_limits<double>::infinity()), high(-std::numeric_limits<double>::infinity()) {
+    if (!(compression >= 10)) {
+        throw std::invalid_argument("TDigest: compression must be at least 10");
+    }
+}
+
+size_t TDigest::maxCentroids() const {
+    // Any two neighbouring centroids span more than one unit of the scale, which
+    // covers delta / 2 units.
+    return static_cast<size_t>(std::ceil(delta)) + 2;
+}
+
+void TDigest::add(double value) {
+    if (std::isnan(value)) return;
+    buffer.push_back(value);
+    low = std::min(low, value);
+    high = std::max(high, value);
+    if (buffer.size() >= 5 * maxCentroids()) compress();
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other.count() == 0) return;
+    std::vector<Centroid> incoming = other.merged;
+    for (double value : other.buffer) incoming.push_back({value, 1});
+    low = std::min(low, other.low);
+    high = std::max(high, other.high);
+    rebuild(std::move(incoming));
+}
+
+void TDigest::compress() {
+    if (buffer.empty()) return;
+    rebuild({});
+}
+
+void TDigest::rebuild(std::vector<Centroid> incoming) {
+    for (double value : buffer) incoming.push_back({value, 1});
+    buffer.clear();
+    incoming.insert(incoming.end(), merged.begin(), merged.end());
+    std::sort(incoming.begin(), incoming.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+    double weight = 0;
+    for (const Centroid& centroid : incoming) weight += centroid.weight;
+    merged.clear();
+    total = static_cast<uint64_t>(weight);
+
+    // One pass over the sorted centroids, growing each one while its quantile
+    // span stays within one unit of the scale function.
+    Centroid current = incoming.front();
+    double before = 0;
+    double limit = inverseScale(scale(0, delta) + 1, delta);
+    for (size_t i = 1; i < incoming.size(); ++i) {
+        const Centroid& next = incoming[i];
+        if ((before + current.weight + next.weight) / weight <= limit) {
+            const double combined = current.weight + next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / combined;
+            current.weight = combined;
+        } else {
+            before += current.weight;
+            merged.push_back(current);
+            limit = inverseScale(scale(std::min(1.0, before / weight), delta) + 1, delta);
+            current = next;
+        }
+    }
+    merged.push_back(current);
+}
+
+const std::vector<TDigest::Centroid>& TDigest::centroids() {
+    compress();
+    return merged;
+}
+
+double TDigest::quantile(double q) {
+    compress();
+    if (merged.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if (merged.size() == 1) return merged[0].mean;
+    q = std::min(1.0, std::max(0.0, q));
+    const double target = q * total;
+
+    // Interpolate between centroid centres, and towards min and max beyond the
+    // first and last centre.
+    double center = merged[0].weight / 2;
+    if (target <= center) return low + (merged[0].mean - low) * (center > 0 ? target / center : 0);
+    for (size_t i = 1; i < merged.size(); ++i) {
+        const double nextCenter = center + (merged[i - 1].weight + merged[i].weight) / 2;
+        if (target <= nextCenter) {
+            const double fraction = (target - center) / (nextCenter - center);
+            return merged[i - 1].mean + fraction * (merged[i].mean - merged[i - 1].mean);
+        }
+        center = nextCenter;
+    }
+    const double span = total - center;
+    return merged.back().mean + (high - merged.back().mean) * (span > 0 ? (target - center) / span : 1);
+}
+
+TDigest TDigest::fromCentroids(double compression, const std::vector<Centroid>& centroids, double min, double max) {
+    TDigest digest(compression);
+    for (const Centroid& centroid : centroids) {
+        if (centroid.weight <= 0) continue;
+        digest.merged.push_back(centroid);
+        digest.total += static_cast<uint64_t>(centroid.weight);
+    }
+    if (digest.total > 0) {
+        digest.low = min;
+        digest.high = max;
+    }
+    return digest;
+}
+
+HyperLogLog::HyperLogLog(unsigned precision) : bits(precision) {
+    if (precision < 4 || precision > 18) {
+        throw std::invalid_argument("HyperLogLog: precision must lie within 4..18");
+    }
+    cells.assign(size_t(1) << precision, 0);
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    const size_t index = static_cast<size_t>(hash >> (64 - bits));
+    // The guard bit bounds the rank at 65 - bits and keeps clz defined.
+    const uint64_t rest = (hash << bits) | (uint64_t(1) << (bits - 1));
+    const uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > cells[index]) cells[index] = rank;
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.bits != bits) {
+        throw std::invalid_argument("HyperLogLog: cannot merge precision " + std::to_string(other.bits) + " into " +
+                                    std::to_string(bits));
+    }
+    for (size_t i = 0; i < cells.size(); ++i) cells[i] = std::max(cells[i], other.cells[i]);
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(cells.size());
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t cell : cells) {
+        sum += std::ldexp(1.0, -cell);
+        if (cell == 0) ++zeros;
+    }
+    const double alpha = 0.7213 / (1 + 1.079 / m);
+    const double raw = alpha * m * m / sum;
+    // Linear counting is more accurate while many registers are still empty.
+    if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / zeros);
+    return raw;
+}
+
+HyperLogLog HyperLogLog::fromRegisters(unsigned precision, const std::vector<uint8_t>& registers) {
+    HyperLogLog sketch(precision);
+    if (registers.size() != sketch.cells.size()) {
+        throw std::invalid_argument("HyperLogLog: register count does not match precision");
+    }
+    sketch.cells = registers;
+    return sketch;
+}
+
+H5::CompType sketchSummaryType() {
+    H5::CompType type(sizeof(SketchSummary));
+    type.insertMember("count", HOFFSET(SketchSummary, count), H5::PredType::NATIVE_UINT64);
+    type.insertMember("min", HOFFSET(SketchSummary, min), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("max", HOFFSET(SketchSummary, max), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+H5::CompType centroidType() {
+    H5::CompType type(sizeof(TDigest::Centroid));
+    type.insertMember("mean", HOFFSET(TDigest::Centroid, mean), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("weight", HOFFSET(TDigest::Centroid, weight), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+// One sketched member: where it sits in the record and its sketches.
+struct SketchWriter::Column {
+    std::string name;
+    size_t offset = 0;
+    size_t size = 0;
+    H5T_class_t typeClass = H5T_NO_CLASS;
+    bool isSigned = false;
+    bool variable = false;
+    TDigest chunkDigest;
+    TDigest columnDigest;
+    HyperLogLog chunkDistinct;
+    HyperLogLog columnDistinct;
+    std::unique_ptr<AppendBuffer> distinctOut;
+    std::unique_ptr<AppendBuffer> digestOut;
+    std::unique_ptr<AppendBuffer> summaryOut;
+
+    Column(const SketchOptions& options)
+        : chunkDigest(options.compression), columnDigest(options.compression),
+          chunkDistinct(options.chunkPrecision), columnDistinct(options.columnPrecision) {}
+
+    bool numeric() const { return typeClass == H5T_INTEGER || typeClass == H5T_FLOAT; }
+
+    void add(const unsigned char* record) {
+        const unsigned char* field = record + offset;
+        if (typeClass == H5T_STRING) {
+            const char* text = reinterpret_cast<const char*>(field);
+            size_t length;
+            if (variable) {
+                text = load<const char*>(field);
+                if (!text) text = "";
+                length = std::strlen(text);
+            } else {
+                length = strnlen(text, size);
+            }
+            const uint64_t hash = mix(fnv1a(text, length));
+            chunkDistinct.add(hash);
+            columnDistinct.add(hash);
+            return;
+        }
+        double value;
+        uint64_t bits;
+        if (typeClass == H5T_FLOAT) {
+            value = size == 4 ? load<float>(field) : load<double>(field);
+            const double normalized = value == 0 ? 0.0 : value; // -0 counts as 0
+            std::memcpy(&bits, &normalized, sizeof(bits));
+        } else if (isSigned) {
+            int64_t v;
+            switch (size) {
+            case 1: v = load<int8_t>(field); break;
+            case 2: v = load<int16_t>(field); break;
+            case 4: v = load<int32_t>(field); break;
+            default: v = load<int64_t>(field); break;
+            }
+            value = static_cast<double>(v);
+            bits = static_cast<uint64_t>(v);
+        } else {
+            switch (size) {
+            case 1: bits = load<uint8_t>(field); break;
+            case 2: bits = load<uint16_t>(field); break;
+            case 4: bits = load<uint32_t>(field); break;
+            default: bits = load<uint64_t>(field); break;
+            }
+            value = static_cast<double>(bits);
+        }
+        const uint64_t hash = mix(bits);
+        chunkDistinct.add(hash);
+        columnDistinct.add(hash);
+        chunkDigest.add(value);
+    }
+};
+
+SketchWriter::SketchWriter(H5::Group& parent, const std::string& name, const H5::CompType& memType,
+                           const std::vector<std::string>& members, const SketchOptions& options)
+    : group(parent.createGroup(name)), options(options), recordSize(memType.getSize()) {
+    if (options.chunkRows == 0) {
+        throw std::invalid_argument("SketchWriter: chunkRows must be positive");
+    }
+    AttributeSet attributes;
+    attributes.add("rows", H5::PredType::NATIVE_HSIZE, &total);
+    attributes.add("chunkRows", H5::PredType::NATIVE_HSIZE, &options.chunkRows);
+    attributes.add("compression", H5::PredType::NATIVE_DOUBLE, &options.compression);
+    attributes.writeTo(group);
+
+    for (const std::string& member : members) {
+        const unsigned index = static_cast<unsigned>(memType.getMemberIndex(member));
+        hid_t typeId = H5Tget_member_type(memType.getId(), index);
+        H5::DataType type(typeId); // holds its own reference
+        H5Tclose(typeId);
+        std::unique_ptr<Column> column(new Column(options));
+        column->name = member;
+        column->offset = memType.getMemberOffset(index);
+        column->size = type.getSize();
+        column->typeClass = type.getClass();
+        if (column->typeClass == H5T_INTEGER) column->isSigned = H5Tget_sign(type.getId()) == H5T_SGN_2;
+        if (column->typeClass == H5T_STRING) column->variable = H5Tis_variable_str(type.getId()) > 0;
+        if (!column->numeric() && column->typeClass != H5T_STRING) {
+            throw std::invalid_argument("SketchWriter: member " + member + " is neither numeric nor a string");
+        }
+
+        const H5::DataType& registerType = H5::PredType::NATIVE_UINT8;
+        column->distinctOut.reset(new AppendBuffer(
+            createAppendableDataSet(group, member + ".hll", registerType,
+                                    {column->chunkDistinct.registers().size()}, SKETCH_CHUNK_ROWS),
+            registerType));
+        if (column->numeric()) {
+            const H5::CompType digestType = centroidType();
+            column->digestOut.reset(new AppendBuffer(
+                createAppendableDataSet(group, member + ".tdigest", digestType,
+                                        {column->chunkDigest.maxCentroids()}, SKETCH_CHUNK_ROWS),
+                digestType));
+            const H5::CompType summaryType = sketchSummaryType();
+            column->summaryOut.reset(new AppendBuffer(
+                createAppendableDataSet(group, member + ".summary", summaryType, {}, 1024), summaryType));
+        }
+        columns.push_back(std::move(column));
+    }
+}
+
+SketchWriter::~SketchWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void SketchWriter::append(const void* records, size_t rows) {
+    if (closed) {
+        throw std::logic_error("SketchWriter: append after close");
+    }
+    const unsigned char* bytes = static_cast<const unsigned char*>(records);
+    size_t done = 0;
+    while (done < rows) {
+        const size_t take = static_cast<size_t>(std::min<hsize_t>(rows - done, options.chunkRows - chunkFill));
+        for (const std::unique_ptr<Column>& column : columns) {
+            for (size_t r = done; r < done + take; ++r) column->add(bytes + r * recordSize);
+        }
+        done += take;
+        chunkFill += take;
+        total += take;
+        if (chunkFill == options.chunkRows) finishChunk();
+    }
+}
+
+void SketchWriter::finishChunk() {
+    for (const std::unique_ptr<Column>& column : columns) {
+        column->distinctOut->append(column->chunkDistinct.registers().data());
+        column->chunkDistinct = HyperLogLog(options.chunkPrecision);
+        if (!column->numeric()) continue;
+
+        TDigest& digest = column->chunkDigest;
+        std::vector<TDigest::Centroid> padded = digest.centroids();
+        padded.resize(digest.maxCentroids(), TDigest::Centroid{0, 0});
+        column->digestOut->append(padded.data());
+        const SketchSummary summary = {digest.count(), digest.min(), digest.max()};
+        column->summaryOut->append(&summary);
+        column->columnDigest.merge(digest);
+        digest = TDigest(options.compression);
+    }
+    chunkFill = 0;
+}
+
+void SketchWriter::close() {
+    if (closed) return;
+    closed = true;
+    if (chunkFill > 0) finishChunk();
+    for (const std::unique_ptr<Column>& column : columns) {
+        writeArrayAttribute(group, column->name + ".hll", H5::PredType::NATIVE_UINT8,
+                            column->columnDistinct.registers());
+        column->distinctOut->close();
+        if (!column->numeric()) continue;
+        TDigest& digest = column->columnDigest;
+        std::vector<TDigest::Centroid> centroids = digest.centroids();
+        if (centroids.empty()) centroids.push_back({0, 0}); // attributes cannot be empty
+        writeArrayAttribute(group, column->name + ".tdigest", centroidType(), centroids);
+        const SketchSummary summary = {digest.count(), digest.min(), digest.max()};
+        group.createAttribute(column->name + ".summary", sketchSummaryType(), H5::DataSpace(H5S_SCALAR))
+            .write(sketchSummaryType(), &summary);
+        column->digestOut->close();
+        column->summaryOut->close();
+    }
+    group.openAttribute("rows").write(H5::PredType::NATIVE_HSIZE, &total);
+}
+
+SketchReader::SketchReader(const H5::Group& parent, const std::string& name)
+    : group(parent.openGroup(name)), total(readAttribute<hsize_t>(group, "rows", H5::PredType::NATIVE_HSIZE)),
+      chunk(readAttribute<hsize_t>(group, "chunkRows", H5::PredType::NATIVE_HSIZE)),
+      compression(readAttribute<double>(group, "compression", H5::PredType::NATIVE_DOUBLE)) {}
+
+TDigest SketchReader::quantiles(const std::string& member) const {
+    std::vector<TDigest::Centroid> centroids =
+        readArrayAttribute<TDigest::Centroid>(group, member + ".tdigest", centroidType());
+    SketchSummary summary;
+    group.openAttribute(member + ".summary").read(sketchSummaryType(), &summary);
+    return TDigest::fromCentroids(compression, centroids, summary.min, summary.max);
+}
+
+HyperLogLog SketchReader::distinct(const std::string& member) const {
+    std::vector<uint8_t> registers = readArrayAttribute<uint8_t>(group, member + ".hll", H5::PredType::NATIVE_UINT8);
+    return HyperLogLog::fromRegisters(precisionOf(registers.size()), registers);
+}
+
+TDigest SketchReader::quantiles(const std::string& member, hsize_t firstChunk, hsize_t count) const {
+    if (firstChunk + count > chunks()) {
+        throw std::invalid_argument("SketchReader: chunk range past the end of " + member);
+    }
+    TDigest result(compression);
+    if (count == 0) return result;
+    H5::DataSet digests = group.openDataSet(member + ".tdigest");
+    H5::DataSet summaries = group.openDataSet(member + ".summary");
+    hsize_t dims[2];
+    digests.getSpace().getSimpleExtentDims(dims);
+
+    std::vector<TDigest::Centroid> centroids(count * dims[1]);
+    hsize_t start[2] = {firstChunk, 0};
+    hsize_t extent[2] = {count, dims[1]};
+    H5::DataSpace fileSpace = digests.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, extent, start);
+    digests.read(centroids.data(), centroidType(), H5::DataSpace(2, extent), fileSpace);
+
+    std::vector<SketchSummary> summary(count);
+    H5::DataSpace summarySpace = summaries.getSpace();
+    summarySpace.selectHyperslab(H5S_SELECT_SET, &count, &firstChunk);
+    summaries.read(summary.data(), sketchSummaryType(), H5::DataSpace(1, &count), summarySpace);
+
+    for (hsize_t c = 0; c < count; ++c) {
+        std::vector<TDigest::Centroid> one(centroids.begin() + c * dims[1], centroids.begin() + (c + 1) * dims[1]);
+        result.merge(TDigest::fromCentroids(compression, one, summary[c].min, summary[c].max));
+    }
+    return result;
+}
+
+HyperLogLog SketchReader::distinct(const std::string& member, hsize_t firstChunk, hsize_t count) const {
+    if (firstChunk + count > chunks()) {
+        throw std::invalid_argument("SketchReader: chunk range past the end of " + member);
+    }
+    H5::DataSet sketches = group.openDataSet(member + ".hll");
+    hsize_t dims[2];
+    sketches.getSpace().getSimpleExtentDims(dims);
+    HyperLogLog result(precisionOf(dims[1]));
+    if (count == 0) return result;
+
+    std::vector<uint8_t> registers(count * dims[1]);
+    hsize_t start[2] = {firstChunk, 0};
+    hsize_t extent[2] = {count, dims[1]};
+    H5::DataSpace fileSpace = sketches.getSpace();
+    fileSpace.selectHyperslab(H5S_SELECT_SET, extent, start);
+    sketches.read(registers.data(), H5::PredType::NATIVE_UINT8, H5::DataSpace(2, extent), fileSpace);
+    std::vector<uint8_t> merged(dims[1], 0);
+    for (hsize_t c = 0; c < count; ++c) {
+        for (hsize_t i = 0; i < dims[1]; ++i) merged[i] = std::max(merged[i], registers[c * dims[1] + i]);
+    }
+    return HyperLogLog::fromRegisters(result.precision(), merged);
+}
+
+hsize_t sketchDataSet(const H5::DataSet& dataset, H5::Group& destParent, const std::string& name,
+                      const std::vector<std::string>& members, SketchOptions options) {
+    H5::DataSpace space = dataset.getSpace();
+    if (dataset.getTypeClass() != H5T_COMPOUND || space.getSimpleExtentNdims() != 1) {
+        throw std::invalid_argument("sketchDataSet: needs a one-dimensional compound dataset");
+    }
+    H5::DSetCreatPropList dcpl = dataset.getCreatePlist();
+    if (dcpl.getLayout() == H5D_CHUNKED) {
+        hsize_t chunkDims[1];
+        dcpl.getChunk(1, chunkDims);
+        options.chunkRows = chunkDims[0];
+    }
+    hid_t nativeType = H5Tget_native_type(dataset.getCompType().getId(), H5T_DIR_ASCEND);
+    H5::CompType memType(nativeType); // holds its own reference
+    H5Tclose(nativeType);
+    const bool variable = hasVariableParts(memType.getId());
+    const hsize_t rows = space.getSimpleExtentNpoints();
+    const hsize_t batchRows = std::max<hsize_t>(1, (SketchOptions::DEFAULT_CHUNK_ROWS / options.chunkRows)) *
+                              options.chunkRows;
+
+    SketchWriter writer(destParent, name, memType, members, options);
+    std::vector<unsigned char> batch(static_cast<size_t>(std::min(rows, batchRows)) * memType.getSize());
+    for (hsize_t start = 0; start < rows; start += batchRows) {
+        hsize_t count = std::min(batchRows, rows - start);
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, &count, &start);
+        H5::DataSpace memSpace(1, &count);
+        dataset.read(batch.data(), memType, memSpace, fileSpace);
+        writer.append(batch.data(), static_cast<size_t>(count));
+        if (variable) {
+            reclaimVariable(memType, memSpace, batch.data());
+        }
+    }
+    writer.close();
+    return rows;
+}
+
+} // namespace h5util
@@ -0,0 +1,176 @@
+// sketch.h
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "append_buffer.h"
+
+namespace h5util {
+
+// Merging t-digest (Dunning) with the arcsine scale function: a few hundred
+// weighted centroids that answer quantile queries with an error that shrinks
+// towards the tails, so p99 is more accurate than p50. Digests of different
+// chunks merge into a digest of their union.
+class TDigest {
+public:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    static constexpr double DEFAULT_COMPRESSION = 100;
+
+    explicit TDigest(double compression = DEFAULT_COMPRESSION);
+
+    void add(double value);
+    void merge(const TDigest& other);
+
+    // Folds buffered values into the centroids. quantile() does it on demand.
+    void compress();
+
+    // Approximate value at quantile q in [0, 1]; NaN when empty.
+    double quantile(double q);
+
+    double compression() const { return delta; }
+    uint64_t count() const { return total + buffer.size(); }
+    double min() const { return low; }
+    double max() const { return high; }
+
+    // Compressed centroids in increasing order of mean; at most maxCentroids().
+    const std::vector<Centroid>& centroids();
+    size_t maxCentroids() const;
+
+    // Rebuilds a digest from stored centroids.
+    static TDigest fromCentroids(double compression, const std::vector<Centroid>& centroids, double min, double max);
+
+private:
+    // Merges incoming, the buffer and the current centroids into new centroids.
+    void rebuild(std::vector<Centroid> incoming);
+
+    double delta;
+    std::vector<Centroid> merged;
+    std::vector<double> buffer;
+    uint64_t total = 0; // weight of merged
+    double low;
+    double high;
+};
+
+// HyperLogLog distinct-count sketch with 2^precision one-byte registers (about
+// 1.04 / sqrt(2^precision) relative error) over 64-bit hashes. Sketches of equal
+// precision merge by taking the register maximum.
+class HyperLogLog {
+public:
+    static constexpr unsigned DEFAULT_PRECISION = 14;
+
+    explicit HyperLogLog(unsigned precision = DEFAULT_PRECISION);
+
+    void add(uint64_t hash);
+    void merge(const HyperLogLog& other);
+    double estimate() const;
+
+    unsigned precision() const { return bits; }
+    const std::vector<uint8_t>& registers() const { return cells; }
+
+    static HyperLogLog fromRegisters(unsigned precision, const std::vector<uint8_t>& registers);
+
+private:
+    unsigned bits;
+    std::vector<uint8_t> cells;
+};
+
+struct SketchOptions {
+    static constexpr hsize_t DEFAULT_CHUNK_ROWS = 64 * 1024;
+
+    hsize_t chunkRows = DEFAULT_CHUNK_ROWS;  // rows per chunk sketch
+    double compression = TDigest::DEFAULT_COMPRESSION;
+    unsigned columnPrecision = HyperLogLog::DEFAULT_PRECISION; // whole-column distinct counts
+    unsigned chunkPrecision = 12;            // per-chunk distinct counts, 4 KiB each
+};
+
+// Sketches the members of records as they are written. Numeric members get a
+// t-digest and a HyperLogLog, string members (fixed or variable) a HyperLogLog.
+// Everything lives in a new group: per member, one row per chunk of chunkRows
+// records in "<member>.hll" (registers), "<member>.tdigest" (centroids padded
+// with zero weights) and "<member>.summary" (count, min, max); on close the
+// whole-column sketches are stored as attributes of the group under the same
+// names. A chunk's sketches are written as soon as it is complete.
+class SketchWriter {
+public:
+    SketchWriter(H5::Group& parent, const std::string& name, const H5::CompType& memType,
+                 const std::vector<std::string>& members, const SketchOptions& options = SketchOptions());
+    ~SketchWriter();
+
+    SketchWriter(const SketchWriter&) = delete;
+    SketchWriter& operator=(const SketchWriter&) = delete;
+
+    // records hold rows records laid out as memType.
+    void append(const void* records, size_t rows);
+
+    // Writes the partial last chunk and the column sketches. Called by the destructor.
+    void close();
+
+    hsize_t rows() const { return total; }
+
+private:
+    struct Column;
+
+    void finishChunk();
+
+    H5::Group group;
+    SketchOptions options;
+    size_t recordSize;
+    std::vector<std::unique_ptr<Column>> columns;
+    hsize_t total = 0;
+    hsize_t chunkFill = 0;
+    bool closed = false;
+};
+
+// Summary stored per chunk and per column next to a t-digest.
+struct SketchSummary {
+    uint64_t count;
+    double min;
+    double max;
+};
+
+H5::CompType sketchSummaryType();
+H5::CompType centroidType();
+
+// Answers approximate quantile and distinct-count queries from a sketch group,
+// for the whole column or for a range of chunks, without touching the data.
+class SketchReader {
+public:
+    SketchReader(const H5::Group& parent, const std::string& name);
+
+    hsize_t rows() const { return total; }
+    hsize_t chunkRows() const { return chunk; }
+    hsize_t chunks() const { return (total + chunk - 1) / chunk; }
+
+    TDigest quantiles(const std::string& member) const;
+    HyperLogLog distinct(const std::string& member) const;
+
+    // Merged sketches of chunks [firstChunk, firstChunk + count), which cover
+    // rows [firstChunk * chunkRows(), (firstChunk + count) * chunkRows()).
+    TDigest quantiles(const std::string& member, hsize_t firstChunk, hsize_t count) const;
+    HyperLogLog distinct(const std::string& member, hsize_t firstChunk, hsize_t count) const;
+
+private:
+    H5::Group group;
+    hsize_t total;
+    hsize_t chunk;
+    double compression;
+};
+
+// Scans an existing one-dimensional compound dataset in its native type and
+// writes the sketches of members to group name under destParent. Chunk sketches
+// follow the dataset's own chunking when it has one.
+hsize_t sketchDataSet(const H5::DataSet& dataset, H5::Group& destParent, const std::string& name,
+                      const std::vector<std::string>& members, SketchOptions options = SketchOptions());
+
+} // namespace h5util
+
+#endif // SKETCH_H
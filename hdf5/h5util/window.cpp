@@ -0,0 +1,373 @@
+// window.cpp
+#include "window.h"
+#include "attribute_bulk.h"
+#include "internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace h5util {
+
+namespace {
+
+bool isNumeric(H5T_class_t typeClass) {
+    return typeClass == H5T_INTEGER || typeClass == H5T_FLOAT;
+}
+
+const char* kindName(Window kind) {
+    switch (kind) {
+    case Window::Tumbling: return "tumbling";
+    case Window::Sliding: return "sliding";
+    case Window::Session: return "session";
+    default: return "ewma";
+    }
+}
+
+H5::CompType outputType(Window kind) {
+    if (kind == Window::Sliding) return rollingRowType();
+    if (kind == Window::Ewma) return ewmaRowType();
+    return windowRowType();
+}
+
+void startWindow(WindowRow& row, double start, double end) {
+    row.start = start;
+    row.end = end;
+    row.count = 0;
+    row.mean = 0;
+    row.min = std::numeric_limits<double>::infinity();
+    row.max = -std::numeric_limits<double>::infinity();
+}
+
+// Adds values to the window's count, sum, min and max.
+void reduce(WindowRow& row, double& sum, const double* values, size_t count) {
+    double total = 0;
+    double low = row.min;
+    double high = row.max;
+    for (size_t i = 0; i < count; ++i) {
+        total += values[i];
+        low = values[i] < low ? values[i] : low;
+        high = values[i] > high ? values[i] : high;
+    }
+    sum += total;
+    row.min = low;
+    row.max = high;
+    row.count += count;
+}
+
+} // namespace
+
+SeriesReader::SeriesReader(const H5::DataSet& dataset, const std::string& valueMember, const std::string& timeMember,
+                           double divisor)
+    : dataset(dataset), compound(true), rank(1), divisor(divisor),
+      pairType(timeMember.empty() ? sizeof(double) : 2 * sizeof(double)),
+      total(dataset.getSpace().getSimpleExtentNpoints()) {
+    if (dataset.getTypeClass() != H5T_COMPOUND || dataset.getSpace().getSimpleExtentNdims() != 1) {
+        throw std::invalid_argument("SeriesReader: " + valueMember + " needs a one-dimensional compound dataset");
+    }
+    H5::CompType fileType = dataset.getCompType();
+    const std::string members[2] = {timeMember, valueMember};
+    for (const std::string& member : members) {
+        if (member.empty()) continue;
+        const unsigned index = static_cast<unsigned>(fileType.getMemberIndex(member));
+        if (!isNumeric(fileType.getMemberClass(index))) {
+            throw std::invalid_argument("SeriesReader: member " + member + " is not numeric");
+        }
+    }
+    timeFromMember = !timeMember.empty();
+    if (timeFromMember) pairType.insertMember(timeMember, 0, H5::PredType::NATIVE_DOUBLE);
+    pairType.insertMember(valueMember, timeFromMember ? sizeof(double) : 0, H5::PredType::NATIVE_DOUBLE);
+}
+
+SeriesReader::SeriesReader(const H5::DataSet& dataset, hsize_t column, const H5::DataSet* times, double divisor)
+    : dataset(dataset), compound(false), column(column), rank(dataset.getSpace().getSimpleExtentNdims()),
+      divisor(divisor), pairType(sizeof(double)), total(0) {
+    if ((rank != 1 && rank != 2) || !isNumeric(dataset.getTypeClass())) {
+        throw std::invalid_argument("SeriesReader: needs a one- or two-dimensional numeric dataset");
+    }
+    hsize_t dims[2] = {0, 1};
+    dataset.getSpace().getSimpleExtentDims(dims);
+    if (column >= dims[1]) {
+        throw std::invalid_argument("SeriesReader: column " + std::to_string(column) + " out of range");
+    }
+    total = dims[0];
+    if (times) {
+        H5::DataSpace timeSpace = times->getSpace();
+        if (timeSpace.getSimpleExtentNdims() != 1 || static_cast<hsize_t>(timeSpace.getSimpleExtentNpoints()) < total ||
+            !isNumeric(times->getTypeClass())) {
+            throw std::invalid_argument("SeriesReader: times must be numeric with one entry per row");
+        }
+        timeDataset = *times;
+        timeFromDataset = true;
+    }
+}
+
+size_t SeriesReader::next(std::vector<double>& times, std::vector<double>& values, size_t count) {
+    const hsize_t rows = std::min<hsize_t>(count, total - nextRow);
+    times.resize(rows);
+    values.resize(rows);
+    if (rows == 0) return 0;
+
+    if (compound) {
+        const size_t width = timeFromMember ? 2 : 1;
+        pairs.resize(rows * width);
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, &rows, &nextRow);
+        H5::DataSpace memSpace(1, &rows);
+        dataset.read(pairs.data(), pairType, memSpace, fileSpace);
+        for (hsize_t i = 0; i < rows; ++i) {
+            if (timeFromMember) times[i] = pairs[i * width];
+            values[i] = pairs[i * width + width - 1];
+        }
+    } else {
+        hsize_t start[2] = {nextRow, column};
+        hsize_t extent[2] = {rows, 1};
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, extent, start);
+        H5::DataSpace memSpace(1, &rows);
+        dataset.read(values.data(), H5::PredType::NATIVE_DOUBLE, memSpace, fileSpace);
+        if (timeFromDataset) {
+            H5::DataSpace timeSpace = timeDataset.getSpace();
+            timeSpace.selectHyperslab(H5S_SELECT_SET, &rows, &nextRow);
+            timeDataset.read(times.data(), H5::PredType::NATIVE_DOUBLE, memSpace, timeSpace);
+        }
+    }
+    if (!timeFromMember && !timeFromDataset) {
+        for (hsize_t i = 0; i < rows; ++i) times[i] = static_cast<double>(nextRow + i);
+    }
+    if (divisor != 1) {
+        for (double& value : values) value /= divisor;
+    }
+    nextRow += rows;
+    return rows;
+}
+
+H5::CompType windowRowType() {
+    H5::CompType type(sizeof(WindowRow));
+    type.insertMember("start", HOFFSET(WindowRow, start), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("end", HOFFSET(WindowRow, end), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("count", HOFFSET(WindowRow, count), H5::PredType::NATIVE_UINT64);
+    type.insertMember("mean", HOFFSET(WindowRow, mean), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("min", HOFFSET(WindowRow, min), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("max", HOFFSET(WindowRow, max), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+H5::CompType rollingRowType() {
+    H5::CompType type(sizeof(RollingRow));
+    type.insertMember("time", HOFFSET(RollingRow, time), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("value", HOFFSET(RollingRow, value), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("count", HOFFSET(RollingRow, count), H5::PredType::NATIVE_UINT64);
+    type.insertMember("mean", HOFFSET(RollingRow, mean), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("min", HOFFSET(RollingRow, min), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("max", HOFFSET(RollingRow, max), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+H5::CompType ewmaRowType() {
+    H5::CompType type(sizeof(EwmaRow));
+    type.insertMember("time", HOFFSET(EwmaRow, time), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("value", HOFFSET(EwmaRow, value), H5::PredType::NATIVE_DOUBLE);
+    type.insertMember("ewma", HOFFSET(EwmaRow, ewma), H5::PredType::NATIVE_DOUBLE);
+    return type;
+}
+
+WindowAggregator::WindowAggregator(H5::Group& destParent, const std::vector<WindowSpec>& specs) {
+    operators.reserve(specs.size());
+    for (const WindowSpec& spec : specs) {
+        if (!(spec.width > 0) || std::isinf(spec.width)) {
+            throw std::invalid_argument("WindowAggregator: " + spec.output + " needs a positive width");
+        }
+        H5::CompType type = outputType(spec.kind);
+        const hsize_t chunkRows = (1 << 20) / type.getSize();
+        H5::DataSet dataset = createAppendableDataSet(destParent, spec.output, type, {}, chunkRows);
+        AttributeSet attributes;
+        attributes.addString("window", kindName(spec.kind));
+        attributes.add("width", H5::PredType::NATIVE_DOUBLE, &spec.width);
+        attributes.writeTo(dataset);
+
+        operators.emplace_back();
+        Operator& op = operators.back();
+        op.spec = spec;
+        op.out.reset(new AppendBuffer(dataset, type));
+    }
+}
+
+WindowAggregator::~WindowAggregator() {
+    try {
+        finish();
+    } catch (...) {
+        // Destructors must not throw; call finish() explicitly to see write errors.
+    }
+}
+
+void WindowAggregator::consume(const double* times, const double* values, size_t count) {
+    if (finished) {
+        throw std::logic_error("WindowAggregator: consume after finish");
+    }
+    if (count == 0) return;
+    double previous = started ? lastTime : times[0];
+    for (size_t i = 0; i < count; ++i) {
+        if (times[i] < previous) {
+            throw std::invalid_argument("WindowAggregator: times must not decrease");
+        }
+        previous = times[i];
+    }
+    started = true;
+    lastTime = previous;
+
+    for (Operator& op : operators) {
+        switch (op.spec.kind) {
+        case Window::Tumbling: tumbling(op, times, values, count); break;
+        case Window::Sliding: sliding(op, times, values, count); break;
+        case Window::Session: session(op, times, values, count); break;
+        case Window::Ewma: exponential(op, times, values, count); break;
+        }
+    }
+}
+
+void WindowAggregator::finish() {
+    if (finished) return;
+    finished = true;
+    for (Operator& op : operators) {
+        if (op.open && (op.spec.kind == Window::Tumbling || op.spec.kind == Window::Session)) {
+            op.row.mean = op.windowSum / op.row.count;
+            op.out->append(&op.row);
+            op.open = false;
+        }
+        op.out->close();
+    }
+}
+
+void WindowAggregator::tumbling(Operator& op, const double* times, const double* values, size_t count) {
+    const double width = op.spec.width;
+    size_t i = 0;
+    while (i < count) {
+        if (!op.open || times[i] >= op.row.end) {
+            if (op.open) {
+                op.row.mean = op.windowSum / op.row.count;
+                op.out->append(&op.row);
+            }
+            const double k = std::floor((times[i] - op.spec.origin) / width);
+            startWindow(op.row, op.spec.origin + k * width, op.spec.origin + (k + 1) * width);
+            op.windowSum = 0;
+            op.open = true;
+        }
+        // Row i opened or continues this window, even if rounding put it on the end.
+        size_t j = i + 1;
+        while (j < count && times[j] < op.row.end) ++j;
+        reduce(op.row, op.windowSum, values + i, j - i);
+        i = j;
+    }
+}
+
+void WindowAggregator::session(Operator& op, const double* times, const double* values, size_t count) {
+    const double gap = op.spec.width;
+    size_t i = 0;
+    while (i < count) {
+        if (op.open && times[i] - op.row.end > gap) {
+            op.row.mean = op.windowSum / op.row.count;
+            op.out->append(&op.row);
+            op.open = false;
+        }
+        if (!op.open) {
+            startWindow(op.row, times[i], times[i]);
+            op.windowSum = 0;
+            op.open = true;
+        }
+        size_t j = i + 1;
+        while (j < count && times[j] - times[j - 1] <= gap) ++j;
+        reduce(op.row, op.windowSum, values + i, j - i);
+        op.row.end = times[j - 1];
+        i = j;
+    }
+}
+
+void WindowAggregator::sliding(Operator& op, const double* times, const double* values, size_t count) {
+    std::vector<RollingRow> rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        const double t = times[i];
+        const double v = values[i];
+        op.running += v;
+        op.members.push_back({t, op.running});
+        while (!op.minQueue.empty() && op.minQueue.back().value >= v) op.minQueue.pop_back();
+        op.minQueue.push_back({t, v});
+        while (!op.maxQueue.empty() && op.maxQueue.back().value <= v) op.maxQueue.pop_back();
+        op.maxQueue.push_back({t, v});
+
+        // The newest row never expires: width > 0.
+        const double cutoff = t - op.spec.width;
+        while (op.members.front().time <= cutoff) {
+            op.expired = op.members.front().value;
+            op.members.pop_front();
+            ++op.expiredSinceRebase;
+        }
+        while (op.minQueue.front().time <= cutoff) op.minQueue.pop_front();
+        while (op.maxQueue.front().time <= cutoff) op.maxQueue.pop_front();
+
+        RollingRow& row = rows[i];
+        row.time = t;
+        row.value = v;
+        row.count = op.members.size();
+        row.mean = (op.running - op.expired) / row.count;
+        row.min = op.minQueue.front().value;
+        row.max = op.maxQueue.front().value;
+
+        if (op.expiredSinceRebase >= op.members.size()) {
+            for (Entry& member : op.members) member.value -= op.expired;
+            op.running -= op.expired;
+            op.expired = 0;
+            op.expiredSinceRebase = 0;
+        }
+    }
+    op.out->append(rows.data(), rows.size());
+}
+
+void WindowAggregator::exponential(Operator& op, const double* times, const double* values, size_t count) {
+    std::vector<EwmaRow> rows(count);
+    for (size_t i = 0; i < count; ++i) {
+        const double t = times[i];
+        if (!op.open) {
+            op.ewma = values[i];
+            op.open = true;
+        } else {
+            // Irregular steps get their own decay; a regular series computes it once.
+            const double step = t - op.lastTime;
+            if (step != op.lastStep) {
+                op.alpha = 1 - std::exp2(-step / op.spec.width);
+                op.lastStep = step;
+            }
+            op.ewma += op.alpha * (values[i] - op.ewma);
+        }
+        op.lastTime = t;
+        rows[i] = {t, values[i], op.ewma};
+    }
+    op.out->append(rows.data(), rows.size());
+}
+
+WindowStats runWindows(SeriesReader& reader, H5::Group& destParent, const std::vector<WindowSpec>& specs,
+                       hsize_t batchRows) {
+    WindowStats stats;
+    WindowAggregator aggregator(destParent, specs);
+    std::vector<double> times;
+    std::vector<double> values;
+    for (;;) {
+        auto start = Clock::now();
+        const size_t rows = reader.next(times, values, static_cast<size_t>(batchRows));
+        stats.readSeconds += secondsSince(start);
+        if (rows == 0) break;
+        start = Clock::now();
+        aggregator.consume(times.data(), values.data(), rows);
+        stats.computeSeconds += secondsSince(start);
+        stats.rows += rows;
+        ++stats.batches;
+    }
+    auto start = Clock::now();
+    aggregator.finish();
+    stats.computeSeconds += secondsSince(start);
+    return stats;
+}
+
+} // namespace h5util
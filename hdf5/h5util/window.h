@@ -0,0 +1,172 @@
+// window.h
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <H5Cpp.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "append_buffer.h"
+
+namespace h5util {
+
+// Reads one series as (time, value) doubles, a batch at a time: a numeric
+// member of a one-dimensional compound dataset, or one column of a one- or
+// two-dimensional numeric dataset. Times come from another member, from a
+// one-dimensional dataset with one entry per row (a dimension scale such as the
+// weather Date scale), or are the row index. Values are divided by divisor, so
+// fixed-point data (raw / 128) decodes on the fly.
+class SeriesReader {
+public:
+    // timeMember empty: the row index is the time.
+    SeriesReader(const H5::DataSet& dataset, const std::string& valueMember, const std::string& timeMember = "",
+                 double divisor = 1);
+
+    // times null: the row index is the time.
+    SeriesReader(const H5::DataSet& dataset, hsize_t column, const H5::DataSet* times = nullptr, double divisor = 1);
+
+    hsize_t rows() const { return total; }
+    hsize_t position() const { return nextRow; }
+
+    // Reads up to count rows following the previous batch; returns the number
+    // read, 0 at the end.
+    size_t next(std::vector<double>& times, std::vector<double>& values, size_t count);
+
+private:
+    H5::DataSet dataset;
+    H5::DataSet timeDataset;
+    bool compound;
+    bool timeFromMember = false;
+    bool timeFromDataset = false;
+    hsize_t column = 0;
+    int rank;
+    double divisor;
+    H5::CompType pairType; // {time, value} or {value} as doubles, compound sources only
+    hsize_t total;
+    hsize_t nextRow = 0;
+    std::vector<double> pairs;
+};
+
+enum class Window {
+    Tumbling, // fixed, non-overlapping windows [origin + k*width, origin + (k+1)*width)
+    Sliding,  // one row per input row, over the rows with time in (t - width, t]
+    Session,  // runs of rows with no gap between consecutive times above width
+    Ewma      // one row per input row, exponentially weighted mean with half-life width
+};
+
+struct WindowSpec {
+    Window kind;
+    double width;       // time units
+    std::string output; // dataset created under the destination group
+    double origin = 0;  // Tumbling: start of window 0
+};
+
+// Row of a Tumbling or Session output. Tumbling windows without rows are not
+// written; a session ends at its last time.
+struct WindowRow {
+    double start;
+    double end;
+    uint64_t count;
+    double mean;
+    double min;
+    double max;
+};
+
+// Row of a Sliding output.
+struct RollingRow {
+    double time;
+    double value;
+    uint64_t count;
+    double mean;
+    double min;
+    double max;
+};
+
+// Row of an Ewma output.
+struct EwmaRow {
+    double time;
+    double value;
+    double ewma;
+};
+
+H5::CompType windowRowType();
+H5::CompType rollingRowType();
+H5::CompType ewmaRowType();
+
+struct WindowStats {
+    hsize_t rows = 0;
+    size_t batches = 0;
+    double readSeconds = 0;
+    double computeSeconds = 0; // including output writes
+};
+
+// Streaming window operators over a series whose times never decrease. Each
+// spec writes its own appendable dataset, tagged with "window" and "width"
+// attributes; consume() takes batches in series order and nothing but the rows
+// of the current windows is kept.
+//
+// Sliding sums are differences of running prefix sums, so adding a row and
+// expiring old ones is O(1); the prefixes are rebased each time the window has
+// turned over, so the subtraction never cancels more than two windows' worth of
+// magnitude. Sliding min and max use monotonic deques (O(1) amortized per row).
+// Tumbling and Session rows reduce each run of rows that fall in one window with
+// a plain loop over the batch.
+class WindowAggregator {
+public:
+    WindowAggregator(H5::Group& destParent, const std::vector<WindowSpec>& specs);
+    ~WindowAggregator();
+
+    WindowAggregator(const WindowAggregator&) = delete;
+    WindowAggregator& operator=(const WindowAggregator&) = delete;
+
+    void consume(const double* times, const double* values, size_t count);
+
+    // Writes the windows still open and flushes every output. Called by the destructor.
+    void finish();
+
+private:
+    struct Entry {
+        double time;
+        double value; // prefix sum for the members deque
+    };
+
+    // Per-spec state.
+    struct Operator {
+        WindowSpec spec;
+        std::unique_ptr<AppendBuffer> out;
+        bool open = false;        // Tumbling/Session: a window has rows
+        WindowRow row{};          // Tumbling/Session: the open window
+        double windowSum = 0;
+        std::deque<Entry> members; // Sliding: rows in the window with running prefix sums
+        std::deque<Entry> minQueue;
+        std::deque<Entry> maxQueue;
+        double running = 0;        // Sliding: prefix sum up to the newest row
+        double expired = 0;        // Sliding: prefix sum up to the newest expired row
+        size_t expiredSinceRebase = 0;
+        double ewma = 0;           // Ewma
+        double lastTime = 0;
+        double lastStep = -1;      // Ewma: time step alpha was computed for
+        double alpha = 0;
+    };
+
+    void tumbling(Operator& op, const double* times, const double* values, size_t count);
+    void session(Operator& op, const double* times, const double* values, size_t count);
+    void sliding(Operator& op, const double* times, const double* values, size_t count);
+    void exponential(Operator& op, const double* times, const double* values, size_t count);
+
+    std::vector<Operator> operators;
+    bool started = false;
+    double lastTime = 0;
+    bool finished = false;
+};
+
+// Reads the whole series batchRows at a time and feeds every spec.
+WindowStats runWindows(SeriesReader& reader, H5::Group& destParent, const std::vector<WindowSpec>& specs,
+                       hsize_t batchRows = 64 * 1024);
+
+} // namespace h5util
+
+#endif // WINDOW_H
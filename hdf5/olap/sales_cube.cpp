@@ -1,11 +1,113 @@
 #include "H5Cpp.h"
+#include "dataset_factory.h"
+#include "dimension_scales.h"
+#include "file_options.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
 const H5std_string FILE_NAME("sales_cube.h5");
 const H5std_string DATASET_NAME("sales");
+// Chunks of the sparse cube are 160000 bytes; pages this small keep the padding
+// behind each chunk under 4 KiB.
+const hsize_t SPARSE_PAGE_SIZE = 4096;
+
+// Axis labels, stored as dimension scales next to the cube: ISO year-week for
+// TIME, zip codes for ZIP and SKUs for PROD. All strictly increasing.
+std::vector<int64_t> timeLabels(hsize_t n) {
+    std::vector<int64_t> labels(n);
+    for (hsize_t i = 0; i < n; i++) labels[i] = (2025 + i / 52) * 100 + i % 52 + 1;
+    return labels;
+}
+
+std::vector<int64_t> zipLabels(hsize_t n) {
+    std::vector<int64_t> labels(n);
+    for (hsize_t i = 0; i < n; i++) labels[i] = 10001 + i * 89;
+    return labels;
+}
+
+std::vector<int64_t> prodLabels(hsize_t n) {
+    std::vector<int64_t> labels(n);
+    for (hsize_t i = 0; i < n; i++) labels[i] = 100000 + i * 7;
+    return labels;
+}
+
+void attachAxes(H5::H5File& file, H5::DataSet& dataset, hsize_t TIME, hsize_t ZIP, hsize_t PROD) {
+    h5util::attachScale(file, dataset, 0, "TIME", timeLabels(TIME));
+    h5util::attachScale(file, dataset, 1, "ZIP", zipLabels(ZIP));
+    h5util::attachScale(file, dataset, 2, "PROD", prodLabels(PROD));
+}
+
+// Writes a large cube where only about one zip/product block in ten has sales.
+// The dataset is chunked with incremental allocation, so blocks that are never
+// written take no space in the file and read back as the 0.0 fill value. Each
+// populated block is written as whole chunks (all time steps at once). The file
+// uses paged aggregation, which keeps the chunk index and the axis scales in
+// metadata pages apart from the chunks; sales_query reads it through a page buffer.
+int writeSparseCube(hsize_t TIME, hsize_t ZIP, hsize_t PROD) {
+    hsize_t dims[3] = {TIME, ZIP, PROD};
+    std::vector<hsize_t> chunk = {std::min<hsize_t>(TIME, 4), std::min<hsize_t>(ZIP, 100), std::min<hsize_t>(PROD, 50)};
+
+    h5util::DatasetOptions options = h5util::DatasetOptions::sparse(chunk);
+    double zero = 0.0;
+    options.hasFillValue = true;
+    options.fillValue.assign(reinterpret_cast<unsigned char*>(&zero), reinterpret_cast<unsigned char*>(&zero + 1));
+    options.headerReserve = h5util::scaleAttachmentHeaderBytes(3);
+
+    try {
+        H5::H5File file = h5util::createFile(FILE_NAME, h5util::FileOptions::paged(SPARSE_PAGE_SIZE));
+        H5::DataSpace dataspace(3, dims);
+        H5::DataSet dataset = h5util::createDataSet(file, DATASET_NAME, H5::PredType::NATIVE_DOUBLE, dataspace, options);
+        attachAxes(file, dataset, TIME, ZIP, PROD);
+
+        hsize_t blocks = 0, cells = 0;
+        std::vector<double> block;
+        for (hsize_t z0 = 0; z0 < ZIP; z0 += chunk[1]) {
+            for (hsize_t p0 = 0; p0 < PROD; p0 += chunk[2]) {
+                if (((z0 / chunk[1]) * 7 + (p0 / chunk[2]) * 3) % 10 != 0) continue;
+                hsize_t offset[3] = {0, z0, p0};
+                hsize_t count[3] = {TIME, std::min(chunk[1], ZIP - z0), std::min(chunk[2], PROD - p0)};
+                block.resize(count[0] * count[1] * count[2]);
+                size_t i = 0;
+                for (hsize_t t = 0; t < count[0]; t++)
+                    for (hsize_t z = 0; z < count[1]; z++)
+                        for (hsize_t p = 0; p < count[2]; p++)
+                            block[i++] = (t + z0 + z + p0 + p) * 100.0;
+                H5::DataSpace fileSpace = dataset.getSpace();
+                fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+                H5::DataSpace memSpace(3, count);
+                dataset.write(block.data(), H5::PredType::NATIVE_DOUBLE, memSpace, fileSpace);
+                ++blocks;
+                cells += block.size();
+            }
+        }
+        file.flush(H5F_SCOPE_LOCAL);
+        std::cout << "HDF5 file '" << FILE_NAME << "' created with sparse dataset '" << DATASET_NAME << "' ("
+                  << TIME << "x" << ZIP << "x" << PROD << ", " << blocks << " blocks, " << cells << " cells written, "
+                  << dataset.getStorageSize() << " bytes allocated of " << TIME * ZIP * PROD * sizeof(double)
+                  << ")." << std::endl;
+    } catch (H5::Exception &e) {
+        e.printErrorStack();
+        return -1;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+// Usage: sales_cube                          small dense 3x3x3 cube
+//        sales_cube --sparse [time zip prod] large, mostly empty cube
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--sparse") {
+        hsize_t time = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 52;
+        hsize_t zip = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000;
+        hsize_t prod = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 200;
+        return writeSparseCube(time, zip, prod);
+    }
 
-int main() {
     const int TIME = 3, ZIP = 3, PROD = 3;
     hsize_t dims[3] = {TIME, ZIP, PROD};
 
@@ -24,8 +126,11 @@ int main() {
     try {
         H5::H5File file(FILE_NAME, H5F_ACC_TRUNC);
         H5::DataSpace dataspace(3, dims);
-        H5::DataSet dataset = file.createDataSet(DATASET_NAME, H5::PredType::NATIVE_DOUBLE, dataspace);
+        h5util::DatasetOptions options;
+        options.headerReserve = h5util::scaleAttachmentHeaderBytes(3);
+        H5::DataSet dataset = h5util::createDataSet(file, DATASET_NAME, H5::PredType::NATIVE_DOUBLE, dataspace, options);
         dataset.write(data.data(), H5::PredType::NATIVE_DOUBLE);
+        attachAxes(file, dataset, TIME, ZIP, PROD);
         std::cout << "HDF5 file '" << FILE_NAME << "' created with dataset '" << DATASET_NAME << "'." << std::endl;
     } catch (H5::FileIException &e) {
         e.printErrorStack();
@@ -36,6 +141,9 @@ int main() {
     } catch (H5::DataSpaceIException &e) {
         e.printErrorStack();
         return -1;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
     }
 
     return 0;
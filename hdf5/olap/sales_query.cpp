@@ -0,0 +1,150 @@
+#include "H5Cpp.h"
+#include "read_planner.h"
+#include "dimension_scales.h"
+#include "file_options.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+const H5std_string FILE_NAME("sales_cube.h5");
+const H5std_string DATASET_NAME("sales");
+
+const char* AXIS_NAMES[3] = {"time", "zip", "prod"};
+
+// Opens the cube, through a page buffer when sales_cube --sparse wrote it with
+// paged aggregation and the library supports one.
+H5::H5File openCube() {
+    h5util::FileOptions options;
+    {
+        H5::H5File probe(FILE_NAME, H5F_ACC_RDONLY);
+        const hsize_t pageSize = h5util::filePageSize(probe);
+        if (pageSize > 0) options = h5util::FileOptions::paged(pageSize);
+    }
+    return h5util::openFile(FILE_NAME, H5F_ACC_RDONLY, options);
+}
+
+// Sums the cells whose axis labels fall in the given inclusive ranges. Each label
+// range is turned into an index range by binary search on the dimension scale,
+// so only the matching hyperslab is read.
+int queryByLabels(H5::DataSet& dataset, const int64_t lo[3], const int64_t hi[3]) {
+    hsize_t offset[3], count[3];
+    for (unsigned d = 0; d < 3; ++d) {
+        h5util::ScaleIndex scale(dataset, d);
+        std::pair<hsize_t, hsize_t> range = scale.range(lo[d], hi[d]);
+        offset[d] = range.first;
+        count[d] = range.second - range.first;
+        std::cout << scale.name() << " [" << lo[d] << ", " << hi[d] << "] -> indices [" << range.first << ", "
+                  << range.second << ")\n";
+        if (count[d] == 0) {
+            std::cout << "No " << AXIS_NAMES[d] << " labels in range; nothing to read.\n";
+            return 0;
+        }
+    }
+
+    std::vector<double> cells(count[0] * count[1] * count[2]);
+    h5util::ReadPlanner planner(dataset, H5::PredType::NATIVE_DOUBLE);
+    planner.add(offset, count, cells.data());
+    h5util::ReadStats stats = planner.execute();
+
+    double total = 0.0;
+    for (double v : cells) total += v;
+    std::cout << "Cells: " << cells.size() << ", total sales: " << total << ", mean: " << total / cells.size()
+              << " (" << stats.readsIssued << " reads, " << stats.bytesRead << " bytes)" << std::endl;
+    return 0;
+}
+
+// Usage: sales_query                                   batch of scattered slices and cells
+//        sales_query [--time LO HI] [--zip LO HI] [--prod LO HI]
+//                                                      total over label ranges (inclusive)
+//
+// Without arguments, reads a batch of scattered slices and cells from the sales
+// cube written by sales_cube.cpp. All requests are handed to the ReadPlanner
+// together so they are issued in file order instead of request order.
+int main(int argc, char* argv[]) {
+    try {
+        H5::H5File file = openCube();
+        H5::DataSet dataset = file.openDataSet(DATASET_NAME);
+
+        if (argc > 1) {
+            int64_t lo[3], hi[3];
+            for (int d = 0; d < 3; ++d) {
+                lo[d] = std::numeric_limits<int64_t>::min();
+                hi[d] = std::numeric_limits<int64_t>::max();
+            }
+            for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                int axis = -1;
+                for (int d = 0; d < 3; ++d) {
+                    if (arg == std::string("--") + AXIS_NAMES[d]) axis = d;
+                }
+                if (axis < 0 || i + 2 >= argc) {
+                    std::cerr << "Usage: sales_query [--time LO HI] [--zip LO HI] [--prod LO HI]" << std::endl;
+                    return 1;
+                }
+                lo[axis] = std::strtoll(argv[++i], nullptr, 10);
+                hi[axis] = std::strtoll(argv[++i], nullptr, 10);
+            }
+            return queryByLabels(dataset, lo, hi);
+        }
+
+        hsize_t dims[3];
+        dataset.getSpace().getSimpleExtentDims(dims);
+        const hsize_t TIME = dims[0], ZIP = dims[1], PROD = dims[2];
+
+        h5util::ReadPlanner planner(dataset, H5::PredType::NATIVE_DOUBLE);
+
+        // Time series of every product at the last zip, queued last zip first.
+        std::vector<std::vector<double>> series(PROD, std::vector<double>(TIME));
+        for (hsize_t p = PROD; p-- > 0;) {
+            hsize_t offset[3] = {0, ZIP - 1, p};
+            hsize_t count[3] = {TIME, 1, 1};
+            planner.add(offset, count, series[p].data());
+        }
+
+        // Full zip x product slice for the final time step.
+        std::vector<double> lastSlice(ZIP * PROD);
+        hsize_t sliceOffset[3] = {TIME - 1, 0, 0};
+        hsize_t sliceCount[3] = {1, ZIP, PROD};
+        planner.add(sliceOffset, sliceCount, lastSlice.data());
+
+        // Point lookups along the cube diagonal, in reverse.
+        const hsize_t diagonal = std::min(TIME, std::min(ZIP, PROD));
+        std::vector<double> cells(diagonal);
+        for (hsize_t i = diagonal; i-- > 0;) {
+            hsize_t coord[3] = {i, i, i};
+            planner.addPoint(coord, &cells[i]);
+        }
+
+        h5util::ReadStats stats = planner.execute();
+
+        for (hsize_t p = 0; p < PROD; ++p) {
+            std::cout << "sales[*][" << ZIP - 1 << "][" << p << "]:";
+            for (double v : series[p]) std::cout << " " << v;
+            std::cout << "\n";
+        }
+        std::cout << "sales[" << TIME - 1 << "][*][*]:";
+        for (double v : lastSlice) std::cout << " " << v;
+        std::cout << "\n";
+        for (hsize_t i = 0; i < diagonal; ++i) {
+            std::cout << "sales[" << i << "][" << i << "][" << i << "] = " << cells[i] << "\n";
+        }
+
+        std::cout << "Planner: " << stats.requests << " requests -> " << stats.extents << " extents -> "
+                  << stats.readsIssued << " reads, " << stats.bytesRequested << " bytes requested, "
+                  << stats.bytesRead << " bytes read, " << stats.chunksSkipped << " unallocated chunks skipped"
+                  << (planner.isChunked() ? " (chunked)" : " (contiguous)")
+                  << std::endl;
+        h5util::printPageBufferStats(std::cout, file);
+    } catch (H5::Exception &e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return -1;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <H5Cpp.h>
+#include <iostream>
+#include <string>
+#include "header_report.h"
+
+// Usage: headercheck FILE [--split]
+// Lists the object header of every object in FILE: chunks, continuation blocks,
+// messages and free space. --split lists only objects with continuation blocks.
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: headercheck FILE [--split]" << std::endl;
+        return 1;
+    }
+    const bool onlySplit = argc > 2 && std::string(argv[2]) == "--split";
+    try {
+        H5::H5File file(argv[1], H5F_ACC_RDONLY);
+        h5util::printHeaderReport(std::cout, h5util::headerReport(file), onlySplit);
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <H5Cpp.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dataset_factory.h"
+#include "rechunk.h"
+
+namespace {
+
+const char* SAMPLE_FILE = "timeseries.h5";
+const char* SAMPLE_DATASET = "readings";
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<hsize_t> parseDims(const std::string& text) {
+    std::vector<hsize_t> dims;
+    std::stringstream in(text);
+    std::string part;
+    while (std::getline(in, part, ',')) {
+        dims.push_back(std::strtoull(part.c_str(), nullptr, 10));
+        if (dims.back() == 0) throw std::invalid_argument("rechunk: chunk sizes must be positive");
+    }
+    return dims;
+}
+
+// Time-major sample: readings[time][station] written a block of time steps at a
+// time, chunked {64, stations} and gzipped, the layout a logger produces.
+void writeSample(hsize_t times, hsize_t stations) {
+    H5::H5File file(SAMPLE_FILE, H5F_ACC_TRUNC);
+    hsize_t dims[2] = {times, stations};
+    H5::DataSpace space(2, dims);
+    h5util::DatasetOptions options;
+    options.chunkDims = {std::min<hsize_t>(64, times), stations};
+    options.deflateLevel = 4;
+    options.shuffle = true;
+    H5::DataSet dataset = h5util::createDataSet(file, SAMPLE_DATASET, H5::PredType::NATIVE_FLOAT, space, options);
+
+    std::vector<float> block;
+    for (hsize_t t0 = 0; t0 < times; t0 += options.chunkDims[0]) {
+        hsize_t count[2] = {std::min(options.chunkDims[0], times - t0), stations};
+        hsize_t offset[2] = {t0, 0};
+        block.resize(count[0] * count[1]);
+        for (hsize_t t = 0; t < count[0]; ++t)
+            for (hsize_t s = 0; s < stations; ++s)
+                block[t * stations + s] = static_cast<float>(s % 40) + static_cast<float>((t0 + t) % 1440) / 100.0f;
+        H5::DataSpace fileSpace = dataset.getSpace();
+        fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace memSpace(2, count);
+        dataset.write(block.data(), H5::PredType::NATIVE_FLOAT, memSpace, fileSpace);
+    }
+    std::cout << "Wrote " << SAMPLE_FILE << ": " << SAMPLE_DATASET << " " << times << "x" << stations
+              << " chunked " << options.chunkDims[0] << "x" << stations << ", " << dataset.getStorageSize()
+              << " bytes stored." << std::endl;
+}
+
+} // namespace
+
+// Usage: rechunk SRC DATASET DST --chunk a,b,... [--deflate N] [--shuffle] [--budget MiB] [--threads N]
+//        rechunk --sample [times stations]
+// Copies DATASET from SRC into DST (same path) with a new chunk shape and
+// filters, moving raw chunks instead of decoding through the type system. For
+// example, after "rechunk --sample", "rechunk timeseries.h5 readings series.h5
+// --chunk 4096,1 --deflate 4 --shuffle" turns the time-major readings into one
+// column per station.
+int main(int argc, char* argv[]) {
+    try {
+        if (argc > 1 && std::string(argv[1]) == "--sample") {
+            hsize_t times = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+            hsize_t stations = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 200;
+            writeSample(times, stations);
+            return 0;
+        }
+        if (argc < 4) {
+            std::cerr << "Usage: rechunk SRC DATASET DST --chunk a,b,... [--deflate N] [--shuffle] [--budget MiB]"
+                         " [--threads N]" << std::endl;
+            return 1;
+        }
+        h5util::RechunkOptions options;
+        for (int i = 4; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--shuffle") {
+                options.shuffle = true;
+            } else if (i + 1 < argc && arg == "--chunk") {
+                options.chunkDims = parseDims(argv[++i]);
+            } else if (i + 1 < argc && arg == "--deflate") {
+                options.deflateLevel = std::atoi(argv[++i]);
+            } else if (i + 1 < argc && arg == "--budget") {
+                options.memoryBudget = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+            } else if (i + 1 < argc && arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+        if (options.chunkDims.empty()) {
+            std::cerr << "rechunk: --chunk is required" << std::endl;
+            return 1;
+        }
+
+        H5::H5File source(argv[1], H5F_ACC_RDONLY);
+        H5::DataSet dataset = source.openDataSet(argv[2]);
+        H5::H5File dest(argv[3], H5F_ACC_TRUNC);
+
+        auto start = std::chrono::steady_clock::now();
+        h5util::RechunkStats stats = h5util::rechunk(dataset, dest, argv[2], options);
+        dest.flush(H5F_SCOPE_LOCAL);
+        const double millis = millisSince(start);
+
+        const double logical = static_cast<double>(dataset.getSpace().getSimpleExtentNpoints()) *
+                               dataset.getDataType().getSize();
+        std::cout << "Rechunked " << argv[2] << " in " << millis << " ms (" << stats.passes << " pass"
+                  << (stats.passes == 1 ? "" : "es") << ", " << stats.slabs << " slabs): "
+                  << logical / (1024.0 * 1024.0) / (millis / 1000.0) << " MiB/s logical" << std::endl;
+        std::cout << "  read    " << stats.sourceChunksRead << " chunks, " << stats.bytesRead << " bytes, "
+                  << stats.readSeconds * 1000 << " ms" << std::endl;
+        std::cout << "  decode  " << stats.decodeSeconds * 1000 << " ms" << std::endl;
+        std::cout << "  encode  " << stats.encodeSeconds * 1000 << " ms" << std::endl;
+        std::cout << "  write   " << stats.chunksWritten << " chunks, " << stats.bytesWritten << " bytes, "
+                  << stats.writeSeconds * 1000 << " ms" << std::endl;
+    } catch (H5::Exception& e) {
+        std::cerr << "HDF5 Error: " << e.getDetailMsg() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}